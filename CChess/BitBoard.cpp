@@ -18,9 +18,7 @@ bool BitBoard::operator== (const BitBoard& other) const noexcept
 //getters
 int BitBoard::leastSignificantBit() const noexcept
 {
-	unsigned long result{};
-	_BitScanForward64(&result, m_board);
-	return static_cast<int>(result);
+	return std::countr_zero(m_board);
 }
 
 std::size_t BitBoard::bitCount() const noexcept
@@ -0,0 +1,978 @@
+#include "Bitbase.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+#include <vector>
+
+#include "BitBoard.h"
+#include "ChessConstants.hpp"
+#include "MoveGen.h"
+
+
+
+//	Static Helpers
+
+// the pawn is on files a to d and ranks 2 to 7, everything else is mirrored onto them, so an index is the strong king, 
+// the weak king, the side to move, the pawn file and the pawn rank counted down from the seventh
+static constexpr int pawnFiles{ 4 };
+static constexpr int pawnRanks{ 6 };
+static constexpr std::size_t positionCount{ 2 * boardSize * boardSize * pawnFiles * pawnRanks };
+static constexpr std::size_t wordBits{ 32 };
+
+// results are bits so the results of all moves from a position can be or-ed together, an invalid position adds nothing
+enum class Result : std::uint8_t
+{
+	Invalid = 0,
+	Unknown = 1,
+	Draw = 2,
+	Win = 4
+};
+
+// One bit per position in the order of index(), set if the side with the pawn wins. Written by generateKingPawnWins(), 
+// which is too slow to run at every startup: the positions where the pawn promotes safely are wins and the ones where 
+// the weak king takes the pawn or is stalemated are draws, then every pass settles the positions one move further away 
+// until nothing changes. Invalid positions are draws. Bitbase::verify() rebuilds it and compares.
+static constexpr std::array<std::uint32_t, positionCount / wordBits> kingPawnWins{
+	0xFFFFFCFCU, 0xFFFEFFFFU, 0xFFFFF8F8U, 0xFFFEFFFFU, 0xFFFFF1F1U, 0xFFFEFFFFU, 0xFFFFE3E3U, 0xFFFEFFFFU,
+	0xFFFFC7C7U, 0xFFFEFFFFU, 0xFFFF8F8FU, 0xFFFEFFFFU, 0xFFFF1F1FU, 0xFFFEFFFFU, 0xFFFF3F3FU, 0xFFFEFFFFU,
+	0xFFFCFCFCU, 0xFFFEFFFFU, 0xFFF8F8F8U, 0xFFFEFFFFU, 0xFFF1F1F1U, 0xFFFEFFFFU, 0xFFE3E3E3U, 0xFFFEFFFFU,
+	0xFFC7C7C7U, 0xFFFEFFFFU, 0xFF8F8F8FU, 0xFFFEFFFFU, 0xFF1F1F1FU, 0xFFFEFFFFU, 0xFF3F3F3FU, 0xFFFEFFFFU,
+	0xFCFCFCFFU, 0xFFFEFFFFU, 0xF8F8F8FFU, 0xFFFEFFFFU, 0xF1F1F1FFU, 0xFFFEFFFFU, 0xE3E3E3FFU, 0xFFFEFFFFU,
+	0xC7C7C7FFU, 0xFFFEFFFFU, 0x8F8F8FFFU, 0xFFFEFFFFU, 0x1F1F1FFFU, 0xFFFEFFFFU, 0x3F3F3FFFU, 0xFFFEFFFFU,
+	0xFCFCFFFFU, 0xFFFEFFFCU, 0xF8F8FFFFU, 0xFFFEFFF8U, 0xF1F1FFFFU, 0xFFFEFFF1U, 0xE3E3FFFFU, 0xFFFEFFE3U,
+	0xC7C7FFFFU, 0xFFFEFFC7U, 0x8F8FFFFFU, 0xFFFEFF8FU, 0x1F1FFFFFU, 0xFFFEFF1FU, 0x3F3FFFFFU, 0xFFFEFF3FU,
+	0xFCFFFFFFU, 0xFFFEFCFCU, 0xF8FFFFFFU, 0xFFFEF8F8U, 0xF1FFFFFFU, 0xFFFEF1F1U, 0xE3FFFFFFU, 0xFFFEE3E3U,
+	0xC7FFFFFFU, 0xFFFEC7C7U, 0x8FFFFFFFU, 0xFFFE8F8FU, 0x1FFFFFFFU, 0xFFFE1F1FU, 0x3FFFFFFFU, 0xFFFE3F3FU,
+	0x00000000U, 0x03000000U, 0x00000000U, 0x02000000U, 0x00000000U, 0x06000100U, 0xFFFFFFFFU, 0xFEE2E3E3U,
+	0xFFFFFFFFU, 0xFFC6C7C7U, 0xFFFFFFFFU, 0xFF8E8F8FU, 0xFFFFFFFFU, 0xFF1E1F1FU, 0xFFFFFFFFU, 0xFF3E3F3FU,
+	0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000100U, 0xFFFFFFFFU, 0xE2E2E3FFU,
+	0xFFFFFFFFU, 0xC7C6C7FFU, 0xFFFFFFFFU, 0x8F8E8FFFU, 0xFFFFFFFFU, 0x1F1E1FFFU, 0xFFFFFFFFU, 0x3F3E3FFFU,
+	0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000700U, 0xFFFFFFFFU, 0xE2E2FFFFU,
+	0xFFFFFFFFU, 0xC7C6FFFFU, 0xFFFFFFFFU, 0x8F8EFFFFU, 0xFFFFFFFFU, 0x1F1EFFFFU, 0xFFFFFFFFU, 0x3F3EFFFFU,
+	0xFFFFFCFCU, 0xFFFEFFFFU, 0xFFFFF8F8U, 0xFFFEFFFFU, 0xFFFFF1F1U, 0xFFFEFFFFU, 0xFFFFE3E3U, 0xFFFEFFFFU,
+	0xFFFFC7C7U, 0xFFFEFFFFU, 0xFFFF8F8FU, 0xFFFEFFFFU, 0xFFFF1F1FU, 0xFFFEFFFFU, 0xFFFF3F3FU, 0xFFFEFFFFU,
+	0xFFFCFCFCU, 0xFFFEFFFFU, 0xFFF8F8F8U, 0xFFFEFFFFU, 0xFFF1F1F1U, 0xFFFEFFFFU, 0xFFE3E3E3U, 0xFFFEFFFFU,
+	0xFFC7C7C7U, 0xFFFEFFFFU, 0xFF8F8F8FU, 0xFFFEFFFFU, 0xFF1F1F1FU, 0xFFFEFFFFU, 0xFF3F3F3FU, 0xFFFEFFFFU,
+	0xFCFCFCFFU, 0xFFFEFFFFU, 0xF8F8F8FFU, 0xFFFEFFFFU, 0xF1F1F1FFU, 0xFFFEFFFFU, 0xE3E3E3FFU, 0xFFFEFFFFU,
+	0xC7C7C7FFU, 0xFFFEFFFFU, 0x8F8F8FFFU, 0xFFFEFFFFU, 0x1F1F1FFFU, 0xFFFEFFFFU, 0x3F3F3FFFU, 0xFFFEFFFFU,
+	0xFCFCFFFFU, 0xFFFEFFFCU, 0xF8F8FFFFU, 0xFFFEFFF8U, 0xF1F1FFFFU, 0xFFFEFFF1U, 0xE3E3FFFFU, 0xFFFEFFE3U,
+	0xC7C7FFFFU, 0xFFFEFFC7U, 0x8F8FFFFFU, 0xFFFEFF8FU, 0x1F1FFFFFU, 0xFFFEFF1FU, 0x3F3FFFFFU, 0xFFFEFF3FU,
+	0xFCFFFFFFU, 0xFFFEFCFCU, 0xF8FFFFFFU, 0xFFFEF8F8U, 0xF1FFFFFFU, 0xFFFEF1F1U, 0xE3FFFFFFU, 0xFFFEE3E3U,
+	0xC7FFFFFFU, 0xFFFEC7C7U, 0x8FFFFFFFU, 0xFFFE8F8FU, 0x1FFFFFFFU, 0xFFFE1F1FU, 0x3FFFFFFFU, 0xFFFE3F3FU,
+	0xFFFFFFFFU, 0xFFFCFCFCU, 0xFFFFFFFFU, 0xFFF8F8F8U, 0xFFFFFFFFU, 0xFFF0F1F1U, 0xFFFFFFFFU, 0xFFE2E3E3U,
+	0xFFFFFFFFU, 0xFFC6C7C7U, 0xFFFFFFFFU, 0xFF8E8F8FU, 0xFFFFFFFFU, 0xFF1E1F1FU, 0xFFFFFFFFU, 0xFF3E3F3FU,
+	0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0xFFFFFFFFU, 0xF0F0F1FFU, 0xFFFFFFFFU, 0xE3E2E3FFU,
+	0xFFFFFFFFU, 0xC7C6C7FFU, 0xFFFFFFFFU, 0x8F8E8FFFU, 0xFFFFFFFFU, 0x1F1E1FFFU, 0xFFFFFFFFU, 0x3F3E3FFFU,
+	0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0xFFFFFFFFU, 0xF0F0FFFFU, 0xFFFFFFFFU, 0xE3E2FFFFU,
+	0xFFFFFFFFU, 0xC7C6FFFFU, 0xFFFFFFFFU, 0x8F8EFFFFU, 0xFFFFFFFFU, 0x1F1EFFFFU, 0xFFFFFFFFU, 0x3F3EFFFFU,
+	0xFFFFFCFCU, 0xFFFDFFFFU, 0xFFFFF8F8U, 0xFFFDFFFFU, 0xFFFFF1F1U, 0xFFFDFFFFU, 0xFFFFE3E3U, 0xFFFDFFFFU,
+	0xFFFFC7C7U, 0xFFFDFFFFU, 0xFFFF8F8FU, 0xFFFDFFFFU, 0xFFFF1F1FU, 0xFFFDFFFFU, 0xFFFF3F3FU, 0xFFFDFFFFU,
+	0xFFFCFCFCU, 0xFFFDFFFFU, 0xFFF8F8F8U, 0xFFFDFFFFU, 0xFFF1F1F1U, 0xFFFDFFFFU, 0xFFE3E3E3U, 0xFFFDFFFFU,
+	0xFFC7C7C7U, 0xFFFDFFFFU, 0xFF8F8F8FU, 0xFFFDFFFFU, 0xFF1F1F1FU, 0xFFFDFFFFU, 0xFF3F3F3FU, 0xFFFDFFFFU,
+	0xFCFCFCFFU, 0xFFFDFFFFU, 0xF8F8F8FFU, 0xFFFDFFFFU, 0xF1F1F1FFU, 0xFFFDFFFFU, 0xE3E3E3FFU, 0xFFFDFFFFU,
+	0xC7C7C7FFU, 0xFFFDFFFFU, 0x8F8F8FFFU, 0xFFFDFFFFU, 0x1F1F1FFFU, 0xFFFDFFFFU, 0x3F3F3FFFU, 0xFFFDFFFFU,
+	0xFCFCFFFFU, 0xFFFDFFFCU, 0xF8F8FFFFU, 0xFFFDFFF8U, 0xF1F1FFFFU, 0xFFFDFFF1U, 0xE3E3FFFFU, 0xFFFDFFE3U,
+	0xC7C7FFFFU, 0xFFFDFFC7U, 0x8F8FFFFFU, 0xFFFDFF8FU, 0x1F1FFFFFU, 0xFFFDFF1FU, 0x3F3FFFFFU, 0xFFFDFF3FU,
+	0xFCFFFFFFU, 0xFFFDFCFCU, 0xF8FFFFFFU, 0xFFFDF8F8U, 0xF1FFFFFFU, 0xFFFDF1F1U, 0xE3FFFFFFU, 0xFFFDE3E3U,
+	0xC7FFFFFFU, 0xFFFDC7C7U, 0x8FFFFFFFU, 0xFFFD8F8FU, 0x1FFFFFFFU, 0xFFFD1F1FU, 0x3FFFFFFFU, 0xFFFD3F3FU,
+	0x00000000U, 0x07040400U, 0x00000000U, 0x07000000U, 0x00000000U, 0x07010100U, 0x00000000U, 0x0F010300U,
+	0xFFFFFFFFU, 0xFFC5C7C7U, 0xFFFFFFFFU, 0xFF8D8F8FU, 0xFFFFFFFFU, 0xFF1D1F1FU, 0xFFFFFFFFU, 0xFF3D3F3FU,
+	0x00000000U, 0x04040000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x01010000U, 0x00000000U, 0x03010300U,
+	0xFFFFFFFFU, 0xC7C5C7FFU, 0xFFFFFFFFU, 0x8F8D8FFFU, 0xFFFFFFFFU, 0x1F1D1FFFU, 0xFFFFFFFFU, 0x3F3D3FFFU,
+	0x00000000U, 0x04040200U, 0x00000000U, 0x00000500U, 0x00000000U, 0x01010200U, 0x00000000U, 0x03010F00U,
+	0xFFFFFFFFU, 0xC7C5FFFFU, 0xFFFFFFFFU, 0x8F8DFFFFU, 0xFFFFFFFFU, 0x1F1DFFFFU, 0xFFFFFFFFU, 0x3F3DFFFFU,
+	0xFFFFFCFCU, 0xFFFDFFFFU, 0xFFFFF8F8U, 0xFFFDFFFFU, 0xFFFFF1F1U, 0xFFFDFFFFU, 0xFFFFE3E3U, 0xFFFDFFFFU,
+	0xFFFFC7C7U, 0xFFFDFFFFU, 0xFFFF8F8FU, 0xFFFDFFFFU, 0xFFFF1F1FU, 0xFFFDFFFFU, 0xFFFF3F3FU, 0xFFFDFFFFU,
+	0xFFFCFCFCU, 0xFFFDFFFFU, 0xFFF8F8F8U, 0xFFFDFFFFU, 0xFFF1F1F1U, 0xFFFDFFFFU, 0xFFE3E3E3U, 0xFFFDFFFFU,
+	0xFFC7C7C7U, 0xFFFDFFFFU, 0xFF8F8F8FU, 0xFFFDFFFFU, 0xFF1F1F1FU, 0xFFFDFFFFU, 0xFF3F3F3FU, 0xFFFDFFFFU,
+	0xFCFCFCFFU, 0xFFFDFFFFU, 0xF8F8F8FFU, 0xFFFDFFFFU, 0xF1F1F1FFU, 0xFFFDFFFFU, 0xE3E3E3FFU, 0xFFFDFFFFU,
+	0xC7C7C7FFU, 0xFFFDFFFFU, 0x8F8F8FFFU, 0xFFFDFFFFU, 0x1F1F1FFFU, 0xFFFDFFFFU, 0x3F3F3FFFU, 0xFFFDFFFFU,
+	0xFCFCFFFFU, 0xFFFDFFFCU, 0xF8F8FFFFU, 0xFFFDFFF8U, 0xF1F1FFFFU, 0xFFFDFFF1U, 0xE3E3FFFFU, 0xFFFDFFE3U,
+	0xC7C7FFFFU, 0xFFFDFFC7U, 0x8F8FFFFFU, 0xFFFDFF8FU, 0x1F1FFFFFU, 0xFFFDFF1FU, 0x3F3FFFFFU, 0xFFFDFF3FU,
+	0xFCFFFFFFU, 0xFFFDFCFCU, 0xF8FFFFFFU, 0xFFFDF8F8U, 0xF1FFFFFFU, 0xFFFDF1F1U, 0xE3FFFFFFU, 0xFFFDE3E3U,
+	0xC7FFFFFFU, 0xFFFDC7C7U, 0x8FFFFFFFU, 0xFFFD8F8FU, 0x1FFFFFFFU, 0xFFFD1F1FU, 0x3FFFFFFFU, 0xFFFD3F3FU,
+	0xFFFFFFFFU, 0xFFFCFCFCU, 0xFFFFFFFFU, 0xFFF8F8F8U, 0xFFFFFFFFU, 0xFFF1F1F1U, 0xFFFFFFFFU, 0xFFE1E3E3U,
+	0xFFFFFFFFU, 0xFFC5C7C7U, 0xFFFFFFFFU, 0xFF8D8F8FU, 0xFFFFFFFFU, 0xFF1D1F1FU, 0xFFFFFFFFU, 0xFF3D3F3FU,
+	0x00000000U, 0x0C0C0C00U, 0x00000000U, 0x00000000U, 0x00000000U, 0x01010100U, 0xFFFFFFFFU, 0xE3E1E3FFU,
+	0xFFFFFFFFU, 0xC7C5C7FFU, 0xFFFFFFFFU, 0x8F8D8FFFU, 0xFFFFFFFFU, 0x1F1D1FFFU, 0xFFFFFFFFU, 0x3F3D3FFFU,
+	0x00000000U, 0x00000000U, 0x00000000U, 0x00080A0FU, 0x00000000U, 0x00000000U, 0xFFFFFFFFU, 0xE3E1FFFFU,
+	0xFFFFFFFFU, 0xC7C5FFFFU, 0xFFFFFFFFU, 0x8F8DFFFFU, 0xFFFFFFFFU, 0x1F1DFFFFU, 0xFFFFFFFFU, 0x3F3DFFFFU,
+	0xFFFFFCFCU, 0xFFFBFFFFU, 0xFFFFF8F8U, 0xFFFBFFFFU, 0xFFFFF1F1U, 0xFFFBFFFFU, 0xFFFFE3E3U, 0xFFFBFFFFU,
+	0xFFFFC7C7U, 0xFFFBFFFFU, 0xFFFF8F8FU, 0xFFFBFFFFU, 0xFFFF1F1FU, 0xFFFBFFFFU, 0xFFFF3F3FU, 0xFFFBFFFFU,
+	0xFFFCFCFCU, 0xFFFBFFFFU, 0xFFF8F8F8U, 0xFFFBFFFFU, 0xFFF1F1F1U, 0xFFFBFFFFU, 0xFFE3E3E3U, 0xFFFBFFFFU,
+	0xFFC7C7C7U, 0xFFFBFFFFU, 0xFF8F8F8FU, 0xFFFBFFFFU, 0xFF1F1F1FU, 0xFFFBFFFFU, 0xFF3F3F3FU, 0xFFFBFFFFU,
+	0xFCFCFCFFU, 0xFFFBFFFFU, 0xF8F8F8FFU, 0xFFFBFFFFU, 0xF1F1F1FFU, 0xFFFBFFFFU, 0xE3E3E3FFU, 0xFFFBFFFFU,
+	0xC7C7C7FFU, 0xFFFBFFFFU, 0x8F8F8FFFU, 0xFFFBFFFFU, 0x1F1F1FFFU, 0xFFFBFFFFU, 0x3F3F3FFFU, 0xFFFBFFFFU,
+	0xFCFCFFFFU, 0xFFFBFFFCU, 0xF8F8FFFFU, 0xFFFBFFF8U, 0xF1F1FFFFU, 0xFFFBFFF1U, 0xE3E3FFFFU, 0xFFFBFFE3U,
+	0xC7C7FFFFU, 0xFFFBFFC7U, 0x8F8FFFFFU, 0xFFFBFF8FU, 0x1F1FFFFFU, 0xFFFBFF1FU, 0x3F3FFFFFU, 0xFFFBFF3FU,
+	0xFCFFFFFFU, 0xFFFBFCFCU, 0xF8FFFFFFU, 0xFFFBF8F8U, 0xF1FFFFFFU, 0xFFFBF1F1U, 0xE3FFFFFFU, 0xFFFBE3E3U,
+	0xC7FFFFFFU, 0xFFFBC7C7U, 0x8FFFFFFFU, 0xFFFB8F8FU, 0x1FFFFFFFU, 0xFFFB1F1FU, 0x3FFFFFFFU, 0xFFFB3F3FU,
+	0x00000000U, 0x1F181C00U, 0x00000000U, 0x0E080800U, 0x00000000U, 0x0E000000U, 0x00000000U, 0x0E020200U,
+	0x00000000U, 0x1F030700U, 0xFFFFFFFFU, 0xFF8B8F8FU, 0xFFFFFFFFU, 0xFF1B1F1FU, 0xFFFFFFFFU, 0xFF3B3F3FU,
+	0x00000000U, 0x1C181C00U, 0x00000000U, 0x08080000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x02020000U,
+	0x00000000U, 0x07030700U, 0xFFFFFFFFU, 0x8F8B8FFFU, 0xFFFFFFFFU, 0x1F1B1FFFU, 0xFFFFFFFFU, 0x3F3B3FFFU,
+	0x00000000U, 0x1C181C00U, 0x00000000U, 0x08080400U, 0x00000000U, 0x00000A00U, 0x00000000U, 0x02020400U,
+	0x00000000U, 0x07031F00U, 0xFFFFFFFFU, 0x8F8BFFFFU, 0xFFFFFFFFU, 0x1F1BFFFFU, 0xFFFFFFFFU, 0x3F3BFFFFU,
+	0xFFFFFCFCU, 0xFFFBFFFFU, 0xFFFFF8F8U, 0xFFFBFFFFU, 0xFFFFF1F1U, 0xFFFBFFFFU, 0xFFFFE3E3U, 0xFFFBFFFFU,
+	0xFFFFC7C7U, 0xFFFBFFFFU, 0xFFFF8F8FU, 0xFFFBFFFFU, 0xFFFF1F1FU, 0xFFFBFFFFU, 0xFFFF3F3FU, 0xFFFBFFFFU,
+	0xFFFCFCFCU, 0xFFFBFFFFU, 0xFFF8F8F8U, 0xFFFBFFFFU, 0xFFF1F1F1U, 0xFFFBFFFFU, 0xFFE3E3E3U, 0xFFFBFFFFU,
+	0xFFC7C7C7U, 0xFFFBFFFFU, 0xFF8F8F8FU, 0xFFFBFFFFU, 0xFF1F1F1FU, 0xFFFBFFFFU, 0xFF3F3F3FU, 0xFFFBFFFFU,
+	0xFCFCFCFFU, 0xFFFBFFFFU, 0xF8F8F8FFU, 0xFFFBFFFFU, 0xF1F1F1FFU, 0xFFFBFFFFU, 0xE3E3E3FFU, 0xFFFBFFFFU,
+	0xC7C7C7FFU, 0xFFFBFFFFU, 0x8F8F8FFFU, 0xFFFBFFFFU, 0x1F1F1FFFU, 0xFFFBFFFFU, 0x3F3F3FFFU, 0xFFFBFFFFU,
+	0xFCFCFFFFU, 0xFFFBFFFCU, 0xF8F8FFFFU, 0xFFFBFFF8U, 0xF1F1FFFFU, 0xFFFBFFF1U, 0xE3E3FFFFU, 0xFFFBFFE3U,
+	0xC7C7FFFFU, 0xFFFBFFC7U, 0x8F8FFFFFU, 0xFFFBFF8FU, 0x1F1FFFFFU, 0xFFFBFF1FU, 0x3F3FFFFFU, 0xFFFBFF3FU,
+	0xFCFFFFFFU, 0xFFFBFCFCU, 0xF8FFFFFFU, 0xFFFBF8F8U, 0xF1FFFFFFU, 0xFFFBF1F1U, 0xE3FFFFFFU, 0xFFFBE3E3U,
+	0xC7FFFFFFU, 0xFFFBC7C7U, 0x8FFFFFFFU, 0xFFFB8F8FU, 0x1FFFFFFFU, 0xFFFB1F1FU, 0x3FFFFFFFU, 0xFFFB3F3FU,
+	0xFFFFFFFFU, 0xFFF8FCFCU, 0xFFFFFFFFU, 0xFFF8F8F8U, 0xFFFFFFFFU, 0xFFF1F1F1U, 0xFFFFFFFFU, 0xFFE3E3E3U,
+	0xFFFFFFFFU, 0xFFC3C7C7U, 0xFFFFFFFFU, 0xFF8B8F8FU, 0xFFFFFFFFU, 0xFF1B1F1FU, 0xFFFFFFFFU, 0xFF3B3F3FU,
+	0xFFFFFFFFU, 0xFCF8FCFFU, 0x00000000U, 0x18181800U, 0x00000000U, 0x00000000U, 0x00000000U, 0x03030300U,
+	0xFFFFFFFFU, 0xC7C3C7FFU, 0xFFFFFFFFU, 0x8F8B8FFFU, 0xFFFFFFFFU, 0x1F1B1FFFU, 0xFFFFFFFFU, 0x3F3B3FFFU,
+	0xFFFFFFFFU, 0xFCF8FFFFU, 0x00000000U, 0x00000000U, 0x00000000U, 0x0011151FU, 0x00000000U, 0x00000000U,
+	0xFFFFFFFFU, 0xC7C3FFFFU, 0xFFFFFFFFU, 0x8F8BFFFFU, 0xFFFFFFFFU, 0x1F1BFFFFU, 0xFFFFFFFFU, 0x3F3BFFFFU,
+	0xFFFFFCFCU, 0xFFF7FFFFU, 0xFFFFF8F8U, 0xFFF7FFFFU, 0xFFFFF1F1U, 0xFFF7FFFFU, 0xFFFFE3E3U, 0xFFF7FFFFU,
+	0xFFFFC7C7U, 0xFFF7FFFFU, 0xFFFF8F8FU, 0xFFF7FFFFU, 0xFFFF1F1FU, 0xFFF7FFFFU, 0xFFFF3F3FU, 0xFFF7FFFFU,
+	0xFFFCFCFCU, 0xFFF7FFFFU, 0xFFF8F8F8U, 0xFFF7FFFFU, 0xFFF1F1F1U, 0xFFF7FFFFU, 0xFFE3E3E3U, 0xFFF7FFFFU,
+	0xFFC7C7C7U, 0xFFF7FFFFU, 0xFF8F8F8FU, 0xFFF7FFFFU, 0xFF1F1F1FU, 0xFFF7FFFFU, 0xFF3F3F3FU, 0xFFF7FFFFU,
+	0xFCFCFCFFU, 0xFFF7FFFFU, 0xF8F8F8FFU, 0xFFF7FFFFU, 0xF1F1F1FFU, 0xFFF7FFFFU, 0xE3E3E3FFU, 0xFFF7FFFFU,
+	0xC7C7C7FFU, 0xFFF7FFFFU, 0x8F8F8FFFU, 0xFFF7FFFFU, 0x1F1F1FFFU, 0xFFF7FFFFU, 0x3F3F3FFFU, 0xFFF7FFFFU,
+	0xFCFCFFFFU, 0xFFF7FFFCU, 0xF8F8FFFFU, 0xFFF7FFF8U, 0xF1F1FFFFU, 0xFFF7FFF1U, 0xE3E3FFFFU, 0xFFF7FFE3U,
+	0xC7C7FFFFU, 0xFFF7FFC7U, 0x8F8FFFFFU, 0xFFF7FF8FU, 0x1F1FFFFFU, 0xFFF7FF1FU, 0x3F3FFFFFU, 0xFFF7FF3FU,
+	0xFCFFFFFFU, 0xFFF7FCFCU, 0xF8FFFFFFU, 0xFFF7F8F8U, 0xF1FFFFFFU, 0xFFF7F1F1U, 0xE3FFFFFFU, 0xFFF7E3E3U,
+	0xC7FFFFFFU, 0xFFF7C7C7U, 0x8FFFFFFFU, 0xFFF78F8FU, 0x1FFFFFFFU, 0xFFF71F1FU, 0x3FFFFFFFU, 0xFFF73F3FU,
+	0xFFFFFFFFU, 0xFFF4FCFCU, 0x00000000U, 0x3E303800U, 0x00000000U, 0x1C101000U, 0x00000000U, 0x1C000000U,
+	0x00000000U, 0x1C040400U, 0x00000000U, 0x3E060E00U, 0xFFFFFFFFU, 0xFF171F1FU, 0xFFFFFFFFU, 0xFF373F3FU,
+	0xFFFFFFFFU, 0xFCF4FCFFU, 0x00000000U, 0x38303800U, 0x00000000U, 0x10100000U, 0x00000000U, 0x00000000U,
+	0x00000000U, 0x04040000U, 0x00000000U, 0x0E060E00U, 0xFFFFFFFFU, 0x1F171FFFU, 0xFFFFFFFFU, 0x3F373FFFU,
+	0xFFFFFFFFU, 0xFCF4FFFFU, 0x00000000U, 0x38303E00U, 0x00000000U, 0x10100800U, 0x00000000U, 0x00001400U,
+	0x00000000U, 0x04040800U, 0x00000000U, 0x0E063E00U, 0xFFFFFFFFU, 0x1F17FFFFU, 0xFFFFFFFFU, 0x3F37FFFFU,
+	0xFFFFFCFCU, 0xFFF7FFFFU, 0xFFFFF8F8U, 0xFFF7FFFFU, 0xFFFFF1F1U, 0xFFF7FFFFU, 0xFFFFE3E3U, 0xFFF7FFFFU,
+	0xFFFFC7C7U, 0xFFF7FFFFU, 0xFFFF8F8FU, 0xFFF7FFFFU, 0xFFFF1F1FU, 0xFFF7FFFFU, 0xFFFF3F3FU, 0xFFF7FFFFU,
+	0xFFFCFCFCU, 0xFFF7FFFFU, 0xFFF8F8F8U, 0xFFF7FFFFU, 0xFFF1F1F1U, 0xFFF7FFFFU, 0xFFE3E3E3U, 0xFFF7FFFFU,
+	0xFFC7C7C7U, 0xFFF7FFFFU, 0xFF8F8F8FU, 0xFFF7FFFFU, 0xFF1F1F1FU, 0xFFF7FFFFU, 0xFF3F3F3FU, 0xFFF7FFFFU,
+	0xFCFCFCFFU, 0xFFF7FFFFU, 0xF8F8F8FFU, 0xFFF7FFFFU, 0xF1F1F1FFU, 0xFFF7FFFFU, 0xE3E3E3FFU, 0xFFF7FFFFU,
+	0xC7C7C7FFU, 0xFFF7FFFFU, 0x8F8F8FFFU, 0xFFF7FFFFU, 0x1F1F1FFFU, 0xFFF7FFFFU, 0x3F3F3FFFU, 0xFFF7FFFFU,
+	0xFCFCFFFFU, 0xFFF7FFFCU, 0xF8F8FFFFU, 0xFFF7FFF8U, 0xF1F1FFFFU, 0xFFF7FFF1U, 0xE3E3FFFFU, 0xFFF7FFE3U,
+	0xC7C7FFFFU, 0xFFF7FFC7U, 0x8F8FFFFFU, 0xFFF7FF8FU, 0x1F1FFFFFU, 0xFFF7FF1FU, 0x3F3FFFFFU, 0xFFF7FF3FU,
+	0xFCFFFFFFU, 0xFFF7FCFCU, 0xF8FFFFFFU, 0xFFF7F8F8U, 0xF1FFFFFFU, 0xFFF7F1F1U, 0xE3FFFFFFU, 0xFFF7E3E3U,
+	0xC7FFFFFFU, 0xFFF7C7C7U, 0x8FFFFFFFU, 0xFFF78F8FU, 0x1FFFFFFFU, 0xFFF71F1FU, 0x3FFFFFFFU, 0xFFF73F3FU,
+	0xFFFFFFFFU, 0xFFF4FCFCU, 0xFFFFFFFFU, 0xFFF0F8F8U, 0xFFFFFFFFU, 0xFFF1F1F1U, 0xFFFFFFFFU, 0xFFE3E3E3U,
+	0xFFFFFFFFU, 0xFFC7C7C7U, 0xFFFFFFFFU, 0xFF878F8FU, 0xFFFFFFFFU, 0xFF171F1FU, 0xFFFFFFFFU, 0xFF373F3FU,
+	0xFFFFFFFFU, 0xFCF4FCFFU, 0xFFFFFFFFU, 0xF8F0F8FFU, 0x00000000U, 0x30303000U, 0x00000000U, 0x00000000U,
+	0x00000000U, 0x06060600U, 0xFFFFFFFFU, 0x8F878FFFU, 0xFFFFFFFFU, 0x1F171FFFU, 0xFFFFFFFFU, 0x3F373FFFU,
+	0xFFFFFFFFU, 0xFCF4FFFFU, 0xFFFFFFFFU, 0xF8F0FFFFU, 0x00000000U, 0x00000000U, 0x00000000U, 0x00222A3EU,
+	0x00000000U, 0x00000000U, 0xFFFFFFFFU, 0x8F87FFFFU, 0xFFFFFFFFU, 0x1F17FFFFU, 0xFFFFFFFFU, 0x3F37FFFFU,
+	0xFFFFFCFCU, 0xFFFFFEFFU, 0xFFFFF8F8U, 0xFFFFFEFFU, 0xFFFFF1F1U, 0xFFFFFEFFU, 0xFFFFE3E3U, 0xFFFFFEFFU,
+	0xFFFFC7C7U, 0xFFFFFEFFU, 0xFFFF8F8FU, 0xFFFFFEFFU, 0xFFFF1F1FU, 0xFFFFFEFFU, 0xFFFF3F3FU, 0xFFFFFEFFU,
+	0xFFFCFCFCU, 0xFFFFFEFFU, 0xFFF8F8F8U, 0xFFFFFEFFU, 0xFFF1F1F1U, 0xFFFFFEFFU, 0xFFE3E3E3U, 0xFFFFFEFFU,
+	0xFFC7C7C7U, 0xFFFFFEFFU, 0xFF8F8F8FU, 0xFFFFFEFFU, 0xFF1F1F1FU, 0xFFFFFEFFU, 0xFF3F3F3FU, 0xFFFFFEFFU,
+	0xFCFCFCFFU, 0xFFFFFEFFU, 0xF8F8F8FFU, 0xFFFFFEFFU, 0xF1F1F1FFU, 0xFFFFFEFFU, 0xE3E3E3FFU, 0xFFFFFEFFU,
+	0xC7C7C7FFU, 0xFFFFFEFFU, 0x8F8F8FFFU, 0xFFFFFEFFU, 0x1F1F1FFFU, 0xFFFFFEFFU, 0x3F3F3FFFU, 0xFFFFFEFFU,
+	0xFCFCFFFFU, 0xFFFFFEFCU, 0xF8F8FFFFU, 0xFFFFFEF8U, 0xF1F1FFFFU, 0xFFFFFEF1U, 0xE3E3FFFFU, 0xFFFFFEE3U,
+	0xC7C7FFFFU, 0xFFFFFEC7U, 0x8F8FFFFFU, 0xFFFFFE8FU, 0x1F1FFFFFU, 0xFFFFFE1FU, 0x3F3FFFFFU, 0xFFFFFE3FU,
+	0x00000000U, 0x00030000U, 0x00000000U, 0x00030000U, 0x00000000U, 0x02070000U, 0x00000000U, 0x070F0202U,
+	0xC7FFFFFFU, 0xFFFFC6C7U, 0x8FFFFFFFU, 0xFFFF8E8FU, 0x1FFFFFFFU, 0xFFFF1E1FU, 0x3FFFFFFFU, 0xFFFF3E3FU,
+	0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x02000000U, 0x00000000U, 0x06020200U,
+	0xFFFFFFFFU, 0xFFC7C6C7U, 0xFFFFFFFFU, 0xFF8F8E8FU, 0xFFFFFFFFU, 0xFF1F1E1FU, 0xFFFFFFFFU, 0xFF3F3E3FU,
+	0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x02020200U,
+	0xFFFFFFFFU, 0xC7C7C6FFU, 0xFFFFFFFFU, 0x8F8F8EFFU, 0xFFFFFFFFU, 0x1F1F1EFFU, 0xFFFFFFFFU, 0x3F3F3EFFU,
+	0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x02020600U,
+	0xFFFFFFFFU, 0xC7C7FEFFU, 0xFFFFFFFFU, 0x8F8FFEFFU, 0xFFFFFFFFU, 0x1F1FFEFFU, 0xFFFFFFFFU, 0x3F3FFEFFU,
+	0xFFFFFCFCU, 0xFFFFFEFFU, 0xFFFFF8F8U, 0xFFFFFEFFU, 0xFFFFF1F1U, 0xFFFFFEFFU, 0xFFFFE3E3U, 0xFFFFFEFFU,
+	0xFFFFC7C7U, 0xFFFFFEFFU, 0xFFFF8F8FU, 0xFFFFFEFFU, 0xFFFF1F1FU, 0xFFFFFEFFU, 0xFFFF3F3FU, 0xFFFFFEFFU,
+	0xFFFCFCFCU, 0xFFFFFEFFU, 0xFFF8F8F8U, 0xFFFFFEFFU, 0xFFF1F1F1U, 0xFFFFFEFFU, 0xFFE3E3E3U, 0xFFFFFEFFU,
+	0xFFC7C7C7U, 0xFFFFFEFFU, 0xFF8F8F8FU, 0xFFFFFEFFU, 0xFF1F1F1FU, 0xFFFFFEFFU, 0xFF3F3F3FU, 0xFFFFFEFFU,
+	0xFCFCFCFFU, 0xFFFFFEFFU, 0xF8F8F8FFU, 0xFFFFFEFFU, 0xF1F1F1FFU, 0xFFFFFEFFU, 0xE3E3E3FFU, 0xFFFFFEFFU,
+	0xC7C7C7FFU, 0xFFFFFEFFU, 0x8F8F8FFFU, 0xFFFFFEFFU, 0x1F1F1FFFU, 0xFFFFFEFFU, 0x3F3F3FFFU, 0xFFFFFEFFU,
+	0xFCFCFFFFU, 0xFFFFFEFCU, 0xF8F8FFFFU, 0xFFFFFEF8U, 0xF1F1FFFFU, 0xFFFFFEF1U, 0xE3E3FFFFU, 0xFFFFFEE3U,
+	0xC7C7FFFFU, 0xFFFFFEC7U, 0x8F8FFFFFU, 0xFFFFFE8FU, 0x1F1FFFFFU, 0xFFFFFE1FU, 0x3F3FFFFFU, 0xFFFFFE3FU,
+	0xFCFFFFFFU, 0xFFFFFCFCU, 0xF8FFFFFFU, 0xFFFFF8F8U, 0xF1FFFFFFU, 0xFFFFF0F1U, 0xE3FFFFFFU, 0xFFFFE2E3U,
+	0xC7FFFFFFU, 0xFFFFC6C7U, 0x8FFFFFFFU, 0xFFFF8E8FU, 0x1FFFFFFFU, 0xFFFF1E1FU, 0x3FFFFFFFU, 0xFFFF3E3FU,
+	0x00000000U, 0x00000000U, 0x00000000U, 0x02000000U, 0x00000000U, 0x07010000U, 0xFFFFFFFFU, 0xFFE3E2E3U,
+	0xFFFFFFFFU, 0xFFC7C6C7U, 0xFFFFFFFFU, 0xFF8F8E8FU, 0xFFFFFFFFU, 0xFF1F1E1FU, 0xFFFFFFFFU, 0xFF3F3E3FU,
+	0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0xFFFFFFFFU, 0xE3E3E2FFU,
+	0xFFFFFFFFU, 0xC7C7C6FFU, 0xFFFFFFFFU, 0x8F8F8EFFU, 0xFFFFFFFFU, 0x1F1F1EFFU, 0xFFFFFFFFU, 0x3F3F3EFFU,
+	0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000600U, 0xFFFFFFFFU, 0xE3E3FEFFU,
+	0xFFFFFFFFU, 0xC7C7FEFFU, 0xFFFFFFFFU, 0x8F8FFEFFU, 0xFFFFFFFFU, 0x1F1FFEFFU, 0xFFFFFFFFU, 0x3F3FFEFFU,
+	0xFFFFFCFCU, 0xFFFFFDFFU, 0xFFFFF8F8U, 0xFFFFFDFFU, 0xFFFFF1F1U, 0xFFFFFDFFU, 0xFFFFE3E3U, 0xFFFFFDFFU,
+	0xFFFFC7C7U, 0xFFFFFDFFU, 0xFFFF8F8FU, 0xFFFFFDFFU, 0xFFFF1F1FU, 0xFFFFFDFFU, 0xFFFF3F3FU, 0xFFFFFDFFU,
+	0xFFFCFCFCU, 0xFFFFFDFFU, 0xFFF8F8F8U, 0xFFFFFDFFU, 0xFFF1F1F1U, 0xFFFFFDFFU, 0xFFE3E3E3U, 0xFFFFFDFFU,
+	0xFFC7C7C7U, 0xFFFFFDFFU, 0xFF8F8F8FU, 0xFFFFFDFFU, 0xFF1F1F1FU, 0xFFFFFDFFU, 0xFF3F3F3FU, 0xFFFFFDFFU,
+	0xFCFCFCFFU, 0xFFFFFDFFU, 0xF8F8F8FFU, 0xFFFFFDFFU, 0xF1F1F1FFU, 0xFFFFFDFFU, 0xE3E3E3FFU, 0xFFFFFDFFU,
+	0xC7C7C7FFU, 0xFFFFFDFFU, 0x8F8F8FFFU, 0xFFFFFDFFU, 0x1F1F1FFFU, 0xFFFFFDFFU, 0x3F3F3FFFU, 0xFFFFFDFFU,
+	0xFCFCFFFFU, 0xFFFFFDFCU, 0xF8F8FFFFU, 0xFFFFFDF8U, 0xF1F1FFFFU, 0xFFFFFDF1U, 0xE3E3FFFFU, 0xFFFFFDE3U,
+	0xC7C7FFFFU, 0xFFFFFDC7U, 0x8F8FFFFFU, 0xFFFFFD8FU, 0x1F1FFFFFU, 0xFFFFFD1FU, 0x3F3FFFFFU, 0xFFFFFD3FU,
+	0x00000000U, 0x00070404U, 0x00000000U, 0x00070000U, 0x00000000U, 0x00070101U, 0x00000000U, 0x070F0103U,
+	0x07000000U, 0x0F1F0507U, 0x8FFFFFFFU, 0xFFFF8D8FU, 0x1FFFFFFFU, 0xFFFF1D1FU, 0x3FFFFFFFU, 0xFFFF3D3FU,
+	0x00000000U, 0x00040400U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00010100U, 0x00000000U, 0x07030103U,
+	0x07000000U, 0x0F070507U, 0xFFFFFFFFU, 0xFF8F8D8FU, 0xFFFFFFFFU, 0xFF1F1D1FU, 0xFFFFFFFFU, 0xFF3F3D3FU,
+	0x00000000U, 0x00040000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00010100U, 0x00000000U, 0x0303010FU,
+	0x07000000U, 0x0707051FU, 0xFFFFFFFFU, 0x8F8F8DFFU, 0xFFFFFFFFU, 0x1F1F1DFFU, 0xFFFFFFFFU, 0x3F3F3DFFU,
+	0x00000000U, 0x00000500U, 0x00000000U, 0x00000000U, 0x00000000U, 0x01010500U, 0x00000000U, 0x0303090FU,
+	0x1F000000U, 0x07071D1FU, 0xFFFFFFFFU, 0x8F8FFDFFU, 0xFFFFFFFFU, 0x1F1FFDFFU, 0xFFFFFFFFU, 0x3F3FFDFFU,
+	0xFFFFFCFCU, 0xFFFFFDFFU, 0xFFFFF8F8U, 0xFFFFFDFFU, 0xFFFFF1F1U, 0xFFFFFDFFU, 0xFFFFE3E3U, 0xFFFFFDFFU,
+	0xFFFFC7C7U, 0xFFFFFDFFU, 0xFFFF8F8FU, 0xFFFFFDFFU, 0xFFFF1F1FU, 0xFFFFFDFFU, 0xFFFF3F3FU, 0xFFFFFDFFU,
+	0xFFFCFCFCU, 0xFFFFFDFFU, 0xFFF8F8F8U, 0xFFFFFDFFU, 0xFFF1F1F1U, 0xFFFFFDFFU, 0xFFE3E3E3U, 0xFFFFFDFFU,
+	0xFFC7C7C7U, 0xFFFFFDFFU, 0xFF8F8F8FU, 0xFFFFFDFFU, 0xFF1F1F1FU, 0xFFFFFDFFU, 0xFF3F3F3FU, 0xFFFFFDFFU,
+	0xFCFCFCFFU, 0xFFFFFDFFU, 0xF8F8F8FFU, 0xFFFFFDFFU, 0xF1F1F1FFU, 0xFFFFFDFFU, 0xE3E3E3FFU, 0xFFFFFDFFU,
+	0xC7C7C7FFU, 0xFFFFFDFFU, 0x8F8F8FFFU, 0xFFFFFDFFU, 0x1F1F1FFFU, 0xFFFFFDFFU, 0x3F3F3FFFU, 0xFFFFFDFFU,
+	0xFCFCFFFFU, 0xFFFFFDFCU, 0xF8F8FFFFU, 0xFFFFFDF8U, 0xF1F1FFFFU, 0xFFFFFDF1U, 0xE3E3FFFFU, 0xFFFFFDE3U,
+	0xC7C7FFFFU, 0xFFFFFDC7U, 0x8F8FFFFFU, 0xFFFFFD8FU, 0x1F1FFFFFU, 0xFFFFFD1FU, 0x3F3FFFFFU, 0xFFFFFD3FU,
+	0xFCFFFFFFU, 0xFFFFFCFCU, 0xF8FFFFFFU, 0xFFFFF8F8U, 0xF1FFFFFFU, 0xFFFFF1F1U, 0xE3FFFFFFU, 0xFFFFE1E3U,
+	0xC7FFFFFFU, 0xFFFFC5C7U, 0x8FFFFFFFU, 0xFFFF8D8FU, 0x1FFFFFFFU, 0xFFFF1D1FU, 0x3FFFFFFFU, 0xFFFF3D3FU,
+	0x00000000U, 0x0F0C0C0CU, 0x00000000U, 0x00000000U, 0x00000000U, 0x07010101U, 0x07000000U, 0x0F030103U,
+	0xFFFFFFFFU, 0xFFC7C5C7U, 0xFFFFFFFFU, 0xFF8F8D8FU, 0xFFFFFFFFU, 0xFF1F1D1FU, 0xFFFFFFFFU, 0xFF3F3D3FU,
+	0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x1F000000U, 0x0303011FU,
+	0xFFFFFFFFU, 0xC7C7C5FFU, 0xFFFFFFFFU, 0x8F8F8DFFU, 0xFFFFFFFFU, 0x1F1F1DFFU, 0xFFFFFFFFU, 0x3F3F3DFFU,
+	0x00000000U, 0x040C080FU, 0x00000000U, 0x00000500U, 0x00000000U, 0x0101090FU, 0x1F000000U, 0x03031D1FU,
+	0xFFFFFFFFU, 0xC7C7FDFFU, 0xFFFFFFFFU, 0x8F8FFDFFU, 0xFFFFFFFFU, 0x1F1FFDFFU, 0xFFFFFFFFU, 0x3F3FFDFFU,
+	0xFFFFFCFCU, 0xFFFFFBFFU, 0xFFFFF8F8U, 0xFFFFFBFFU, 0xFFFFF1F1U, 0xFFFFFBFFU, 0xFFFFE3E3U, 0xFFFFFBFFU,
+	0xFFFFC7C7U, 0xFFFFFBFFU, 0xFFFF8F8FU, 0xFFFFFBFFU, 0xFFFF1F1FU, 0xFFFFFBFFU, 0xFFFF3F3FU, 0xFFFFFBFFU,
+	0xFFFCFCFCU, 0xFFFFFBFFU, 0xFFF8F8F8U, 0xFFFFFBFFU, 0xFFF1F1F1U, 0xFFFFFBFFU, 0xFFE3E3E3U, 0xFFFFFBFFU,
+	0xFFC7C7C7U, 0xFFFFFBFFU, 0xFF8F8F8FU, 0xFFFFFBFFU, 0xFF1F1F1FU, 0xFFFFFBFFU, 0xFF3F3F3FU, 0xFFFFFBFFU,
+	0xFCFCFCFFU, 0xFFFFFBFFU, 0xF8F8F8FFU, 0xFFFFFBFFU, 0xF1F1F1FFU, 0xFFFFFBFFU, 0xE3E3E3FFU, 0xFFFFFBFFU,
+	0xC7C7C7FFU, 0xFFFFFBFFU, 0x8F8F8FFFU, 0xFFFFFBFFU, 0x1F1F1FFFU, 0xFFFFFBFFU, 0x3F3F3FFFU, 0xFFFFFBFFU,
+	0xFCFCFFFFU, 0xFFFFFBFCU, 0xF8F8FFFFU, 0xFFFFFBF8U, 0xF1F1FFFFU, 0xFFFFFBF1U, 0xE3E3FFFFU, 0xFFFFFBE3U,
+	0xC7C7FFFFU, 0xFFFFFBC7U, 0x8F8FFFFFU, 0xFFFFFB8FU, 0x1F1FFFFFU, 0xFFFFFB1FU, 0x3F3FFFFFU, 0xFFFFFB3FU,
+	0x00000000U, 0x1E1F181CU, 0x00000000U, 0x000E0808U, 0x00000000U, 0x000E0000U, 0x00000000U, 0x000E0202U,
+	0x00000000U, 0x0F1F0307U, 0x0F000000U, 0x1F3F0B0FU, 0x1FFFFFFFU, 0xFFFF1B1FU, 0x3FFFFFFFU, 0xFFFF3B3FU,
+	0x00000000U, 0x1E1C181CU, 0x00000000U, 0x00080800U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00020200U,
+	0x00000000U, 0x0F070307U, 0x0F000000U, 0x1F0F0B0FU, 0xFFFFFFFFU, 0xFF1F1B1FU, 0xFFFFFFFFU, 0xFF3F3B3FU,
+	0x00000000U, 0x1C1C181FU, 0x00000000U, 0x00080800U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00020200U,
+	0x00000000U, 0x0707031FU, 0x0F000000U, 0x0F0F0B3FU, 0xFFFFFFFFU, 0x1F1F1BFFU, 0xFFFFFFFFU, 0x3F3F3BFFU,
+	0x00000000U, 0x1C1C191FU, 0x00000000U, 0x08080A00U, 0x00000000U, 0x00000000U, 0x00000000U, 0x02020A00U,
+	0x00000000U, 0x0707131FU, 0x3F000000U, 0x0F0F3B3FU, 0xFFFFFFFFU, 0x1F1FFBFFU, 0xFFFFFFFFU, 0x3F3FFBFFU,
+	0xFFFFFCFCU, 0xFFFFFBFFU, 0xFFFFF8F8U, 0xFFFFFBFFU, 0xFFFFF1F1U, 0xFFFFFBFFU, 0xFFFFE3E3U, 0xFFFFFBFFU,
+	0xFFFFC7C7U, 0xFFFFFBFFU, 0xFFFF8F8FU, 0xFFFFFBFFU, 0xFFFF1F1FU, 0xFFFFFBFFU, 0xFFFF3F3FU, 0xFFFFFBFFU,
+	0xFFFCFCFCU, 0xFFFFFBFFU, 0xFFF8F8F8U, 0xFFFFFBFFU, 0xFFF1F1F1U, 0xFFFFFBFFU, 0xFFE3E3E3U, 0xFFFFFBFFU,
+	0xFFC7C7C7U, 0xFFFFFBFFU, 0xFF8F8F8FU, 0xFFFFFBFFU, 0xFF1F1F1FU, 0xFFFFFBFFU, 0xFF3F3F3FU, 0xFFFFFBFFU,
+	0xFCFCFCFFU, 0xFFFFFBFFU, 0xF8F8F8FFU, 0xFFFFFBFFU, 0xF1F1F1FFU, 0xFFFFFBFFU, 0xE3E3E3FFU, 0xFFFFFBFFU,
+	0xC7C7C7FFU, 0xFFFFFBFFU, 0x8F8F8FFFU, 0xFFFFFBFFU, 0x1F1F1FFFU, 0xFFFFFBFFU, 0x3F3F3FFFU, 0xFFFFFBFFU,
+	0xFCFCFFFFU, 0xFFFFFBFCU, 0xF8F8FFFFU, 0xFFFFFBF8U, 0xF1F1FFFFU, 0xFFFFFBF1U, 0xE3E3FFFFU, 0xFFFFFBE3U,
+	0xC7C7FFFFU, 0xFFFFFBC7U, 0x8F8FFFFFU, 0xFFFFFB8FU, 0x1F1FFFFFU, 0xFFFFFB1FU, 0x3F3FFFFFU, 0xFFFFFB3FU,
+	0xFCFFFFFFU, 0xFFFFF8FCU, 0xF8FFFFFFU, 0xFFFFF8F8U, 0xF1FFFFFFU, 0xFFFFF1F1U, 0xE3FFFFFFU, 0xFFFFE3E3U,
+	0xC7FFFFFFU, 0xFFFFC3C7U, 0x8FFFFFFFU, 0xFFFF8B8FU, 0x1FFFFFFFU, 0xFFFF1B1FU, 0x3FFFFFFFU, 0xFFFF3B3FU,
+	0x3E000000U, 0x3F3C383CU, 0x00000000U, 0x1E181818U, 0x00000000U, 0x00000000U, 0x00000000U, 0x0F030303U,
+	0x0F000000U, 0x1F070307U, 0xFFFFFFFFU, 0xFF8F8B8FU, 0xFFFFFFFFU, 0xFF1F1B1FU, 0xFFFFFFFFU, 0xFF3F3B3FU,
+	0x3F000000U, 0x3C3C383FU, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U,
+	0x3F000000U, 0x0707033FU, 0xFFFFFFFFU, 0x8F8F8BFFU, 0xFFFFFFFFU, 0x1F1F1BFFU, 0xFFFFFFFFU, 0x3F3F3BFFU,
+	0x3F000000U, 0x3C3C3B3FU, 0x00000000U, 0x1818191FU, 0x00000000U, 0x00000A00U, 0x00000000U, 0x0303131FU,
+	0x3F000000U, 0x07073B3FU, 0xFFFFFFFFU, 0x8F8FFBFFU, 0xFFFFFFFFU, 0x1F1FFBFFU, 0xFFFFFFFFU, 0x3F3FFBFFU,
+	0xFFFFFCFCU, 0xFFFFF7FFU, 0xFFFFF8F8U, 0xFFFFF7FFU, 0xFFFFF1F1U, 0xFFFFF7FFU, 0xFFFFE3E3U, 0xFFFFF7FFU,
+	0xFFFFC7C7U, 0xFFFFF7FFU, 0xFFFF8F8FU, 0xFFFFF7FFU, 0xFFFF1F1FU, 0xFFFFF7FFU, 0xFFFF3F3FU, 0xFFFFF7FFU,
+	0xFFFCFCFCU, 0xFFFFF7FFU, 0xFFF8F8F8U, 0xFFFFF7FFU, 0xFFF1F1F1U, 0xFFFFF7FFU, 0xFFE3E3E3U, 0xFFFFF7FFU,
+	0xFFC7C7C7U, 0xFFFFF7FFU, 0xFF8F8F8FU, 0xFFFFF7FFU, 0xFF1F1F1FU, 0xFFFFF7FFU, 0xFF3F3F3FU, 0xFFFFF7FFU,
+	0xFCFCFCFFU, 0xFFFFF7FFU, 0xF8F8F8FFU, 0xFFFFF7FFU, 0xF1F1F1FFU, 0xFFFFF7FFU, 0xE3E3E3FFU, 0xFFFFF7FFU,
+	0xC7C7C7FFU, 0xFFFFF7FFU, 0x8F8F8FFFU, 0xFFFFF7FFU, 0x1F1F1FFFU, 0xFFFFF7FFU, 0x3F3F3FFFU, 0xFFFFF7FFU,
+	0xFCFCFFFFU, 0xFFFFF7FCU, 0xF8F8FFFFU, 0xFFFFF7F8U, 0xF1F1FFFFU, 0xFFFFF7F1U, 0xE3E3FFFFU, 0xFFFFF7E3U,
+	0xC7C7FFFFU, 0xFFFFF7C7U, 0x8F8FFFFFU, 0xFFFFF78FU, 0x1F1FFFFFU, 0xFFFFF71FU, 0x3F3FFFFFU, 0xFFFFF73FU,
+	0x7C000000U, 0x7E7F747CU, 0x00000000U, 0x3C3E3038U, 0x00000000U, 0x001C1010U, 0x00000000U, 0x001C0000U,
+	0x00000000U, 0x001C0404U, 0x00000000U, 0x1E3E060EU, 0x1F000000U, 0x3F7F171FU, 0x3FFFFFFFU, 0xFFFF373FU,
+	0x7C000000U, 0x7E7C747CU, 0x00000000U, 0x3C383038U, 0x00000000U, 0x00101000U, 0x00000000U, 0x00000000U,
+	0x00000000U, 0x00040400U, 0x00000000U, 0x1E0E060EU, 0x1F000000U, 0x3F1F171FU, 0xFFFFFFFFU, 0xFF3F373FU,
+	0x7C000000U, 0x7C7C747FU, 0x00000000U, 0x3838303EU, 0x00000000U, 0x00101000U, 0x00000000U, 0x00000000U,
+	0x00000000U, 0x00040400U, 0x00000000U, 0x0E0E063EU, 0x1F000000U, 0x1F1F177FU, 0xFFFFFFFFU, 0x3F3F37FFU,
+	0x7F000000U, 0x7C7C777FU, 0x00000000U, 0x3838323EU, 0x00000000U, 0x10101400U, 0x00000000U, 0x00000000U,
+	0x00000000U, 0x04041400U, 0x00000000U, 0x0E0E263EU, 0x7F000000U, 0x1F1F777FU, 0xFFFFFFFFU, 0x3F3FF7FFU,
+	0xFFFFFCFCU, 0xFFFFF7FFU, 0xFFFFF8F8U, 0xFFFFF7FFU, 0xFFFFF1F1U, 0xFFFFF7FFU, 0xFFFFE3E3U, 0xFFFFF7FFU,
+	0xFFFFC7C7U, 0xFFFFF7FFU, 0xFFFF8F8FU, 0xFFFFF7FFU, 0xFFFF1F1FU, 0xFFFFF7FFU, 0xFFFF3F3FU, 0xFFFFF7FFU,
+	0xFFFCFCFCU, 0xFFFFF7FFU, 0xFFF8F8F8U, 0xFFFFF7FFU, 0xFFF1F1F1U, 0xFFFFF7FFU, 0xFFE3E3E3U, 0xFFFFF7FFU,
+	0xFFC7C7C7U, 0xFFFFF7FFU, 0xFF8F8F8FU, 0xFFFFF7FFU, 0xFF1F1F1FU, 0xFFFFF7FFU, 0xFF3F3F3FU, 0xFFFFF7FFU,
+	0xFCFCFCFFU, 0xFFFFF7FFU, 0xF8F8F8FFU, 0xFFFFF7FFU, 0xF1F1F1FFU, 0xFFFFF7FFU, 0xE3E3E3FFU, 0xFFFFF7FFU,
+	0xC7C7C7FFU, 0xFFFFF7FFU, 0x8F8F8FFFU, 0xFFFFF7FFU, 0x1F1F1FFFU, 0xFFFFF7FFU, 0x3F3F3FFFU, 0xFFFFF7FFU,
+	0xFCFCFFFFU, 0xFFFFF7FCU, 0xF8F8FFFFU, 0xFFFFF7F8U, 0xF1F1FFFFU, 0xFFFFF7F1U, 0xE3E3FFFFU, 0xFFFFF7E3U,
+	0xC7C7FFFFU, 0xFFFFF7C7U, 0x8F8FFFFFU, 0xFFFFF78FU, 0x1F1FFFFFU, 0xFFFFF71FU, 0x3F3FFFFFU, 0xFFFFF73FU,
+	0xFCFFFFFFU, 0xFFFFF4FCU, 0xF8FFFFFFU, 0xFFFFF0F8U, 0xF1FFFFFFU, 0xFFFFF1F1U, 0xE3FFFFFFU, 0xFFFFE3E3U,
+	0xC7FFFFFFU, 0xFFFFC7C7U, 0x8FFFFFFFU, 0xFFFF878FU, 0x1FFFFFFFU, 0xFFFF171FU, 0x3FFFFFFFU, 0xFFFF373FU,
+	0xFFFFFFFFU, 0xFFFCF4FCU, 0x7C000000U, 0x7E787078U, 0x00000000U, 0x3C303030U, 0x00000000U, 0x00000000U,
+	0x00000000U, 0x1E060606U, 0x1F000000U, 0x3F0F070FU, 0xFFFFFFFFU, 0xFF1F171FU, 0xFFFFFFFFU, 0xFF3F373FU,
+	0xFFFFFFFFU, 0xFCFCF4FFU, 0x7F000000U, 0x7878707FU, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U,
+	0x00000000U, 0x00000000U, 0x7F000000U, 0x0F0F077FU, 0xFFFFFFFFU, 0x1F1F17FFU, 0xFFFFFFFFU, 0x3F3F37FFU,
+	0xFFFFFFFFU, 0xFCFCF7FFU, 0x7F000000U, 0x7878777FU, 0x00000000U, 0x3030323EU, 0x00000000U, 0x00001400U,
+	0x00000000U, 0x0606263EU, 0x7F000000U, 0x0F0F777FU, 0xFFFFFFFFU, 0x1F1FF7FFU, 0xFFFFFFFFU, 0x3F3FF7FFU,
+	0xFFFFFCFCU, 0xFFFFFFFEU, 0xFFFFF8F8U, 0xFFFFFFFEU, 0xFFFFF1F1U, 0xFFFFFFFEU, 0xFFFFE3E3U, 0xFFFFFFFEU,
+	0xFFFFC7C7U, 0xFFFFFFFEU, 0xFFFF8F8FU, 0xFFFFFFFEU, 0xFFFF1F1FU, 0xFFFFFFFEU, 0xFFFF3F3FU, 0xFFFFFFFEU,
+	0xFFFCFCFCU, 0xFFFFFFFEU, 0xFFF8F8F8U, 0xFFFFFFFEU, 0xFFF1F1F1U, 0xFFFFFFFEU, 0xFFE3E3E3U, 0xFFFFFFFEU,
+	0xFFC7C7C7U, 0xFFFFFFFEU, 0xFF8F8F8FU, 0xFFFFFFFEU, 0xFF1F1F1FU, 0xFFFFFFFEU, 0xFF3F3F3FU, 0xFFFFFFFEU,
+	0xFCFCFCFFU, 0xFFFFFFFEU, 0xF8F8F8FFU, 0xFFFFFFFEU, 0xF1F1F1FFU, 0xFFFFFFFEU, 0xE3E3E3FFU, 0xFFFFFFFEU,
+	0xC7C7C7FFU, 0xFFFFFFFEU, 0x8F8F8FFFU, 0xFFFFFFFEU, 0x1F1F1FFFU, 0xFFFFFFFEU, 0x3F3F3FFFU, 0xFFFFFFFEU,
+	0x00000000U, 0x00000300U, 0x00000000U, 0x00000300U, 0x00000000U, 0x00030700U, 0x02000000U, 0x07070F02U,
+	0x07000000U, 0x0F0F1F06U, 0x8F8FFFFFU, 0xFFFFFF8EU, 0x1F1FFFFFU, 0xFFFFFF1EU, 0x3F3FFFFFU, 0xFFFFFF3EU,
+	0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00020000U, 0x00000000U, 0x02060202U,
+	0x00000000U, 0x070F0706U, 0x8FFFFFFFU, 0xFFFF8F8EU, 0x1FFFFFFFU, 0xFFFF1F1EU, 0x3FFFFFFFU, 0xFFFF3F3EU,
+	0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x02020200U,
+	0x00000000U, 0x07070700U, 0xFFFFFFFFU, 0xFF8F8F8EU, 0xFFFFFFFFU, 0xFF1F1F1EU, 0xFFFFFFFFU, 0xFF3F3F3EU,
+	0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x02020000U,
+	0x00000000U, 0x07070700U, 0xFFFFFFFFU, 0x8F8F8FFEU, 0xFFFFFFFFU, 0x1F1F1FFEU, 0xFFFFFFFFU, 0x3F3F3FFEU,
+	0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x02020000U,
+	0x00000000U, 0x07070700U, 0xFFFFFFFFU, 0x8F8FFFFEU, 0xFFFFFFFFU, 0x1F1FFFFEU, 0xFFFFFFFFU, 0x3F3FFFFEU,
+	0xFFFFFCFCU, 0xFFFFFFFEU, 0xFFFFF8F8U, 0xFFFFFFFEU, 0xFFFFF1F1U, 0xFFFFFFFEU, 0xFFFFE3E3U, 0xFFFFFFFEU,
+	0xFFFFC7C7U, 0xFFFFFFFEU, 0xFFFF8F8FU, 0xFFFFFFFEU, 0xFFFF1F1FU, 0xFFFFFFFEU, 0xFFFF3F3FU, 0xFFFFFFFEU,
+	0xFFFCFCFCU, 0xFFFFFFFEU, 0xFFF8F8F8U, 0xFFFFFFFEU, 0xFFF1F1F1U, 0xFFFFFFFEU, 0xFFE3E3E3U, 0xFFFFFFFEU,
+	0xFFC7C7C7U, 0xFFFFFFFEU, 0xFF8F8F8FU, 0xFFFFFFFEU, 0xFF1F1F1FU, 0xFFFFFFFEU, 0xFF3F3F3FU, 0xFFFFFFFEU,
+	0xFCFCFCFFU, 0xFFFFFFFEU, 0xF8F8F8FFU, 0xFFFFFFFEU, 0xF1F1F1FFU, 0xFFFFFFFEU, 0xE3E3E3FFU, 0xFFFFFFFEU,
+	0xC7C7C7FFU, 0xFFFFFFFEU, 0x8F8F8FFFU, 0xFFFFFFFEU, 0x1F1F1FFFU, 0xFFFFFFFEU, 0x3F3F3FFFU, 0xFFFFFFFEU,
+	0xFCFCFFFFU, 0xFFFFFFFCU, 0xF8F8FFFFU, 0xFFFFFFF8U, 0xF1F1FFFFU, 0xFFFFFFF0U, 0xE3E3FFFFU, 0xFFFFFFE2U,
+	0xC7C7FFFFU, 0xFFFFFFC6U, 0x8F8FFFFFU, 0xFFFFFF8EU, 0x1F1FFFFFU, 0xFFFFFF1EU, 0x3F3FFFFFU, 0xFFFFFF3EU,
+	0x00000000U, 0x00000000U, 0x00000000U, 0x00030000U, 0x00000000U, 0x07070100U, 0x03000000U, 0x0F0F0302U,
+	0xC7FFFFFFU, 0xFFFFC7C6U, 0x8FFFFFFFU, 0xFFFF8F8EU, 0x1FFFFFFFU, 0xFFFF1F1EU, 0x3FFFFFFFU, 0xFFFF3F3EU,
+	0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x02000000U, 0x00000000U, 0x07030302U,
+	0xFFFFFFFFU, 0xFFC7C7C6U, 0xFFFFFFFFU, 0xFF8F8F8EU, 0xFFFFFFFFU, 0xFF1F1F1EU, 0xFFFFFFFFU, 0xFF3F3F3EU,
+	0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x03030300U,
+	0xFFFFFFFFU, 0xC7C7C7FEU, 0xFFFFFFFFU, 0x8F8F8FFEU, 0xFFFFFFFFU, 0x1F1F1FFEU, 0xFFFFFFFFU, 0x3F3F3FFEU,
+	0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x03030700U,
+	0xFFFFFFFFU, 0xC7C7FFFEU, 0xFFFFFFFFU, 0x8F8FFFFEU, 0xFFFFFFFFU, 0x1F1FFFFEU, 0xFFFFFFFFU, 0x3F3FFFFEU,
+	0xFFFFFCFCU, 0xFFFFFFFDU, 0xFFFFF8F8U, 0xFFFFFFFDU, 0xFFFFF1F1U, 0xFFFFFFFDU, 0xFFFFE3E3U, 0xFFFFFFFDU,
+	0xFFFFC7C7U, 0xFFFFFFFDU, 0xFFFF8F8FU, 0xFFFFFFFDU, 0xFFFF1F1FU, 0xFFFFFFFDU, 0xFFFF3F3FU, 0xFFFFFFFDU,
+	0xFFFCFCFCU, 0xFFFFFFFDU, 0xFFF8F8F8U, 0xFFFFFFFDU, 0xFFF1F1F1U, 0xFFFFFFFDU, 0xFFE3E3E3U, 0xFFFFFFFDU,
+	0xFFC7C7C7U, 0xFFFFFFFDU, 0xFF8F8F8FU, 0xFFFFFFFDU, 0xFF1F1F1FU, 0xFFFFFFFDU, 0xFF3F3F3FU, 0xFFFFFFFDU,
+	0xFCFCFCFFU, 0xFFFFFFFDU, 0xF8F8F8FFU, 0xFFFFFFFDU, 0xF1F1F1FFU, 0xFFFFFFFDU, 0xE3E3E3FFU, 0xFFFFFFFDU,
+	0xC7C7C7FFU, 0xFFFFFFFDU, 0x8F8F8FFFU, 0xFFFFFFFDU, 0x1F1F1FFFU, 0xFFFFFFFDU, 0x3F3F3FFFU, 0xFFFFFFFDU,
+	0x04000000U, 0x00000704U, 0x00000000U, 0x00000700U, 0x01000000U, 0x00000701U, 0x03000000U, 0x00070F01U,
+	0x07070000U, 0x0F0F1F05U, 0x0F070000U, 0x1F1F3F0DU, 0x1F1FFFFFU, 0xFFFFFF1DU, 0x3F3FFFFFU, 0xFFFFFF3DU,
+	0x00000000U, 0x00000404U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000101U, 0x03000000U, 0x00070301U,
+	0x03000000U, 0x070F0705U, 0x0F070000U, 0x0F1F0F0DU, 0x1FFFFFFFU, 0xFFFF1F1DU, 0x3FFFFFFFU, 0xFFFF3F3DU,
+	0x00000000U, 0x00000400U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000100U, 0x00000000U, 0x00030301U,
+	0x03000000U, 0x07070705U, 0x0F070000U, 0x0F0F0F0DU, 0xFFFFFFFFU, 0xFF1F1F1DU, 0xFFFFFFFFU, 0xFF3F3F3DU,
+	0x00000000U, 0x00040400U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00010100U, 0x00000000U, 0x03030301U,
+	0x03000000U, 0x0707070DU, 0x0F070000U, 0x0F0F0F1DU, 0xFFFFFFFFU, 0x1F1F1FFDU, 0xFFFFFFFFU, 0x3F3F3FFDU,
+	0x00000000U, 0x04040700U, 0x00000000U, 0x00000700U, 0x00000000U, 0x01010700U, 0x00000000U, 0x03030F01U,
+	0x03000000U, 0x07071F0DU, 0x1F070000U, 0x0F0F3F1DU, 0xFFFFFFFFU, 0x1F1FFFFDU, 0xFFFFFFFFU, 0x3F3FFFFDU,
+	0xFFFFFCFCU, 0xFFFFFFFDU, 0xFFFFF8F8U, 0xFFFFFFFDU, 0xFFFFF1F1U, 0xFFFFFFFDU, 0xFFFFE3E3U, 0xFFFFFFFDU,
+	0xFFFFC7C7U, 0xFFFFFFFDU, 0xFFFF8F8FU, 0xFFFFFFFDU, 0xFFFF1F1FU, 0xFFFFFFFDU, 0xFFFF3F3FU, 0xFFFFFFFDU,
+	0xFFFCFCFCU, 0xFFFFFFFDU, 0xFFF8F8F8U, 0xFFFFFFFDU, 0xFFF1F1F1U, 0xFFFFFFFDU, 0xFFE3E3E3U, 0xFFFFFFFDU,
+	0xFFC7C7C7U, 0xFFFFFFFDU, 0xFF8F8F8FU, 0xFFFFFFFDU, 0xFF1F1F1FU, 0xFFFFFFFDU, 0xFF3F3F3FU, 0xFFFFFFFDU,
+	0xFCFCFCFFU, 0xFFFFFFFDU, 0xF8F8F8FFU, 0xFFFFFFFDU, 0xF1F1F1FFU, 0xFFFFFFFDU, 0xE3E3E3FFU, 0xFFFFFFFDU,
+	0xC7C7C7FFU, 0xFFFFFFFDU, 0x8F8F8FFFU, 0xFFFFFFFDU, 0x1F1F1FFFU, 0xFFFFFFFDU, 0x3F3F3FFFU, 0xFFFFFFFDU,
+	0xFCFCFFFFU, 0xFFFFFFFCU, 0xF8F8FFFFU, 0xFFFFFFF8U, 0xF1F1FFFFU, 0xFFFFFFF1U, 0xE3E3FFFFU, 0xFFFFFFE1U,
+	0xC7C7FFFFU, 0xFFFFFFC5U, 0x8F8FFFFFU, 0xFFFFFF8DU, 0x1F1FFFFFU, 0xFFFFFF1DU, 0x3F3FFFFFU, 0xFFFFFF3DU,
+	0x0C000000U, 0x000F0C0CU, 0x00000000U, 0x00000000U, 0x01000000U, 0x00070101U, 0x03070000U, 0x0F0F0301U,
+	0x07070000U, 0x1F1F0705U, 0x8FFFFFFFU, 0xFFFF8F8DU, 0x1FFFFFFFU, 0xFFFF1F1DU, 0x3FFFFFFFU, 0xFFFF3F3DU,
+	0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x03000000U, 0x07030301U,
+	0x0F070000U, 0x0F070705U, 0xFFFFFFFFU, 0xFF8F8F8DU, 0xFFFFFFFFU, 0xFF1F1F1DU, 0xFFFFFFFFU, 0xFF3F3F3DU,
+	0x00000000U, 0x0C0C0C0CU, 0x00000000U, 0x00000000U, 0x00000000U, 0x01010101U, 0x03000000U, 0x0303030DU,
+	0x1F070000U, 0x0707071DU, 0xFFFFFFFFU, 0x8F8F8FFDU, 0xFFFFFFFFU, 0x1F1F1FFDU, 0xFFFFFFFFU, 0x3F3F3FFDU,
+	0x00000000U, 0x0C0C0F0DU, 0x00000000U, 0x00080F0DU, 0x00000000U, 0x01010F0DU, 0x03000000U, 0x03031F1DU,
+	0x1F070000U, 0x07073F3DU, 0xFFFFFFFFU, 0x8F8FFFFDU, 0xFFFFFFFFU, 0x1F1FFFFDU, 0xFFFFFFFFU, 0x3F3FFFFDU,
+	0xFFFFFCFCU, 0xFFFFFFFBU, 0xFFFFF8F8U, 0xFFFFFFFBU, 0xFFFFF1F1U, 0xFFFFFFFBU, 0xFFFFE3E3U, 0xFFFFFFFBU,
+	0xFFFFC7C7U, 0xFFFFFFFBU, 0xFFFF8F8FU, 0xFFFFFFFBU, 0xFFFF1F1FU, 0xFFFFFFFBU, 0xFFFF3F3FU, 0xFFFFFFFBU,
+	0xFFFCFCFCU, 0xFFFFFFFBU, 0xFFF8F8F8U, 0xFFFFFFFBU, 0xFFF1F1F1U, 0xFFFFFFFBU, 0xFFE3E3E3U, 0xFFFFFFFBU,
+	0xFFC7C7C7U, 0xFFFFFFFBU, 0xFF8F8F8FU, 0xFFFFFFFBU, 0xFF1F1F1FU, 0xFFFFFFFBU, 0xFF3F3F3FU, 0xFFFFFFFBU,
+	0xFCFCFCFFU, 0xFFFFFFFBU, 0xF8F8F8FFU, 0xFFFFFFFBU, 0xF1F1F1FFU, 0xFFFFFFFBU, 0xE3E3E3FFU, 0xFFFFFFFBU,
+	0xC7C7C7FFU, 0xFFFFFFFBU, 0x8F8F8FFFU, 0xFFFFFFFBU, 0x1F1F1FFFU, 0xFFFFFFFBU, 0x3F3F3FFFU, 0xFFFFFFFBU,
+	0x1C000000U, 0x001E1F18U, 0x08000000U, 0x00000E08U, 0x00000000U, 0x00000E00U, 0x02000000U, 0x00000E02U,
+	0x07000000U, 0x000F1F03U, 0x0F0F0000U, 0x1F1F3F0BU, 0x1F0F0000U, 0x3F3F7F1BU, 0x3F3FFFFFU, 0xFFFFFF3BU,
+	0x1C000000U, 0x001E1C18U, 0x00000000U, 0x00000808U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000202U,
+	0x07000000U, 0x000F0703U, 0x07000000U, 0x0F1F0F0BU, 0x1F0F0000U, 0x1F3F1F1BU, 0x3FFFFFFFU, 0xFFFF3F3BU,
+	0x00000000U, 0x001C1C18U, 0x00000000U, 0x00000800U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000200U,
+	0x00000000U, 0x00070703U, 0x07000000U, 0x0F0F0F0BU, 0x1F0F0000U, 0x1F1F1F1BU, 0xFFFFFFFFU, 0xFF3F3F3BU,
+	0x00000000U, 0x1C1C1C18U, 0x00000000U, 0x00080800U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00020200U,
+	0x00000000U, 0x07070703U, 0x07000000U, 0x0F0F0F1BU, 0x1F0F0000U, 0x1F1F1F3BU, 0xFFFFFFFFU, 0x3F3F3FFBU,
+	0x00000000U, 0x1C1C1F18U, 0x00000000U, 0x08080E00U, 0x00000000U, 0x00000E00U, 0x00000000U, 0x02020E00U,
+	0x00000000U, 0x07071F03U, 0x07000000U, 0x0F0F3F1BU, 0x3F0F0000U, 0x1F1F7F3BU, 0xFFFFFFFFU, 0x3F3FFFFBU,
+	0xFFFFFCFCU, 0xFFFFFFFBU, 0xFFFFF8F8U, 0xFFFFFFFBU, 0xFFFFF1F1U, 0xFFFFFFFBU, 0xFFFFE3E3U, 0xFFFFFFFBU,
+	0xFFFFC7C7U, 0xFFFFFFFBU, 0xFFFF8F8FU, 0xFFFFFFFBU, 0xFFFF1F1FU, 0xFFFFFFFBU, 0xFFFF3F3FU, 0xFFFFFFFBU,
+	0xFFFCFCFCU, 0xFFFFFFFBU, 0xFFF8F8F8U, 0xFFFFFFFBU, 0xFFF1F1F1U, 0xFFFFFFFBU, 0xFFE3E3E3U, 0xFFFFFFFBU,
+	0xFFC7C7C7U, 0xFFFFFFFBU, 0xFF8F8F8FU, 0xFFFFFFFBU, 0xFF1F1F1FU, 0xFFFFFFFBU, 0xFF3F3F3FU, 0xFFFFFFFBU,
+	0xFCFCFCFFU, 0xFFFFFFFBU, 0xF8F8F8FFU, 0xFFFFFFFBU, 0xF1F1F1FFU, 0xFFFFFFFBU, 0xE3E3E3FFU, 0xFFFFFFFBU,
+	0xC7C7C7FFU, 0xFFFFFFFBU, 0x8F8F8FFFU, 0xFFFFFFFBU, 0x1F1F1FFFU, 0xFFFFFFFBU, 0x3F3F3FFFU, 0xFFFFFFFBU,
+	0xFCFCFFFFU, 0xFFFFFFF8U, 0xF8F8FFFFU, 0xFFFFFFF8U, 0xF1F1FFFFU, 0xFFFFFFF1U, 0xE3E3FFFFU, 0xFFFFFFE3U,
+	0xC7C7FFFFU, 0xFFFFFFC3U, 0x8F8FFFFFU, 0xFFFFFF8BU, 0x1F1FFFFFU, 0xFFFFFF1BU, 0x3F3FFFFFU, 0xFFFFFF3BU,
+	0x3C3E0000U, 0x3F3F3C38U, 0x18000000U, 0x001E1818U, 0x00000000U, 0x00000000U, 0x03000000U, 0x000F0303U,
+	0x070F0000U, 0x1F1F0703U, 0x0F0F0000U, 0x3F3F0F0BU, 0x1FFFFFFFU, 0xFFFF1F1BU, 0x3FFFFFFFU, 0xFFFF3F3BU,
+	0x3C000000U, 0x3E3C3C38U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U,
+	0x07000000U, 0x0F070703U, 0x1F0F0000U, 0x1F0F0F0BU, 0xFFFFFFFFU, 0xFF1F1F1BU, 0xFFFFFFFFU, 0xFF3F3F3BU,
+	0x3C000000U, 0x3C3C3C3BU, 0x00000000U, 0x18181818U, 0x00000000U, 0x00000000U, 0x00000000U, 0x03030303U,
+	0x07000000U, 0x0707071BU, 0x3F0F0000U, 0x0F0F0F3BU, 0xFFFFFFFFU, 0x1F1F1FFBU, 0xFFFFFFFFU, 0x3F3F3FFBU,
+	0x3C000000U, 0x3C3C3F3BU, 0x00000000U, 0x18181F1BU, 0x00000000U, 0x00111F1BU, 0x00000000U, 0x03031F1BU,
+	0x07000000U, 0x07073F3BU, 0x3F0F0000U, 0x0F0F7F7BU, 0xFFFFFFFFU, 0x1F1FFFFBU, 0xFFFFFFFFU, 0x3F3FFFFBU,
+	0xFFFFFCFCU, 0xFFFFFFF7U, 0xFFFFF8F8U, 0xFFFFFFF7U, 0xFFFFF1F1U, 0xFFFFFFF7U, 0xFFFFE3E3U, 0xFFFFFFF7U,
+	0xFFFFC7C7U, 0xFFFFFFF7U, 0xFFFF8F8FU, 0xFFFFFFF7U, 0xFFFF1F1FU, 0xFFFFFFF7U, 0xFFFF3F3FU, 0xFFFFFFF7U,
+	0xFFFCFCFCU, 0xFFFFFFF7U, 0xFFF8F8F8U, 0xFFFFFFF7U, 0xFFF1F1F1U, 0xFFFFFFF7U, 0xFFE3E3E3U, 0xFFFFFFF7U,
+	0xFFC7C7C7U, 0xFFFFFFF7U, 0xFF8F8F8FU, 0xFFFFFFF7U, 0xFF1F1F1FU, 0xFFFFFFF7U, 0xFF3F3F3FU, 0xFFFFFFF7U,
+	0xFCFCFCFFU, 0xFFFFFFF7U, 0xF8F8F8FFU, 0xFFFFFFF7U, 0xF1F1F1FFU, 0xFFFFFFF7U, 0xE3E3E3FFU, 0xFFFFFFF7U,
+	0xC7C7C7FFU, 0xFFFFFFF7U, 0x8F8F8FFFU, 0xFFFFFFF7U, 0x1F1F1FFFU, 0xFFFFFFF7U, 0x3F3F3FFFU, 0xFFFFFFF7U,
+	0x7C7C0000U, 0x7E7E7F74U, 0x38000000U, 0x003C3E30U, 0x10000000U, 0x00001C10U, 0x00000000U, 0x00001C00U,
+	0x04000000U, 0x00001C04U, 0x0E000000U, 0x001E3E06U, 0x1F1F0000U, 0x3F3F7F17U, 0x3F1F0000U, 0x7F7FFF37U,
+	0x78000000U, 0x7C7E7C74U, 0x38000000U, 0x003C3830U, 0x00000000U, 0x00001010U, 0x00000000U, 0x00000000U,
+	0x00000000U, 0x00000404U, 0x0E000000U, 0x001E0E06U, 0x0F000000U, 0x1F3F1F17U, 0x3F1F0000U, 0x3F7F3F37U,
+	0x78000000U, 0x7C7C7C74U, 0x00000000U, 0x00383830U, 0x00000000U, 0x00001000U, 0x00000000U, 0x00000000U,
+	0x00000000U, 0x00000400U, 0x00000000U, 0x000E0E06U, 0x0F000000U, 0x1F1F1F17U, 0x3F1F0000U, 0x3F3F3F37U,
+	0x78000000U, 0x7C7C7C76U, 0x00000000U, 0x38383830U, 0x00000000U, 0x00101000U, 0x00000000U, 0x00000000U,
+	0x00000000U, 0x00040400U, 0x00000000U, 0x0E0E0E06U, 0x0F000000U, 0x1F1F1F37U, 0x3F1F0000U, 0x3F3F3F77U,
+	0x78000000U, 0x7C7C7F76U, 0x00000000U, 0x38383E30U, 0x00000000U, 0x10101C00U, 0x00000000U, 0x00001C00U,
+	0x00000000U, 0x04041C00U, 0x00000000U, 0x0E0E3E06U, 0x0F000000U, 0x1F1F7F37U, 0x7F1F0000U, 0x3F3FFF77U,
+	0xFFFFFCFCU, 0xFFFFFFF7U, 0xFFFFF8F8U, 0xFFFFFFF7U, 0xFFFFF1F1U, 0xFFFFFFF7U, 0xFFFFE3E3U, 0xFFFFFFF7U,
+	0xFFFFC7C7U, 0xFFFFFFF7U, 0xFFFF8F8FU, 0xFFFFFFF7U, 0xFFFF1F1FU, 0xFFFFFFF7U, 0xFFFF3F3FU, 0xFFFFFFF7U,
+	0xFFFCFCFCU, 0xFFFFFFF7U, 0xFFF8F8F8U, 0xFFFFFFF7U, 0xFFF1F1F1U, 0xFFFFFFF7U, 0xFFE3E3E3U, 0xFFFFFFF7U,
+	0xFFC7C7C7U, 0xFFFFFFF7U, 0xFF8F8F8FU, 0xFFFFFFF7U, 0xFF1F1F1FU, 0xFFFFFFF7U, 0xFF3F3F3FU, 0xFFFFFFF7U,
+	0xFCFCFCFFU, 0xFFFFFFF7U, 0xF8F8F8FFU, 0xFFFFFFF7U, 0xF1F1F1FFU, 0xFFFFFFF7U, 0xE3E3E3FFU, 0xFFFFFFF7U,
+	0xC7C7C7FFU, 0xFFFFFFF7U, 0x8F8F8FFFU, 0xFFFFFFF7U, 0x1F1F1FFFU, 0xFFFFFFF7U, 0x3F3F3FFFU, 0xFFFFFFF7U,
+	0xFCFCFFFFU, 0xFFFFFFF4U, 0xF8F8FFFFU, 0xFFFFFFF0U, 0xF1F1FFFFU, 0xFFFFFFF1U, 0xE3E3FFFFU, 0xFFFFFFE3U,
+	0xC7C7FFFFU, 0xFFFFFFC7U, 0x8F8FFFFFU, 0xFFFFFF87U, 0x1F1FFFFFU, 0xFFFFFF17U, 0x3F3FFFFFU, 0xFFFFFF37U,
+	0xFCFC0000U, 0xFFFFFCF4U, 0x787C0000U, 0x7E7E7870U, 0x30000000U, 0x003C3030U, 0x00000000U, 0x00000000U,
+	0x06000000U, 0x001E0606U, 0x0F1F0000U, 0x3F3F0F07U, 0x1F1F0000U, 0x7F7F1F17U, 0x3FFFFFFFU, 0xFFFF3F37U,
+	0xFEFC0000U, 0xFEFCFCF4U, 0x78000000U, 0x7C787870U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U,
+	0x00000000U, 0x00000000U, 0x0F000000U, 0x1F0F0F07U, 0x3F1F0000U, 0x3F1F1F17U, 0xFFFFFFFFU, 0xFF3F3F37U,
+	0xFFFC0000U, 0xFCFCFCF7U, 0x78000000U, 0x78787876U, 0x00000000U, 0x30303030U, 0x00000000U, 0x00000000U,
+	0x00000000U, 0x06060606U, 0x0F000000U, 0x0F0F0F37U, 0x7F1F0000U, 0x1F1F1F77U, 0xFFFFFFFFU, 0x3F3F3FF7U,
+	0xFFFC0000U, 0xFCFCFFF7U, 0x78000000U, 0x78787F77U, 0x00000000U, 0x30303E36U, 0x00000000U, 0x00223E36U,
+	0x00000000U, 0x06063E36U, 0x0F000000U, 0x0F0F7F77U, 0x7F1F0000U, 0x1F1FFFF7U, 0xFFFFFFFFU, 0x3F3FFFF7U,
+	0xFEFFFCFCU, 0xFFFFFFFFU, 0xFEFFF8F8U, 0xFFFFFFFFU, 0xFEFFF1F1U, 0xFFFFFFFFU, 0xFEFFE3E3U, 0xFFFFFFFFU,
+	0xFEFFC7C7U, 0xFFFFFFFFU, 0xFEFF8F8FU, 0xFFFFFFFFU, 0xFEFF1F1FU, 0xFFFFFFFFU, 0xFEFF3F3FU, 0xFFFFFFFFU,
+	0xFEFCFCFCU, 0xFFFFFFFFU, 0xFEF8F8F8U, 0xFFFFFFFFU, 0xFEF1F1F1U, 0xFFFFFFFFU, 0xFEE3E3E3U, 0xFFFFFFFFU,
+	0xFEC7C7C7U, 0xFFFFFFFFU, 0xFE8F8F8FU, 0xFFFFFFFFU, 0xFE1F1F1FU, 0xFFFFFFFFU, 0xFE3F3F3FU, 0xFFFFFFFFU,
+	0x00000000U, 0x00000003U, 0x00000000U, 0x00000003U, 0x00000000U, 0x00000307U, 0x02020000U, 0x0007070FU,
+	0x06070000U, 0x070F0F1FU, 0x0E0F0000U, 0x0F1F1F3FU, 0x1E1F1FFFU, 0xFFFFFFFFU, 0x3E3F3FFFU, 0xFFFFFFFFU,
+	0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000200U, 0x02000000U, 0x00020602U,
+	0x06000000U, 0x07070F07U, 0x0E000000U, 0x0F0F1F0FU, 0x1E1FFFFFU, 0xFFFFFF1FU, 0x3E3FFFFFU, 0xFFFFFF3FU,
+	0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00020202U,
+	0x00000000U, 0x07070707U, 0x00000000U, 0x0F0F0F0FU, 0x1EFFFFFFU, 0xFFFF1F1FU, 0x3EFFFFFFU, 0xFFFF3F3FU,
+	0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00020200U,
+	0x00000000U, 0x07070700U, 0x00000000U, 0x0F0F0F0FU, 0xFEFFFFFFU, 0xFF1F1F1FU, 0xFEFFFFFFU, 0xFF3F3F3FU,
+	0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00020000U,
+	0x00000000U, 0x07070700U, 0x00000000U, 0x0F0F0F0FU, 0xFEFFFFFFU, 0x1F1F1FFFU, 0xFEFFFFFFU, 0x3F3F3FFFU,
+	0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x02020000U,
+	0x00000000U, 0x07070700U, 0x00000000U, 0x0F0F0F0FU, 0xFEFFFFFFU, 0x1F1FFFFFU, 0xFEFFFFFFU, 0x3F3FFFFFU,
+	0xFEFFFCFCU, 0xFFFFFFFFU, 0xFEFFF8F8U, 0xFFFFFFFFU, 0xFEFFF1F1U, 0xFFFFFFFFU, 0xFEFFE3E3U, 0xFFFFFFFFU,
+	0xFEFFC7C7U, 0xFFFFFFFFU, 0xFEFF8F8FU, 0xFFFFFFFFU, 0xFEFF1F1FU, 0xFFFFFFFFU, 0xFEFF3F3FU, 0xFFFFFFFFU,
+	0xFEFCFCFCU, 0xFFFFFFFFU, 0xFEF8F8F8U, 0xFFFFFFFFU, 0xFEF1F1F1U, 0xFFFFFFFFU, 0xFEE3E3E3U, 0xFFFFFFFFU,
+	0xFEC7C7C7U, 0xFFFFFFFFU, 0xFE8F8F8FU, 0xFFFFFFFFU, 0xFE1F1F1FU, 0xFFFFFFFFU, 0xFE3F3F3FU, 0xFFFFFFFFU,
+	0xFCFCFCFFU, 0xFFFFFFFFU, 0xF8F8F8FFU, 0xFFFFFFFFU, 0xF0F1F1FFU, 0xFFFFFFFFU, 0xE2E3E3FFU, 0xFFFFFFFFU,
+	0xC6C7C7FFU, 0xFFFFFFFFU, 0x8E8F8FFFU, 0xFFFFFFFFU, 0x1E1F1FFFU, 0xFFFFFFFFU, 0x3E3F3FFFU, 0xFFFFFFFFU,
+	0x00000000U, 0x00000000U, 0x00000000U, 0x00000300U, 0x00000000U, 0x00070701U, 0x02030000U, 0x070F0F03U,
+	0x06070000U, 0x0F1F1F07U, 0x8E8FFFFFU, 0xFFFFFF8FU, 0x1E1FFFFFU, 0xFFFFFF1FU, 0x3E3FFFFFU, 0xFFFFFF3FU,
+	0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00020000U, 0x02000000U, 0x07070303U,
+	0x06000000U, 0x0F0F0707U, 0x8EFFFFFFU, 0xFFFF8F8FU, 0x1EFFFFFFU, 0xFFFF1F1FU, 0x3EFFFFFFU, 0xFFFF3F3FU,
+	0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x07030303U,
+	0x00000000U, 0x0F070707U, 0xFEFFFFFFU, 0xFF8F8F8FU, 0xFEFFFFFFU, 0xFF1F1F1FU, 0xFEFFFFFFU, 0xFF3F3F3FU,
+	0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x03030300U,
+	0x00000000U, 0x0707070FU, 0xFEFFFFFFU, 0x8F8F8FFFU, 0xFEFFFFFFU, 0x1F1F1FFFU, 0xFEFFFFFFU, 0x3F3F3FFFU,
+	0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x03030700U,
+	0x00000000U, 0x07070F0FU, 0xFEFFFFFFU, 0x8F8FFFFFU, 0xFEFFFFFFU, 0x1F1FFFFFU, 0xFEFFFFFFU, 0x3F3FFFFFU,
+	0xFDFFFCFCU, 0xFFFFFFFFU, 0xFDFFF8F8U, 0xFFFFFFFFU, 0xFDFFF1F1U, 0xFFFFFFFFU, 0xFDFFE3E3U, 0xFFFFFFFFU,
+	0xFDFFC7C7U, 0xFFFFFFFFU, 0xFDFF8F8FU, 0xFFFFFFFFU, 0xFDFF1F1FU, 0xFFFFFFFFU, 0xFDFF3F3FU, 0xFFFFFFFFU,
+	0xFDFCFCFCU, 0xFFFFFFFFU, 0xFDF8F8F8U, 0xFFFFFFFFU, 0xFDF1F1F1U, 0xFFFFFFFFU, 0xFDE3E3E3U, 0xFFFFFFFFU,
+	0xFDC7C7C7U, 0xFFFFFFFFU, 0xFD8F8F8FU, 0xFFFFFFFFU, 0xFD1F1F1FU, 0xFFFFFFFFU, 0xFD3F3F3FU, 0xFFFFFFFFU,
+	0x04040000U, 0x00000007U, 0x00000000U, 0x00000007U, 0x01010000U, 0x00000007U, 0x01030000U, 0x0000070FU,
+	0x05070700U, 0x000F0F1FU, 0x0D0F0700U, 0x0F1F1F3FU, 0x1D1F1F0FU, 0x1F3F3F7FU, 0x3D3F3FFFU, 0xFFFFFFFFU,
+	0x04000000U, 0x00000004U, 0x00000000U, 0x00000000U, 0x01000000U, 0x00000001U, 0x01030000U, 0x00000703U,
+	0x05030000U, 0x00070F07U, 0x0D0F0700U, 0x0F0F1F0FU, 0x1D1F1F0FU, 0x1F1F3F1FU, 0x3D3FFFFFU, 0xFFFFFF3FU,
+	0x00000000U, 0x00000004U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000001U, 0x01000000U, 0x00000303U,
+	0x05030000U, 0x00070707U, 0x0D0F0700U, 0x0F0F0F0FU, 0x1D1F1F0FU, 0x1F1F1F1FU, 0x3DFFFFFFU, 0xFFFF3F3FU,
+	0x00000000U, 0x00000404U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000101U, 0x01000000U, 0x00030303U,
+	0x05030000U, 0x00070707U, 0x0D0F0700U, 0x0F0F0F0FU, 0x1D1F1F0FU, 0x1F1F1F1FU, 0xFDFFFFFFU, 0xFF3F3F3FU,
+	0x00000000U, 0x00040405U, 0x00000000U, 0x00000002U, 0x00000000U, 0x00010105U, 0x01000000U, 0x0003030BU,
+	0x05030000U, 0x07070717U, 0x0D0F0700U, 0x0F0F0F2FU, 0x1D1F1F0FU, 0x1F1F1F5FU, 0xFDFFFFFFU, 0x3F3F3FFFU,
+	0x00000000U, 0x04040704U, 0x00000000U, 0x00000700U, 0x00000000U, 0x01010701U, 0x01000000U, 0x03030F03U,
+	0x05030000U, 0x07071F07U, 0x0D0F0700U, 0x0F0F3F0FU, 0x1D1F1F0FU, 0x1F1F7F5FU, 0xFDFFFFFFU, 0x3F3FFFFFU,
+	0xFDFFFCFCU, 0xFFFFFFFFU, 0xFDFFF8F8U, 0xFFFFFFFFU, 0xFDFFF1F1U, 0xFFFFFFFFU, 0xFDFFE3E3U, 0xFFFFFFFFU,
+	0xFDFFC7C7U, 0xFFFFFFFFU, 0xFDFF8F8FU, 0xFFFFFFFFU, 0xFDFF1F1FU, 0xFFFFFFFFU, 0xFDFF3F3FU, 0xFFFFFFFFU,
+	0xFDFCFCFCU, 0xFFFFFFFFU, 0xFDF8F8F8U, 0xFFFFFFFFU, 0xFDF1F1F1U, 0xFFFFFFFFU, 0xFDE3E3E3U, 0xFFFFFFFFU,
+	0xFDC7C7C7U, 0xFFFFFFFFU, 0xFD8F8F8FU, 0xFFFFFFFFU, 0xFD1F1F1FU, 0xFFFFFFFFU, 0xFD3F3F3FU, 0xFFFFFFFFU,
+	0xFCFCFCFFU, 0xFFFFFFFFU, 0xF8F8F8FFU, 0xFFFFFFFFU, 0xF1F1F1FFU, 0xFFFFFFFFU, 0xE1E3E3FFU, 0xFFFFFFFFU,
+	0xC5C7C7FFU, 0xFFFFFFFFU, 0x8D8F8FFFU, 0xFFFFFFFFU, 0x1D1F1FFFU, 0xFFFFFFFFU, 0x3D3F3FFFU, 0xFFFFFFFFU,
+	0x0C0C0000U, 0x00000F0CU, 0x00000000U, 0x00000000U, 0x01010000U, 0x00000701U, 0x01030700U, 0x000F0F03U,
+	0x05070700U, 0x0F1F1F07U, 0x0D0F1F0FU, 0x1F3F3F0FU, 0x1D1FFFFFU, 0xFFFFFF1FU, 0x3D3FFFFFU, 0xFFFFFF3FU,
+	0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x01030000U, 0x00070303U,
+	0x050F0700U, 0x0F0F0707U, 0x0D1F1F0FU, 0x1F1F0F0FU, 0x1DFFFFFFU, 0xFFFF1F1FU, 0x3DFFFFFFU, 0xFFFF3F3FU,
+	0x0C000000U, 0x000C0C0CU, 0x00000000U, 0x00000000U, 0x01000000U, 0x00010101U, 0x05030000U, 0x07030303U,
+	0x0D0F0700U, 0x0F070707U, 0x1D1F1F0FU, 0x1F0F0F0FU, 0xFDFFFFFFU, 0xFF1F1F1FU, 0xFDFFFFFFU, 0xFF3F3F3FU,
+	0x0D000000U, 0x0C0C0C0EU, 0x05000000U, 0x00000005U, 0x0D000000U, 0x0101010BU, 0x1D030000U, 0x03030317U,
+	0x3D0F0700U, 0x0707072FU, 0x7D1F1F0FU, 0x0F0F0F5FU, 0xFDFFFFFFU, 0x1F1F1FFFU, 0xFDFFFFFFU, 0x3F3F3FFFU,
+	0x0C000000U, 0x0C0C0F0FU, 0x00000000U, 0x00080F0FU, 0x01000000U, 0x01010F0FU, 0x05030000U, 0x03031F1FU,
+	0x0D0F0700U, 0x07073F3FU, 0x1D1F1F0FU, 0x0F0F7F7FU, 0xFDFFFFFFU, 0x1F1FFFFFU, 0xFDFFFFFFU, 0x3F3FFFFFU,
+	0xFBFFFCFCU, 0xFFFFFFFFU, 0xFBFFF8F8U, 0xFFFFFFFFU, 0xFBFFF1F1U, 0xFFFFFFFFU, 0xFBFFE3E3U, 0xFFFFFFFFU,
+	0xFBFFC7C7U, 0xFFFFFFFFU, 0xFBFF8F8FU, 0xFFFFFFFFU, 0xFBFF1F1FU, 0xFFFFFFFFU, 0xFBFF3F3FU, 0xFFFFFFFFU,
+	0xFBFCFCFCU, 0xFFFFFFFFU, 0xFBF8F8F8U, 0xFFFFFFFFU, 0xFBF1F1F1U, 0xFFFFFFFFU, 0xFBE3E3E3U, 0xFFFFFFFFU,
+	0xFBC7C7C7U, 0xFFFFFFFFU, 0xFB8F8F8FU, 0xFFFFFFFFU, 0xFB1F1F1FU, 0xFFFFFFFFU, 0xFB3F3F3FU, 0xFFFFFFFFU,
+	0x181C0000U, 0x00001E1FU, 0x08080000U, 0x0000000EU, 0x00000000U, 0x0000000EU, 0x02020000U, 0x0000000EU,
+	0x03070000U, 0x00000F1FU, 0x0B0F0F00U, 0x001F1F3FU, 0x1B1F0F00U, 0x1F3F3F7FU, 0x3B3F3F1FU, 0x3F7F7FFFU,
+	0x181C0000U, 0x00001E1CU, 0x08000000U, 0x00000008U, 0x00000000U, 0x00000000U, 0x02000000U, 0x00000002U,
+	0x03070000U, 0x00000F07U, 0x0B070000U, 0x000F1F0FU, 0x1B1F0F00U, 0x1F1F3F1FU, 0x3B3F3F1FU, 0x3F3F7F3FU,
+	0x18000000U, 0x00001C1CU, 0x00000000U, 0x00000008U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000002U,
+	0x03000000U, 0x00000707U, 0x0B070000U, 0x000F0F0FU, 0x1B1F0F00U, 0x1F1F1F1FU, 0x3B3F3F1FU, 0x3F3F3F3FU,
+	0x18000000U, 0x001C1C1CU, 0x00000000U, 0x00000808U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000202U,
+	0x03000000U, 0x00070707U, 0x0B070000U, 0x000F0F0FU, 0x1B1F0F00U, 0x1F1F1F1FU, 0x3B3F3F1FU, 0x3F3F3F3FU,
+	0x18000000U, 0x001C1C1DU, 0x00000000U, 0x0008080AU, 0x00000000U, 0x00000004U, 0x00000000U, 0x0002020AU,
+	0x03000000U, 0x00070717U, 0x0B070000U, 0x0F0F0F2FU, 0x1B1F0F00U, 0x1F1F1F5FU, 0x3B3F3F1FU, 0x3F3F3FBFU,
+	0x18000000U, 0x1C1C1F1CU, 0x00000000U, 0x08080E08U, 0x00000000U, 0x00000E00U, 0x00000000U, 0x02020E02U,
+	0x03000000U, 0x07071F07U, 0x0B070000U, 0x0F0F3F0FU, 0x1B1F0F00U, 0x1F1F7F1FU, 0x3B3F3F1FU, 0x3F3FFFBFU,
+	0xFBFFFCFCU, 0xFFFFFFFFU, 0xFBFFF8F8U, 0xFFFFFFFFU, 0xFBFFF1F1U, 0xFFFFFFFFU, 0xFBFFE3E3U, 0xFFFFFFFFU,
+	0xFBFFC7C7U, 0xFFFFFFFFU, 0xFBFF8F8FU, 0xFFFFFFFFU, 0xFBFF1F1FU, 0xFFFFFFFFU, 0xFBFF3F3FU, 0xFFFFFFFFU,
+	0xFBFCFCFCU, 0xFFFFFFFFU, 0xFBF8F8F8U, 0xFFFFFFFFU, 0xFBF1F1F1U, 0xFFFFFFFFU, 0xFBE3E3E3U, 0xFFFFFFFFU,
+	0xFBC7C7C7U, 0xFFFFFFFFU, 0xFB8F8F8FU, 0xFFFFFFFFU, 0xFB1F1F1FU, 0xFFFFFFFFU, 0xFB3F3F3FU, 0xFFFFFFFFU,
+	0xF8FCFCFFU, 0xFFFFFFFFU, 0xF8F8F8FFU, 0xFFFFFFFFU, 0xF1F1F1FFU, 0xFFFFFFFFU, 0xE3E3E3FFU, 0xFFFFFFFFU,
+	0xC3C7C7FFU, 0xFFFFFFFFU, 0x8B8F8FFFU, 0xFFFFFFFFU, 0x1B1F1FFFU, 0xFFFFFFFFU, 0x3B3F3FFFU, 0xFFFFFFFFU,
+	0x383C3E00U, 0x003F3F3CU, 0x18180000U, 0x00001E18U, 0x00000000U, 0x00000000U, 0x03030000U, 0x00000F03U,
+	0x03070F00U, 0x001F1F07U, 0x0B0F0F00U, 0x1F3F3F0FU, 0x1B1F3F1FU, 0x3F7F7F1FU, 0x3B3FFFFFU, 0xFFFFFF3FU,
+	0x383C0000U, 0x003E3C3CU, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U,
+	0x03070000U, 0x000F0707U, 0x0B1F0F00U, 0x1F1F0F0FU, 0x1B3F3F1FU, 0x3F3F1F1FU, 0x3BFFFFFFU, 0xFFFF3F3FU,
+	0x3A3C0000U, 0x3E3C3C3CU, 0x18000000U, 0x00181818U, 0x00000000U, 0x00000000U, 0x03000000U, 0x00030303U,
+	0x0B070000U, 0x0F070707U, 0x1B1F0F00U, 0x1F0F0F0FU, 0x3B3F3F1FU, 0x3F1F1F1FU, 0xFBFFFFFFU, 0xFF3F3F3FU,
+	0x3B3C0000U, 0x3C3C3C3EU, 0x1B000000U, 0x1818181DU, 0x0A000000U, 0x0000000AU, 0x1B000000U, 0x03030317U,
+	0x3B070000U, 0x0707072FU, 0x7B1F0F00U, 0x0F0F0F5FU, 0xFB3F3F1FU, 0x1F1F1FBFU, 0xFBFFFFFFU, 0x3F3F3FFFU,
+	0x3A3C0000U, 0x3C3C3F3FU, 0x18000000U, 0x18181F1FU, 0x00000000U, 0x00111F1FU, 0x03000000U, 0x03031F1FU,
+	0x0B070000U, 0x07073F3FU, 0x1B1F0F00U, 0x0F0F7F7FU, 0x3B3F3F1FU, 0x1F1FFFFFU, 0xFBFFFFFFU, 0x3F3FFFFFU,
+	0xF7FFFCFCU, 0xFFFFFFFFU, 0xF7FFF8F8U, 0xFFFFFFFFU, 0xF7FFF1F1U, 0xFFFFFFFFU, 0xF7FFE3E3U, 0xFFFFFFFFU,
+	0xF7FFC7C7U, 0xFFFFFFFFU, 0xF7FF8F8FU, 0xFFFFFFFFU, 0xF7FF1F1FU, 0xFFFFFFFFU, 0xF7FF3F3FU, 0xFFFFFFFFU,
+	0xF7FCFCFCU, 0xFFFFFFFFU, 0xF7F8F8F8U, 0xFFFFFFFFU, 0xF7F1F1F1U, 0xFFFFFFFFU, 0xF7E3E3E3U, 0xFFFFFFFFU,
+	0xF7C7C7C7U, 0xFFFFFFFFU, 0xF78F8F8FU, 0xFFFFFFFFU, 0xF71F1F1FU, 0xFFFFFFFFU, 0xF73F3F3FU, 0xFFFFFFFFU,
+	0x747C7C00U, 0x007E7E7FU, 0x30380000U, 0x00003C3EU, 0x10100000U, 0x0000001CU, 0x00000000U, 0x0000001CU,
+	0x04040000U, 0x0000001CU, 0x060E0000U, 0x00001E3EU, 0x171F1F00U, 0x003F3F7FU, 0x373F1F00U, 0x3F7F7FFFU,
+	0x74780000U, 0x007C7E7CU, 0x30380000U, 0x00003C38U, 0x10000000U, 0x00000010U, 0x00000000U, 0x00000000U,
+	0x04000000U, 0x00000004U, 0x060E0000U, 0x00001E0EU, 0x170F0000U, 0x001F3F1FU, 0x373F1F00U, 0x3F3F7F3FU,
+	0x74780000U, 0x007C7C7CU, 0x30000000U, 0x00003838U, 0x00000000U, 0x00000010U, 0x00000000U, 0x00000000U,
+	0x00000000U, 0x00000004U, 0x06000000U, 0x00000E0EU, 0x170F0000U, 0x001F1F1FU, 0x373F1F00U, 0x3F3F3F3FU,
+	0x74780000U, 0x007C7C7CU, 0x30000000U, 0x00383838U, 0x00000000U, 0x00001010U, 0x00000000U, 0x00000000U,
+	0x00000000U, 0x00000404U, 0x06000000U, 0x000E0E0EU, 0x170F0000U, 0x001F1F1FU, 0x373F1F00U, 0x3F3F3F3FU,
+	0x74780000U, 0x7C7C7C7DU, 0x30000000U, 0x0038383AU, 0x00000000U, 0x00101014U, 0x00000000U, 0x00000008U,
+	0x00000000U, 0x00040414U, 0x06000000U, 0x000E0E2EU, 0x170F0000U, 0x1F1F1F5FU, 0x373F1F00U, 0x3F3F3FBFU,
+	0x74780000U, 0x7C7C7F7CU, 0x30000000U, 0x38383E38U, 0x00000000U, 0x10101C10U, 0x00000000U, 0x00001C00U,
+	0x00000000U, 0x04041C04U, 0x06000000U, 0x0E0E3E0EU, 0x170F0000U, 0x1F1F7F1FU, 0x373F1F00U, 0x3F3FFF3FU,
+	0xF7FFFCFCU, 0xFFFFFFFFU, 0xF7FFF8F8U, 0xFFFFFFFFU, 0xF7FFF1F1U, 0xFFFFFFFFU, 0xF7FFE3E3U, 0xFFFFFFFFU,
+	0xF7FFC7C7U, 0xFFFFFFFFU, 0xF7FF8F8FU, 0xFFFFFFFFU, 0xF7FF1F1FU, 0xFFFFFFFFU, 0xF7FF3F3FU, 0xFFFFFFFFU,
+	0xF7FCFCFCU, 0xFFFFFFFFU, 0xF7F8F8F8U, 0xFFFFFFFFU, 0xF7F1F1F1U, 0xFFFFFFFFU, 0xF7E3E3E3U, 0xFFFFFFFFU,
+	0xF7C7C7C7U, 0xFFFFFFFFU, 0xF78F8F8FU, 0xFFFFFFFFU, 0xF71F1F1FU, 0xFFFFFFFFU, 0xF73F3F3FU, 0xFFFFFFFFU,
+	0xF4FCFCFFU, 0xFFFFFFFFU, 0xF0F8F8FFU, 0xFFFFFFFFU, 0xF1F1F1FFU, 0xFFFFFFFFU, 0xE3E3E3FFU, 0xFFFFFFFFU,
+	0xC7C7C7FFU, 0xFFFFFFFFU, 0x878F8FFFU, 0xFFFFFFFFU, 0x171F1FFFU, 0xFFFFFFFFU, 0x373F3FFFU, 0xFFFFFFFFU,
+	0xF4FCFC00U, 0xFEFFFFFCU, 0x70787C00U, 0x007E7E78U, 0x30300000U, 0x00003C30U, 0x00000000U, 0x00000000U,
+	0x06060000U, 0x00001E06U, 0x070F1F00U, 0x003F3F0FU, 0x171F1F00U, 0x3F7F7F1FU, 0x373F7F3FU, 0x7FFFFF3FU,
+	0xF4FEFC00U, 0xFEFEFCFCU, 0x70780000U, 0x007C7878U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U,
+	0x00000000U, 0x00000000U, 0x070F0000U, 0x001F0F0FU, 0x173F1F00U, 0x3F3F1F1FU, 0x377F7F3FU, 0x7F7F3F3FU,
+	0xF6FEFC00U, 0xFEFCFCFCU, 0x74780000U, 0x7C787878U, 0x30000000U, 0x00303030U, 0x00000000U, 0x00000000U,
+	0x06000000U, 0x00060606U, 0x170F0000U, 0x1F0F0F0FU, 0x373F1F00U, 0x3F1F1F1FU, 0x777F7F3FU, 0x7F3F3F3FU,
+	0xF7FEFC00U, 0xFCFCFCFEU, 0x77780000U, 0x7878787DU, 0x36000000U, 0x3030303AU, 0x14000000U, 0x00000014U,
+	0x36000000U, 0x0606062EU, 0x770F0000U, 0x0F0F0F5FU, 0xF73F1F00U, 0x1F1F1FBFU, 0xF77F7F3FU, 0x3F3F3F7FU,
+	0xF6FEFC00U, 0xFCFCFFFFU, 0x74780000U, 0x78787F7FU, 0x30000000U, 0x30303E3EU, 0x00000000U, 0x00223E3EU,
+	0x06000000U, 0x06063E3EU, 0x170F0000U, 0x0F0F7F7FU, 0x373F1F00U, 0x1F1FFFFFU, 0x777F7F3FU, 0x3F3FFFFFU,
+	0xFFFEFCFCU, 0xFFFFFFFFU, 0xFFFEF8F8U, 0xFFFFFFFFU, 0xFFFEF1F1U, 0xFFFFFFFFU, 0xFFFEE3E3U, 0xFFFFFFFFU,
+	0xFFFEC7C7U, 0xFFFFFFFFU, 0xFFFE8F8FU, 0xFFFFFFFFU, 0xFFFE1F1FU, 0xFFFFFFFFU, 0xFFFE3F3FU, 0xFFFFFFFFU,
+	0x03000000U, 0x00000000U, 0x03000000U, 0x00000000U, 0x07000000U, 0x00000003U, 0x0F020200U, 0x00000707U,
+	0x1F060700U, 0x00070F0FU, 0x3F0E0F00U, 0x0F0F1F1FU, 0x7F1E1F00U, 0x1F1F3F3FU, 0xFF3E3F3FU, 0xFFFFFFFFU,
+	0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000002U, 0x02020000U, 0x00000206U,
+	0x07060000U, 0x0007070FU, 0x0F0E0000U, 0x0F0F0F1FU, 0x1F1E0000U, 0x1F1F1F3FU, 0x3F3E3FFFU, 0xFFFFFFFFU,
+	0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x02000000U, 0x00000202U,
+	0x07000000U, 0x00070707U, 0x0F000000U, 0x0F0F0F0FU, 0x1F000000U, 0x1F1F1F1FU, 0x3F3EFFFFU, 0xFFFFFF3FU,
+	0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000202U,
+	0x00000000U, 0x00070707U, 0x00000000U, 0x0F0F0F0FU, 0x1F000000U, 0x1F1F1F1FU, 0x3FFEFFFFU, 0xFFFF3F3FU,
+	0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000200U,
+	0x00000000U, 0x00070700U, 0x00000000U, 0x0F0F0F0FU, 0x1F000000U, 0x1F1F1F1FU, 0xFFFEFFFFU, 0xFF3F3F3FU,
+	0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00020000U,
+	0x00000000U, 0x00070700U, 0x00000000U, 0x0F0F0F0FU, 0x1F000000U, 0x1F1F1F1FU, 0xFFFEFFFFU, 0x3F3F3FFFU,
+	0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x02020000U,
+	0x00000000U, 0x07070700U, 0x00000000U, 0x0F0F0F0FU, 0x1F000000U, 0x1F1F1F1FU, 0xFFFEFFFFU, 0x3F3FFFFFU,
+	0xFFFEFCFCU, 0xFFFFFFFFU, 0xFFFEF8F8U, 0xFFFFFFFFU, 0xFFFEF1F1U, 0xFFFFFFFFU, 0xFFFEE3E3U, 0xFFFFFFFFU,
+	0xFFFEC7C7U, 0xFFFFFFFFU, 0xFFFE8F8FU, 0xFFFFFFFFU, 0xFFFE1F1FU, 0xFFFFFFFFU, 0xFFFE3F3FU, 0xFFFFFFFFU,
+	0xFFFCFCFCU, 0xFFFFFFFFU, 0xFFF8F8F8U, 0xFFFFFFFFU, 0xFFF0F1F1U, 0xFFFFFFFFU, 0xFFE2E3E3U, 0xFFFFFFFFU,
+	0xFFC6C7C7U, 0xFFFFFFFFU, 0xFF8E8F8FU, 0xFFFFFFFFU, 0xFF1E1F1FU, 0xFFFFFFFFU, 0xFF3E3F3FU, 0xFFFFFFFFU,
+	0x00000000U, 0x00000000U, 0x00000000U, 0x00000003U, 0x01000000U, 0x00000707U, 0x03020300U, 0x00070F0FU,
+	0x07060700U, 0x0F0F1F1FU, 0x0F0E0F00U, 0x1F1F3F3FU, 0x1F1E1FFFU, 0xFFFFFFFFU, 0x3F3E3FFFU, 0xFFFFFFFFU,
+	0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000200U, 0x03020000U, 0x00070703U,
+	0x07060000U, 0x0F0F0F07U, 0x0F0E0000U, 0x1F1F1F0FU, 0x1F1EFFFFU, 0xFFFFFF1FU, 0x3F3EFFFFU, 0xFFFFFF3FU,
+	0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x03000000U, 0x00070303U,
+	0x07000000U, 0x0F0F0707U, 0x0F000000U, 0x1F1F0F0FU, 0x1FFEFFFFU, 0xFFFF1F1FU, 0x3FFEFFFFU, 0xFFFF3F3FU,
+	0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00030303U,
+	0x00000000U, 0x0F070707U, 0x1F000000U, 0x1F0F0F0FU, 0xFFFEFFFFU, 0xFF1F1F1FU, 0xFFFEFFFFU, 0xFF3F3F3FU,
+	0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x03030300U,
+	0x00000000U, 0x0707070FU, 0x1F000000U, 0x0F0F0F1FU, 0xFFFEFFFFU, 0x1F1F1FFFU, 0xFFFEFFFFU, 0x3F3F3FFFU,
+	0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x03030700U,
+	0x00000000U, 0x07070F0FU, 0x1F000000U, 0x0F0F1F1FU, 0xFFFEFFFFU, 0x1F1FFFFFU, 0xFFFEFFFFU, 0x3F3FFFFFU,
+	0xFFFDFCFCU, 0xFFFFFFFFU, 0xFFFDF8F8U, 0xFFFFFFFFU, 0xFFFDF1F1U, 0xFFFFFFFFU, 0xFFFDE3E3U, 0xFFFFFFFFU,
+	0xFFFDC7C7U, 0xFFFFFFFFU, 0xFFFD8F8FU, 0xFFFFFFFFU, 0xFFFD1F1FU, 0xFFFFFFFFU, 0xFFFD3F3FU, 0xFFFFFFFFU,
+	0x07040400U, 0x00000000U, 0x07000000U, 0x00000000U, 0x07010100U, 0x00000000U, 0x0F010300U, 0x00000007U,
+	0x1F050707U, 0x00000F0FU, 0x3F0D0F07U, 0x000F1F1FU, 0x7F1D1F1FU, 0x1F1F3F3FU, 0xFF3D3F3FU, 0x3F3F7F7FU,
+	0x04040000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x01010000U, 0x00000000U, 0x03010300U, 0x00000007U,
+	0x07050300U, 0x0000070FU, 0x0F0D0F07U, 0x000F0F1FU, 0x1F1D1F1FU, 0x1F1F1F3FU, 0x3F3D3F3FU, 0x3F3F3F7FU,
+	0x04000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x01000000U, 0x00000000U, 0x03010000U, 0x00000003U,
+	0x07050300U, 0x00000707U, 0x0F0D0F07U, 0x000F0F0FU, 0x1F1D1F1FU, 0x1F1F1F1FU, 0x3F3D3F3FU, 0x3F3F3F3FU,
+	0x04000000U, 0x00000004U, 0x00000000U, 0x00000000U, 0x01000000U, 0x00000001U, 0x03010000U, 0x00000303U,
+	0x07050300U, 0x00000707U, 0x0F0D0F07U, 0x000F0F0FU, 0x1F1D1F1FU, 0x1F1F1F1FU, 0x3F3D3F3FU, 0x3F3F3F3FU,
+	0x05000000U, 0x00000404U, 0x02000000U, 0x00000000U, 0x05000000U, 0x00000101U, 0x0B010000U, 0x00000303U,
+	0x17050300U, 0x00070707U, 0x2F0D0F07U, 0x000F0F0FU, 0x5F1D1F1FU, 0x1F1F1F1FU, 0xBF3D3F3FU, 0x3F3F3F3FU,
+	0x04000000U, 0x00040407U, 0x00000000U, 0x00000007U, 0x01000000U, 0x00010107U, 0x03010000U, 0x0003030FU,
+	0x07050300U, 0x0007071FU, 0x0F0D0F07U, 0x0F0F0F3FU, 0x1F1D1F1FU, 0x1F1F1F7FU, 0xBF3D3F3FU, 0x3F3F3FFFU,
+	0x0F000000U, 0x04040F0FU, 0x0F000000U, 0x00000F0FU, 0x0F000000U, 0x01010F0FU, 0x0F010000U, 0x03030F0FU,
+	0x1F050300U, 0x07071F1FU, 0x3F0D0F07U, 0x0F0F3F3FU, 0x7F1D1F1FU, 0x1F1F7F7FU, 0xFF3D3F3FU, 0x3F3FFFFFU,
+	0xFFFDFCFCU, 0xFFFFFFFFU, 0xFFFDF8F8U, 0xFFFFFFFFU, 0xFFFDF1F1U, 0xFFFFFFFFU, 0xFFFDE3E3U, 0xFFFFFFFFU,
+	0xFFFDC7C7U, 0xFFFFFFFFU, 0xFFFD8F8FU, 0xFFFFFFFFU, 0xFFFD1F1FU, 0xFFFFFFFFU, 0xFFFD3F3FU, 0xFFFFFFFFU,
+	0xFFFCFCFCU, 0xFFFFFFFFU, 0xFFF8F8F8U, 0xFFFFFFFFU, 0xFFF1F1F1U, 0xFFFFFFFFU, 0xFFE1E3E3U, 0xFFFFFFFFU,
+	0xFFC5C7C7U, 0xFFFFFFFFU, 0xFF8D8F8FU, 0xFFFFFFFFU, 0xFF1D1F1FU, 0xFFFFFFFFU, 0xFF3D3F3FU, 0xFFFFFFFFU,
+	0x0C0C0C00U, 0x0000000FU, 0x00000000U, 0x00000000U, 0x01010100U, 0x00000007U, 0x03010307U, 0x00000F0FU,
+	0x07050707U, 0x000F1F1FU, 0x0F0D0F1FU, 0x1F1F3F3FU, 0x1F1D1F3FU, 0x3F3F7F7FU, 0x3F3D3FFFU, 0xFFFFFFFFU,
+	0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x03010300U, 0x00000703U,
+	0x07050F07U, 0x000F0F07U, 0x0F0D1F1FU, 0x1F1F1F0FU, 0x1F1D3F3FU, 0x3F3F3F1FU, 0x3F3DFFFFU, 0xFFFFFF3FU,
+	0x0C0C0000U, 0x00000C0CU, 0x00000000U, 0x00000000U, 0x01010000U, 0x00000101U, 0x03050300U, 0x00070303U,
+	0x070D0F07U, 0x000F0707U, 0x0F1D1F1FU, 0x1F1F0F0FU, 0x1F3D3F3FU, 0x3F3F1F1FU, 0x3FFDFFFFU, 0xFFFF3F3FU,
+	0x0E0D0000U, 0x000C0C0CU, 0x05050000U, 0x00000000U, 0x0B0D0000U, 0x00010101U, 0x171D0300U, 0x00030303U,
+	0x2F3D0F07U, 0x0F070707U, 0x5F7D1F1FU, 0x1F0F0F0FU, 0xBFFD3F3FU, 0x3F1F1F1FU, 0xFFFDFFFFU, 0xFF3F3F3FU,
+	0x0F0C0000U, 0x0C0C0C0FU, 0x0F000000U, 0x0000080FU, 0x0F010000U, 0x0101010FU, 0x1F050300U, 0x0303031FU,
+	0x3F0D0F07U, 0x0707073FU, 0x7F1D1F1FU, 0x0F0F0F7FU, 0xFF3D3F3FU, 0x1F1F1FFFU, 0xFFFDFFFFU, 0x3F3F3FFFU,
+	0x1F1D0000U, 0x0C1C1F1FU, 0x1F1D0000U, 0x00181F1FU, 0x1F1D0000U, 0x01111F1FU, 0x1F1D0300U, 0x03031F1FU,
+	0x3F3D0F07U, 0x07073F3FU, 0x7F7D1F1FU, 0x0F0F7F7FU, 0xFFFD3F3FU, 0x1F1FFFFFU, 0xFFFDFFFFU, 0x3F3FFFFFU,
+	0xFFFBFCFCU, 0xFFFFFFFFU, 0xFFFBF8F8U, 0xFFFFFFFFU, 0xFFFBF1F1U, 0xFFFFFFFFU, 0xFFFBE3E3U, 0xFFFFFFFFU,
+	0xFFFBC7C7U, 0xFFFFFFFFU, 0xFFFB8F8FU, 0xFFFFFFFFU, 0xFFFB1F1FU, 0xFFFFFFFFU, 0xFFFB3F3FU, 0xFFFFFFFFU,
+	0x1F181C00U, 0x0000001EU, 0x0E080800U, 0x00000000U, 0x0E000000U, 0x00000000U, 0x0E020200U, 0x00000000U,
+	0x1F030700U, 0x0000000FU, 0x3F0B0F0FU, 0x00001F1FU, 0x7F1B1F0FU, 0x001F3F3FU, 0xFF3B3F3FU, 0x3F3F7F7FU,
+	0x1C181C00U, 0x0000001EU, 0x08080000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x02020000U, 0x00000000U,
+	0x07030700U, 0x0000000FU, 0x0F0B0700U, 0x00000F1FU, 0x1F1B1F0FU, 0x001F1F3FU, 0x3F3B3F3FU, 0x3F3F3F7FU,
+	0x1C180000U, 0x0000001CU, 0x08000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x02000000U, 0x00000000U,
+	0x07030000U, 0x00000007U, 0x0F0B0700U, 0x00000F0FU, 0x1F1B1F0FU, 0x001F1F1FU, 0x3F3B3F3FU, 0x3F3F3F3FU,
+	0x1C180000U, 0x00001C1CU, 0x08000000U, 0x00000008U, 0x00000000U, 0x00000000U, 0x02000000U, 0x00000002U,
+	0x07030000U, 0x00000707U, 0x0F0B0700U, 0x00000F0FU, 0x1F1B1F0FU, 0x001F1F1FU, 0x3F3B3F3FU, 0x3F3F3F3FU,
+	0x1D180000U, 0x00001C1CU, 0x0A000000U, 0x00000808U, 0x04000000U, 0x00000000U, 0x0A000000U, 0x00000202U,
+	0x17030000U, 0x00000707U, 0x2F0B0700U, 0x000F0F0FU, 0x5F1B1F0FU, 0x001F1F1FU, 0xBF3B3F3FU, 0x3F3F3F3FU,
+	0x1C180000U, 0x001C1C1FU, 0x08000000U, 0x0008080EU, 0x00000000U, 0x0000000EU, 0x02000000U, 0x0002020EU,
+	0x07030000U, 0x0007071FU, 0x0F0B0700U, 0x000F0F3FU, 0x1F1B1F0FU, 0x1F1F1F7FU, 0x3F3B3F3FU, 0x3F3F3FFFU,
+	0x1F180000U, 0x1C1C1F1FU, 0x1F000000U, 0x08081F1FU, 0x1F000000U, 0x00001F1FU, 0x1F000000U, 0x02021F1FU,
+	0x1F030000U, 0x07071F1FU, 0x3F0B0700U, 0x0F0F3F3FU, 0x7F1B1F0FU, 0x1F1F7F7FU, 0xFF3B3F3FU, 0x3F3FFFFFU,
+	0xFFFBFCFCU, 0xFFFFFFFFU, 0xFFFBF8F8U, 0xFFFFFFFFU, 0xFFFBF1F1U, 0xFFFFFFFFU, 0xFFFBE3E3U, 0xFFFFFFFFU,
+	0xFFFBC7C7U, 0xFFFFFFFFU, 0xFFFB8F8FU, 0xFFFFFFFFU, 0xFFFB1F1FU, 0xFFFFFFFFU, 0xFFFB3F3FU, 0xFFFFFFFFU,
+	0xFFF8FCFCU, 0xFFFFFFFFU, 0xFFF8F8F8U, 0xFFFFFFFFU, 0xFFF1F1F1U, 0xFFFFFFFFU, 0xFFE3E3E3U, 0xFFFFFFFFU,
+	0xFFC3C7C7U, 0xFFFFFFFFU, 0xFF8B8F8FU, 0xFFFFFFFFU, 0xFF1B1F1FU, 0xFFFFFFFFU, 0xFF3B3F3FU, 0xFFFFFFFFU,
+	0x3C383C3EU, 0x00003F3FU, 0x18181800U, 0x0000001EU, 0x00000000U, 0x00000000U, 0x03030300U, 0x0000000FU,
+	0x0703070FU, 0x00001F1FU, 0x0F0B0F0FU, 0x001F3F3FU, 0x1F1B1F3FU, 0x3F3F7F7FU, 0x3F3B3F7FU, 0x7F7FFFFFU,
+	0x3C383C00U, 0x00003E3CU, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U,
+	0x07030700U, 0x00000F07U, 0x0F0B1F0FU, 0x001F1F0FU, 0x1F1B3F3FU, 0x3F3F3F1FU, 0x3F3B7F7FU, 0x7F7F7F3FU,
+	0x3C3A3C00U, 0x003E3C3CU, 0x18180000U, 0x00001818U, 0x00000000U, 0x00000000U, 0x03030000U, 0x00000303U,
+	0x070B0700U, 0x000F0707U, 0x0F1B1F0FU, 0x001F0F0FU, 0x1F3B3F3FU, 0x3F3F1F1FU, 0x3F7B7F7FU, 0x7F7F3F3FU,
+	0x3E3B3C00U, 0x003C3C3CU, 0x1D1B0000U, 0x00181818U, 0x0A0A0000U, 0x00000000U, 0x171B0000U, 0x00030303U,
+	0x2F3B0700U, 0x00070707U, 0x5F7B1F0FU, 0x1F0F0F0FU, 0xBFFB3F3FU, 0x3F1F1F1FU, 0x7FFB7F7FU, 0x7F3F3F3FU,
+	0x3F3A3C00U, 0x3C3C3C3FU, 0x1F180000U, 0x1818181FU, 0x1F000000U, 0x0000111FU, 0x1F030000U, 0x0303031FU,
+	0x3F0B0700U, 0x0707073FU, 0x7F1B1F0FU, 0x0F0F0F7FU, 0xFF3B3F3FU, 0x1F1F1FFFU, 0xFF7B7F7FU, 0x3F3F3FFFU,
+	0x3F3B3C00U, 0x3C3C3F3FU, 0x3F3B0000U, 0x18383F3FU, 0x3F3B0000U, 0x00313F3FU, 0x3F3B0000U, 0x03233F3FU,
+	0x3F3B0700U, 0x07073F3FU, 0x7F7B1F0FU, 0x0F0F7F7FU, 0xFFFB3F3FU, 0x1F1FFFFFU, 0xFFFB7F7FU, 0x3F3FFFFFU,
+	0xFFF7FCFCU, 0xFFFFFFFFU, 0xFFF7F8F8U, 0xFFFFFFFFU, 0xFFF7F1F1U, 0xFFFFFFFFU, 0xFFF7E3E3U, 0xFFFFFFFFU,
+	0xFFF7C7C7U, 0xFFFFFFFFU, 0xFFF78F8FU, 0xFFFFFFFFU, 0xFFF71F1FU, 0xFFFFFFFFU, 0xFFF73F3FU, 0xFFFFFFFFU,
+	0x7F747C7CU, 0x00007E7EU, 0x3E303800U, 0x0000003CU, 0x1C101000U, 0x00000000U, 0x1C000000U, 0x00000000U,
+	0x1C040400U, 0x00000000U, 0x3E060E00U, 0x0000001EU, 0x7F171F1FU, 0x00003F3FU, 0xFF373F1FU, 0x003F7F7FU,
+	0x7C747800U, 0x00007C7EU, 0x38303800U, 0x0000003CU, 0x10100000U, 0x00000000U, 0x00000000U, 0x00000000U,
+	0x04040000U, 0x00000000U, 0x0E060E00U, 0x0000001EU, 0x1F170F00U, 0x00001F3FU, 0x3F373F1FU, 0x003F3F7FU,
+	0x7C747800U, 0x00007C7CU, 0x38300000U, 0x00000038U, 0x10000000U, 0x00000000U, 0x00000000U, 0x00000000U,
+	0x04000000U, 0x00000000U, 0x0E060000U, 0x0000000EU, 0x1F170F00U, 0x00001F1FU, 0x3F373F1FU, 0x003F3F3FU,
+	0x7C747800U, 0x00007C7CU, 0x38300000U, 0x00003838U, 0x10000000U, 0x00000010U, 0x00000000U, 0x00000000U,
+	0x04000000U, 0x00000004U, 0x0E060000U, 0x00000E0EU, 0x1F170F00U, 0x00001F1FU, 0x3F373F1FU, 0x003F3F3FU,
+	0x7D747800U, 0x007C7C7CU, 0x3A300000U, 0x00003838U, 0x14000000U, 0x00001010U, 0x08000000U, 0x00000000U,
+	0x14000000U, 0x00000404U, 0x2E060000U, 0x00000E0EU, 0x5F170F00U, 0x001F1F1FU, 0xBF373F1FU, 0x003F3F3FU,
+	0x7C747800U, 0x007C7C7FU, 0x38300000U, 0x0038383EU, 0x10000000U, 0x0010101CU, 0x00000000U, 0x0000001CU,
+	0x04000000U, 0x0004041CU, 0x0E060000U, 0x000E0E3EU, 0x1F170F00U, 0x001F1F7FU, 0x3F373F1FU, 0x3F3F3FFFU,
+	0x7F747800U, 0x7C7C7F7FU, 0x3E300000U, 0x38383E3EU, 0x3E000000U, 0x10103E3EU, 0x3E000000U, 0x00003E3EU,
+	0x3E000000U, 0x04043E3EU, 0x3E060000U, 0x0E0E3E3EU, 0x7F170F00U, 0x1F1F7F7FU, 0xFF373F1FU, 0x3F3FFFFFU,
+	0xFFF7FCFCU, 0xFFFFFFFFU, 0xFFF7F8F8U, 0xFFFFFFFFU, 0xFFF7F1F1U, 0xFFFFFFFFU, 0xFFF7E3E3U, 0xFFFFFFFFU,
+	0xFFF7C7C7U, 0xFFFFFFFFU, 0xFFF78F8FU, 0xFFFFFFFFU, 0xFFF71F1FU, 0xFFFFFFFFU, 0xFFF73F3FU, 0xFFFFFFFFU,
+	0xFFF4FCFCU, 0xFFFFFFFFU, 0xFFF0F8F8U, 0xFFFFFFFFU, 0xFFF1F1F1U, 0xFFFFFFFFU, 0xFFE3E3E3U, 0xFFFFFFFFU,
+	0xFFC7C7C7U, 0xFFFFFFFFU, 0xFF878F8FU, 0xFFFFFFFFU, 0xFF171F1FU, 0xFFFFFFFFU, 0xFF373F3FU, 0xFFFFFFFFU,
+	0xFCF4FCFCU, 0x00FEFFFFU, 0x7870787CU, 0x00007E7EU, 0x30303000U, 0x0000003CU, 0x00000000U, 0x00000000U,
+	0x06060600U, 0x0000001EU, 0x0F070F1FU, 0x00003F3FU, 0x1F171F1FU, 0x003F7F7FU, 0x3F373F7FU, 0x7F7FFFFFU,
+	0xFCF4FEFCU, 0x00FEFEFCU, 0x78707800U, 0x00007C78U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U,
+	0x00000000U, 0x00000000U, 0x0F070F00U, 0x00001F0FU, 0x1F173F1FU, 0x003F3F1FU, 0x3F377F7FU, 0x7F7F7F3FU,
+	0xFCF6FEFCU, 0x00FEFCFCU, 0x78747800U, 0x007C7878U, 0x30300000U, 0x00003030U, 0x00000000U, 0x00000000U,
+	0x06060000U, 0x00000606U, 0x0F170F00U, 0x001F0F0FU, 0x1F373F1FU, 0x003F1F1FU, 0x3F777F7FU, 0x7F7F3F3FU,
+	0xFEF7FEFCU, 0xFEFCFCFCU, 0x7D777800U, 0x00787878U, 0x3A360000U, 0x00303030U, 0x14140000U, 0x00000000U,
+	0x2E360000U, 0x00060606U, 0x5F770F00U, 0x000F0F0FU, 0xBFF73F1FU, 0x3F1F1F1FU, 0x7FF77F7FU, 0x7F3F3F3FU,
+	0xFFF6FEFCU, 0xFCFCFCFFU, 0x7F747800U, 0x7878787FU, 0x3E300000U, 0x3030303EU, 0x3E000000U, 0x0000223EU,
+	0x3E060000U, 0x0606063EU, 0x7F170F00U, 0x0F0F0F7FU, 0xFF373F1FU, 0x1F1F1FFFU, 0xFF777F7FU, 0x3F3F3FFFU,
+	0xFFF7FEFCU, 0xFCFCFFFFU, 0x7F777800U, 0x78787F7FU, 0x7F770000U, 0x30717F7FU, 0x7F770000U, 0x00637F7FU,
+	0x7F770000U, 0x06477F7FU, 0x7F770F00U, 0x0F0F7F7FU, 0xFFF73F1FU, 0x1F1FFFFFU, 0xFFF77F7FU, 0x3F3FFFFFU,
+	0x00030000U, 0x00000000U, 0x00030000U, 0x00000000U, 0xFFFFF0F1U, 0xFFFFFFFFU, 0xFFFFE2E3U, 0xFFFFFFFFU,
+	0xFFFFC6C7U, 0xFFFFFFFFU, 0xFFFF8E8FU, 0xFFFFFFFFU, 0xFFFF1E1FU, 0xFFFFFFFFU, 0xFFFF3E3FU, 0xFFFFFFFFU,
+	0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x0F000000U, 0x00000F0FU, 0x0F020200U, 0x00000F0FU,
+	0x1F070600U, 0x00071F1FU, 0x3F0F0E00U, 0x0F0F3F3FU, 0x7F1F1E00U, 0x1F1F7F7FU, 0xFF3F3E3FU, 0xFFFFFFFFU,
+	0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000006U, 0x02020000U, 0x0000020EU,
+	0x07070000U, 0x0007071FU, 0x0F0F0000U, 0x0F0F0F3FU, 0x1F1F0000U, 0x1F1F1F7FU, 0x3F3F3EFFU, 0xFFFFFFFFU,
+	0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x02000000U, 0x00000202U,
+	0x07000000U, 0x00070707U, 0x0F000000U, 0x0F0F0F0FU, 0x1F000000U, 0x1F1F1F1FU, 0x3F3FFEFFU, 0xFFFFFF3FU,
+	0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000202U,
+	0x00000000U, 0x00070707U, 0x00000000U, 0x0F0F0F0FU, 0x1F000000U, 0x1F1F1F1FU, 0x3FFFFEFFU, 0xFFFF3F3FU,
+	0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000200U,
+	0x00000000U, 0x00070700U, 0x00000000U, 0x0F0F0F0FU, 0x1F000000U, 0x1F1F1F1FU, 0xFFFFFEFFU, 0xFF3F3F3FU,
+	0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00020000U,
+	0x00000000U, 0x00070700U, 0x00000000U, 0x0F0F0F0FU, 0x1F000000U, 0x1F1F1F1FU, 0xFFFFFEFFU, 0x3F3F3FFFU,
+	0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x02020000U,
+	0x00000000U, 0x07070700U, 0x00000000U, 0x0F0F0F0FU, 0x1F000000U, 0x1F1F1F1FU, 0xFFFFFEFFU, 0x3F3FFFFFU,
+	0xFFFFFCFCU, 0xFFFFFFFFU, 0xFFFFF8F8U, 0xFFFFFFFFU, 0xFFFFF0F1U, 0xFFFFFFFFU, 0xFFFFE2E3U, 0xFFFFFFFFU,
+	0xFFFFC6C7U, 0xFFFFFFFFU, 0xFFFF8E8FU, 0xFFFFFFFFU, 0xFFFF1E1FU, 0xFFFFFFFFU, 0xFFFF3E3FU, 0xFFFFFFFFU,
+	0x00000000U, 0x00000000U, 0xFFF8F8F8U, 0xFFFFFFFFU, 0xFFF1F0F1U, 0xFFFFFFFFU, 0xFFE3E2E3U, 0xFFFFFFFFU,
+	0xFFC7C6C7U, 0xFFFFFFFFU, 0xFF8F8E8FU, 0xFFFFFFFFU, 0xFF1F1E1FU, 0xFFFFFFFFU, 0xFF3F3E3FU, 0xFFFFFFFFU,
+	0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x01000000U, 0x00000F0FU, 0x03030200U, 0x00071F1FU,
+	0x07070600U, 0x0F0F3F3FU, 0x0F0F0E00U, 0x1F1F7F7FU, 0x1F1F1EFFU, 0xFFFFFFFFU, 0x3F3F3EFFU, 0xFFFFFFFFU,
+	0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000200U, 0x03030000U, 0x00070703U,
+	0x07070000U, 0x0F0F0F07U, 0x0F0F0000U, 0x1F1F1F0FU, 0x1F1FFEFFU, 0xFFFFFF1FU, 0x3F3FFEFFU, 0xFFFFFF3FU,
+	0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x03000000U, 0x00070303U,
+	0x07000000U, 0x0F0F0707U, 0x0F000000U, 0x1F1F0F0FU, 0x1FFFFEFFU, 0xFFFF1F1FU, 0x3FFFFEFFU, 0xFFFF3F3FU,
+	0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00030303U,
+	0x00000000U, 0x0F070707U, 0x1F000000U, 0x1F0F0F0FU, 0xFFFFFEFFU, 0xFF1F1F1FU, 0xFFFFFEFFU, 0xFF3F3F3FU,
+	0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x03030300U,
+	0x00000000U, 0x0707070FU, 0x1F000000U, 0x0F0F0F1FU, 0xFFFFFEFFU, 0x1F1F1FFFU, 0xFFFFFEFFU, 0x3F3F3FFFU,
+	0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x03030700U,
+	0x00000000U, 0x07070F0FU, 0x1F000000U, 0x0F0F1F1FU, 0xFFFFFEFFU, 0x1F1FFFFFU, 0xFFFFFEFFU, 0x3F3FFFFFU,
+	0x00070404U, 0x00000000U, 0x00070000U, 0x00000000U, 0x00070101U, 0x00000000U, 0xFFFFE1E3U, 0xFFFFFFFFU,
+	0xFFFFC5C7U, 0xFFFFFFFFU, 0xFFFF8D8FU, 0xFFFFFFFFU, 0xFFFF1D1FU, 0xFFFFFFFFU, 0xFFFF3D3FU, 0xFFFFFFFFU,
+	0x00040400U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00010100U, 0x00000000U, 0x1F030103U, 0x00001F1FU,
+	0x1F070503U, 0x00001F1FU, 0x3F0F0D0FU, 0x000F3F3FU, 0x7F1F1D1FU, 0x1F1F7F7FU, 0xFF3F3D3FU, 0x3F3FFFFFU,
+	0x00040000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00010000U, 0x00000000U, 0x03030100U, 0x0000000FU,
+	0x07070503U, 0x0000071FU, 0x0F0F0D0FU, 0x000F0F3FU, 0x1F1F1D1FU, 0x1F1F1F7FU, 0x3F3F3D3FU, 0x3F3F3FFFU,
+	0x04040000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x01010000U, 0x00000000U, 0x03030100U, 0x00000003U,
+	0x07070503U, 0x00000707U, 0x0F0F0D0FU, 0x000F0F0FU, 0x1F1F1D1FU, 0x1F1F1F1FU, 0x3F3F3D3FU, 0x3F3F3F3FU,
+	0x04050000U, 0x00000004U, 0x00020000U, 0x00000000U, 0x01050000U, 0x00000001U, 0x030B0100U, 0x00000003U,
+	0x07170503U, 0x00000707U, 0x0F2F0D0FU, 0x000F0F0FU, 0x1F5F1D1FU, 0x1F1F1F1FU, 0x3FBF3D3FU, 0x3F3F3F3FU,
+	0x07040000U, 0x00000404U, 0x07000000U, 0x00000000U, 0x07010000U, 0x00000101U, 0x0F030100U, 0x00000303U,
+	0x1F070503U, 0x00000707U, 0x3F0F0D0FU, 0x000F0F0FU, 0x7F1F1D1FU, 0x1F1F1F1FU, 0xFFBF3D3FU, 0x3F3F3F3FU,
+	0x0F0F0000U, 0x0004040FU, 0x0F0F0000U, 0x0000000FU, 0x0F0F0000U, 0x0001010FU, 0x0F0F0100U, 0x0003030FU,
+	0x1F1F0503U, 0x0007071FU, 0x3F3F0D0FU, 0x000F0F3FU, 0x7F7F1D1FU, 0x1F1F1F7FU, 0xFFFF3D3FU, 0x3F3F3FFFU,
+	0x1F1F1D00U, 0x04041F1FU, 0x1F1F1D00U, 0x00001F1FU, 0x1F1F1D00U, 0x01011F1FU, 0x1F1F1D00U, 0x03031F1FU,
+	0x1F1F1D03U, 0x07071F1FU, 0x3F3F3D0FU, 0x0F0F3F3FU, 0x7F7F7D1FU, 0x1F1F7F7FU, 0xFFFFFD3FU, 0x3F3FFFFFU,
+	0xFFFFFCFCU, 0xFFFFFFFFU, 0xFFFFF8F8U, 0xFFFFFFFFU, 0xFFFFF1F1U, 0xFFFFFFFFU, 0xFFFFE1E3U, 0xFFFFFFFFU,
+	0xFFFFC5C7U, 0xFFFFFFFFU, 0xFFFF8D8FU, 0xFFFFFFFFU, 0xFFFF1D1FU, 0xFFFFFFFFU, 0xFFFF3D3FU, 0xFFFFFFFFU,
+	0xFFFCFCFCU, 0xFFFFFFFFU, 0x00000000U, 0x00000000U, 0xFFF1F1F1U, 0xFFFFFFFFU, 0xFFE3E1E3U, 0xFFFFFFFFU,
+	0xFFC7C5C7U, 0xFFFFFFFFU, 0xFF8F8D8FU, 0xFFFFFFFFU, 0xFF1F1D1FU, 0xFFFFFFFFU, 0xFF3F3D3FU, 0xFFFFFFFFU,
+	0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x03030103U, 0x00001F1FU,
+	0x0707050FU, 0x000F3F3FU, 0x0F0F0D1FU, 0x1F1F7F7FU, 0x1F1F1D3FU, 0x3F3FFFFFU, 0x3F3F3DFFU, 0xFFFFFFFFU,
+	0x0C0C0C00U, 0x0000000CU, 0x00000000U, 0x00000000U, 0x01010100U, 0x00000001U, 0x03030503U, 0x00000703U,
+	0x07070D0FU, 0x000F0F07U, 0x0F0F1D1FU, 0x1F1F1F0FU, 0x1F1F3D3FU, 0x3F3F3F1FU, 0x3F3FFDFFU, 0xFFFFFF3FU,
+	0x0C0E0D00U, 0x00000C0CU, 0x00050500U, 0x00000000U, 0x010B0D00U, 0x00000101U, 0x03171D03U, 0x00000303U,
+	0x072F3D0FU, 0x000F0707U, 0x0F5F7D1FU, 0x1F1F0F0FU, 0x1FBFFD3FU, 0x3F3F1F1FU, 0x3FFFFDFFU, 0xFFFF3F3FU,
+	0x0F0F0C00U, 0x000C0C0CU, 0x0F0F0000U, 0x00000008U, 0x0F0F0100U, 0x00010101U, 0x1F1F0503U, 0x00030303U,
+	0x3F3F0D0FU, 0x00070707U, 0x7F7F1D1FU, 0x1F0F0F0FU, 0xFFFF3D3FU, 0x3F1F1F1FU, 0xFFFFFDFFU, 0xFF3F3F3FU,
+	0x1F1F1D00U, 0x0C0C1C1FU, 0x1F1F1D00U, 0x0000181FU, 0x1F1F1D00U, 0x0101111FU, 0x1F1F1D03U, 0x0303031FU,
+	0x3F3F3D0FU, 0x0707073FU, 0x7F7F7D1FU, 0x0F0F0F7FU, 0xFFFFFD3FU, 0x1F1F1FFFU, 0xFFFFFDFFU, 0x3F3F3FFFU,
+	0x3F3F3D3FU, 0x0C3C3F3FU, 0x3F3F3D3FU, 0x00383F3FU, 0x3F3F3D3FU, 0x01313F3FU, 0x3F3F3D3FU, 0x03233F3FU,
+	0x3F3F3D3FU, 0x07073F3FU, 0x7F7F7D7FU, 0x0F0F7F7FU, 0xFFFFFDFFU, 0x1F1FFFFFU, 0xFFFFFDFFU, 0x3F3FFFFFU,
+	0xFFFFF8FCU, 0xFFFFFFFFU, 0x000E0808U, 0x00000000U, 0x000E0000U, 0x00000000U, 0x000E0202U, 0x00000000U,
+	0xFFFFC3C7U, 0xFFFFFFFFU, 0xFFFF8B8FU, 0xFFFFFFFFU, 0xFFFF1B1FU, 0xFFFFFFFFU, 0xFFFF3B3FU, 0xFFFFFFFFU,
+	0x3F3C383CU, 0x00003F3FU, 0x00080800U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00020200U, 0x00000000U,
+	0x3F070307U, 0x00003F3FU, 0x3F0F0B07U, 0x00003F3FU, 0x7F1F1B1FU, 0x001F7F7FU, 0xFF3F3B3FU, 0x3F3FFFFFU,
+	0x1C1C1800U, 0x0000001FU, 0x00080000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00020000U, 0x00000000U,
+	0x07070300U, 0x0000001FU, 0x0F0F0B07U, 0x00000F3FU, 0x1F1F1B1FU, 0x001F1F7FU, 0x3F3F3B3FU, 0x3F3F3FFFU,
+	0x1C1C1800U, 0x0000001CU, 0x08080000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x02020000U, 0x00000000U,
+	0x07070300U, 0x00000007U, 0x0F0F0B07U, 0x00000F0FU, 0x1F1F1B1FU, 0x001F1F1FU, 0x3F3F3B3FU, 0x3F3F3F3FU,
+	0x1C1D1800U, 0x0000001CU, 0x080A0000U, 0x00000008U, 0x00040000U, 0x00000000U, 0x020A0000U, 0x00000002U,
+	0x07170300U, 0x00000007U, 0x0F2F0B07U, 0x00000F0FU, 0x1F5F1B1FU, 0x001F1F1FU, 0x3FBF3B3FU, 0x3F3F3F3FU,
+	0x1F1C1800U, 0x00001C1CU, 0x0E080000U, 0x00000808U, 0x0E000000U, 0x00000000U, 0x0E020000U, 0x00000202U,
+	0x1F070300U, 0x00000707U, 0x3F0F0B07U, 0x00000F0FU, 0x7F1F1B1FU, 0x001F1F1FU, 0xFF3F3B3FU, 0x3F3F3F3FU,
+	0x1F1F1800U, 0x001C1C1FU, 0x1F1F0000U, 0x0008081FU, 0x1F1F0000U, 0x0000001FU, 0x1F1F0000U, 0x0002021FU,
+	0x1F1F0300U, 0x0007071FU, 0x3F3F0B07U, 0x000F0F3FU, 0x7F7F1B1FU, 0x001F1F7FU, 0xFFFF3B3FU, 0x3F3F3FFFU,
+	0x3F3F3B00U, 0x1C1C3F3FU, 0x3F3F3B00U, 0x08083F3FU, 0x3F3F3B00U, 0x00003F3FU, 0x3F3F3B00U, 0x02023F3FU,
+	0x3F3F3B00U, 0x07073F3FU, 0x3F3F3B07U, 0x0F0F3F3FU, 0x7F7F7B1FU, 0x1F1F7F7FU, 0xFFFFFB3FU, 0x3F3FFFFFU,
+	0xFFFFF8FCU, 0xFFFFFFFFU, 0xFFFFF8F8U, 0xFFFFFFFFU, 0xFFFFF1F1U, 0xFFFFFFFFU, 0xFFFFE3E3U, 0xFFFFFFFFU,
+	0xFFFFC3C7U, 0xFFFFFFFFU, 0xFFFF8B8FU, 0xFFFFFFFFU, 0xFFFF1B1FU, 0xFFFFFFFFU, 0xFFFF3B3FU, 0xFFFFFFFFU,
+	0xFFFCF8FCU, 0xFFFFFFFFU, 0xFFF8F8F8U, 0xFFFFFFFFU, 0x00000000U, 0x00000000U, 0xFFE3E3E3U, 0xFFFFFFFFU,
+	0xFFC7C3C7U, 0xFFFFFFFFU, 0xFF8F8B8FU, 0xFFFFFFFFU, 0xFF1F1B1FU, 0xFFFFFFFFU, 0xFF3F3B3FU, 0xFFFFFFFFU,
+	0x3C3C383CU, 0x00003F3FU, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U,
+	0x07070307U, 0x00003F3FU, 0x0F0F0B1FU, 0x001F7F7FU, 0x1F1F1B3FU, 0x3F3FFFFFU, 0x3F3F3B7FU, 0x7F7FFFFFU,
+	0x3C3C3A3CU, 0x00003E3CU, 0x18181800U, 0x00000018U, 0x00000000U, 0x00000000U, 0x03030300U, 0x00000003U,
+	0x07070B07U, 0x00000F07U, 0x0F0F1B1FU, 0x001F1F0FU, 0x1F1F3B3FU, 0x3F3F3F1FU, 0x3F3F7B7FU, 0x7F7F7F3FU,
+	0x3C3E3B3CU, 0x00003C3CU, 0x181D1B00U, 0x00001818U, 0x000A0A00U, 0x00000000U, 0x03171B00U, 0x00000303U,
+	0x072F3B07U, 0x00000707U, 0x0F5F7B1FU, 0x001F0F0FU, 0x1FBFFB3FU, 0x3F3F1F1FU, 0x3F7FFB7FU, 0x7F7F3F3FU,
+	0x3F3F3A3CU, 0x003C3C3CU, 0x1F1F1800U, 0x00181818U, 0x1F1F0000U, 0x00000011U, 0x1F1F0300U, 0x00030303U,
+	0x3F3F0B07U, 0x00070707U, 0x7F7F1B1FU, 0x000F0F0FU, 0xFFFF3B3FU, 0x3F1F1F1FU, 0xFFFF7B7FU, 0x7F3F3F3FU,
+	0x3F3F3B3CU, 0x3C3C3C3FU, 0x3F3F3B00U, 0x1818383FU, 0x3F3F3B00U, 0x0000313FU, 0x3F3F3B00U, 0x0303233FU,
+	0x3F3F3B07U, 0x0707073FU, 0x7F7F7B1FU, 0x0F0F0F7FU, 0xFFFFFB3FU, 0x1F1F1FFFU, 0xFFFFFB7FU, 0x3F3F3FFFU,
+	0x7F7F7B7FU, 0x3C7C7F7FU, 0x7F7F7B7FU, 0x18787F7FU, 0x7F7F7B7FU, 0x00717F7FU, 0x7F7F7B7FU, 0x03637F7FU,
+	0x7F7F7B7FU, 0x07477F7FU, 0x7F7F7B7FU, 0x0F0F7F7FU, 0xFFFFFBFFU, 0x1F1FFFFFU, 0xFFFFFBFFU, 0x3F3FFFFFU,
+	0xFFFFF4FCU, 0xFFFFFFFFU, 0xFFFFF0F8U, 0xFFFFFFFFU, 0x001C1010U, 0x00000000U, 0x001C0000U, 0x00000000U,
+	0x001C0404U, 0x00000000U, 0xFFFF878FU, 0xFFFFFFFFU, 0xFFFF171FU, 0xFFFFFFFFU, 0xFFFF373FU, 0xFFFFFFFFU,
+	0x7F7C7478U, 0x00007F7FU, 0x7F787078U, 0x00007F7FU, 0x00101000U, 0x00000000U, 0x00000000U, 0x00000000U,
+	0x00040400U, 0x00000000U, 0x7F0F070FU, 0x00007F7FU, 0x7F1F170FU, 0x00007F7FU, 0xFF3F373FU, 0x003FFFFFU,
+	0x7C7C7478U, 0x00007C7FU, 0x38383000U, 0x0000003EU, 0x00100000U, 0x00000000U, 0x00000000U, 0x00000000U,
+	0x00040000U, 0x00000000U, 0x0E0E0600U, 0x0000003EU, 0x1F1F170FU, 0x00001F7FU, 0x3F3F373FU, 0x003F3FFFU,
+	0x7C7C7478U, 0x00007C7CU, 0x38383000U, 0x00000038U, 0x10100000U, 0x00000000U, 0x00000000U, 0x00000000U,
+	0x04040000U, 0x00000000U, 0x0E0E0600U, 0x0000000EU, 0x1F1F170FU, 0x00001F1FU, 0x3F3F373FU, 0x003F3F3FU,
+	0x7C7D7478U, 0x00007C7CU, 0x383A3000U, 0x00000038U, 0x10140000U, 0x00000010U, 0x00080000U, 0x00000000U,
+	0x04140000U, 0x00000004U, 0x0E2E0600U, 0x0000000EU, 0x1F5F170FU, 0x00001F1FU, 0x3FBF373FU, 0x003F3F3FU,
+	0x7F7C7478U, 0x00007C7CU, 0x3E383000U, 0x00003838U, 0x1C100000U, 0x00001010U, 0x1C000000U, 0x00000000U,
+	0x1C040000U, 0x00000404U, 0x3E0E0600U, 0x00000E0EU, 0x7F1F170FU, 0x00001F1FU, 0xFF3F373FU, 0x003F3F3FU,
+	0x7F7F7478U, 0x007C7C7FU, 0x3E3E3000U, 0x0038383EU, 0x3E3E0000U, 0x0010103EU, 0x3E3E0000U, 0x0000003EU,
+	0x3E3E0000U, 0x0004043EU, 0x3E3E0600U, 0x000E0E3EU, 0x7F7F170FU, 0x001F1F7FU, 0xFFFF373FU, 0x003F3FFFU,
+	0x7F7F7778U, 0x7C7C7F7FU, 0x7F7F7700U, 0x38387F7FU, 0x7F7F7700U, 0x10107F7FU, 0x7F7F7700U, 0x00007F7FU,
+	0x7F7F7700U, 0x04047F7FU, 0x7F7F7700U, 0x0E0E7F7FU, 0x7F7F770FU, 0x1F1F7F7FU, 0xFFFFF73FU, 0x3F3FFFFFU,
+	0xFFFFF4FCU, 0xFFFFFFFFU, 0xFFFFF0F8U, 0xFFFFFFFFU, 0xFFFFF1F1U, 0xFFFFFFFFU, 0xFFFFE3E3U, 0xFFFFFFFFU,
+	0xFFFFC7C7U, 0xFFFFFFFFU, 0xFFFF878FU, 0xFFFFFFFFU, 0xFFFF171FU, 0xFFFFFFFFU, 0xFFFF373FU, 0xFFFFFFFFU,
+	0xFFFCF4FCU, 0xFFFFFFFFU, 0xFFF8F0F8U, 0xFFFFFFFFU, 0xFFF1F1F1U, 0xFFFFFFFFU, 0x00000000U, 0x00000000U,
+	0xFFC7C7C7U, 0xFFFFFFFFU, 0xFF8F878FU, 0xFFFFFFFFU, 0xFF1F171FU, 0xFFFFFFFFU, 0xFF3F373FU, 0xFFFFFFFFU,
+	0xFCFCF4FEU, 0x00FEFFFFU, 0x78787078U, 0x00007F7FU, 0x00000000U, 0x00000000U, 0x00000000U, 0x00000000U,
+	0x00000000U, 0x00000000U, 0x0F0F070FU, 0x00007F7FU, 0x1F1F173FU, 0x003FFFFFU, 0x3F3F377FU, 0x7F7FFFFFU,
+	0xFCFCF6FEU, 0x00FEFEFCU, 0x78787478U, 0x00007C78U, 0x30303000U, 0x00000030U, 0x00000000U, 0x00000000U,
+	0x06060600U, 0x00000006U, 0x0F0F170FU, 0x00001F0FU, 0x1F1F373FU, 0x003F3F1FU, 0x3F3F777FU, 0x7F7F7F3FU,
+	0xFCFEF7FEU, 0x00FEFCFCU, 0x787D7778U, 0x00007878U, 0x303A3600U, 0x00003030U, 0x00141400U, 0x00000000U,
+	0x062E3600U, 0x00000606U, 0x0F5F770FU, 0x00000F0FU, 0x1FBFF73FU, 0x003F1F1FU, 0x3F7FF77FU, 0x7F7F3F3FU,
+	0xFFFFF6FEU, 0x00FCFCFCU, 0x7F7F7478U, 0x00787878U, 0x3E3E3000U, 0x00303030U, 0x3E3E0000U, 0x00000022U,
+	0x3E3E0600U, 0x00060606U, 0x7F7F170FU, 0x000F0F0FU, 0xFFFF373FU, 0x001F1F1FU, 0xFFFF777FU, 0x7F3F3F3FU,
+	0xFFFFF7FEU, 0xFCFCFCFFU, 0x7F7F7778U, 0x7878787FU, 0x7F7F7700U, 0x3030717FU, 0x7F7F7700U, 0x0000637FU,
+	0x7F7F7700U, 0x0606477FU, 0x7F7F770FU, 0x0F0F0F7FU, 0xFFFFF73FU, 0x1F1F1FFFU, 0xFFFFF77FU, 0x3F3F3FFFU,
+	0xFFFFF7FFU, 0xFCFCFFFFU, 0xFFFFF7FFU, 0x78F8FFFFU, 0xFFFFF7FFU, 0x30F1FFFFU, 0xFFFFF7FFU, 0x00E3FFFFU,
+	0xFFFFF7FFU, 0x06C7FFFFU, 0xFFFFF7FFU, 0x0F8FFFFFU, 0xFFFFF7FFU, 0x1F1FFFFFU, 0xFFFFF7FFU, 0x3F3FFFFFU
+};
+
+static std::size_t index(bool strongToMove, int weakKing, int strongKing, int pawn) noexcept
+{
+	return static_cast<std::size_t>(strongKing | (weakKing << 6) | (static_cast<int>(strongToMove) << 12)
+		| ((pawn % fileSize) << 13) | ((rankSize - 2 - pawn / fileSize) << 15));
+}
+
+static std::uint8_t bits(Result result) noexcept
+{
+	return static_cast<std::uint8_t>(result);
+}
+
+static Result initialResult(std::size_t position) noexcept
+{
+	const int strongKing{ static_cast<int>(position & 63) };
+	const int weakKing{ static_cast<int>((position >> 6) & 63) };
+	const bool strongToMove{ static_cast<bool>((position >> 12) & 1) };
+	const int pawn{ static_cast<int>((position >> 13) & 3) + (rankSize - 2 - static_cast<int>(position >> 15)) * fileSize };
+
+	const std::uint64_t strongKingMoves{ MoveGen::kingMoves(static_cast<std::size_t>(strongKing)).board() };
+	const std::uint64_t weakKingMoves{ MoveGen::kingMoves(static_cast<std::size_t>(weakKing)).board() };
+	const std::uint64_t pawnAttacks{ MoveGen::whitePawnMoves(static_cast<std::size_t>(pawn)).board() };
+	const std::uint64_t weakKingSquare{ 1ULL << weakKing };
+	const std::uint64_t pawnSquare{ 1ULL << pawn };
+
+	//kings touching, two pieces on one square or the weak king in check with the strong side to move
+	if (strongKing == weakKing || (strongKingMoves & weakKingSquare) || strongKing == pawn || weakKing == pawn
+		|| (strongToMove && (pawnAttacks & weakKingSquare)))
+	{
+		return Result::Invalid;
+	}
+
+	//the pawn promotes and the new queen can not be taken
+	const int promotion{ pawn + fileSize };
+	if (strongToMove && pawn / fileSize == rankSize - 2 && strongKing != promotion && weakKing != promotion
+		&& (!(weakKingMoves & (1ULL << promotion)) || (strongKingMoves & (1ULL << promotion))))
+	{
+		return Result::Win;
+	}
+
+	//stalemate or the weak king takes the pawn
+	if (!strongToMove && (!(weakKingMoves & ~(strongKingMoves | pawnAttacks)) || (weakKingMoves & ~strongKingMoves & pawnSquare)))
+	{
+		return Result::Draw;
+	}
+
+	return Result::Unknown;
+}
+
+// the strong side wins if one move wins and draws if all moves draw, the weak side the other way round
+static Result classify(const std::vector<Result>& results, std::size_t position) noexcept
+{
+	const int strongKing{ static_cast<int>(position & 63) };
+	const int weakKing{ static_cast<int>((position >> 6) & 63) };
+	const bool strongToMove{ static_cast<bool>((position >> 12) & 1) };
+	const int pawn{ static_cast<int>((position >> 13) & 3) + (rankSize - 2 - static_cast<int>(position >> 15)) * fileSize };
+
+	std::uint8_t reachable{};
+
+	if (strongToMove)
+	{
+		for (BitBoard moves{ MoveGen::kingMoves(static_cast<std::size_t>(strongKing)) }; moves.board();)
+		{
+			reachable |= bits(results[index(false, weakKing, moves.popLeastSignificantBit(), pawn)]);
+		}
+
+		//pushing onto a king gives an invalid position, the push to the last rank is already a known win
+		const int push{ pawn + fileSize };
+		if (push / fileSize < rankSize - 1)
+		{
+			reachable |= bits(results[index(false, weakKing, strongKing, push)]);
+		}
+
+		if (pawn / fileSize == 1 && push != strongKing && push != weakKing)
+		{
+			reachable |= bits(results[index(false, weakKing, strongKing, push + fileSize)]);
+		}
+
+		return (reachable & bits(Result::Win)) ? Result::Win : (reachable & bits(Result::Unknown)) ? Result::Unknown : Result::Draw;
+	}
+
+	for (BitBoard moves{ MoveGen::kingMoves(static_cast<std::size_t>(weakKing)) }; moves.board();)
+	{
+		reachable |= bits(results[index(true, moves.popLeastSignificantBit(), strongKing, pawn)]);
+	}
+
+	return (reachable & bits(Result::Draw)) ? Result::Draw : (reachable & bits(Result::Unknown)) ? Result::Unknown : Result::Win;
+}
+
+// the retrograde analysis kingPawnWins comes from, reads the king and pawn tables of MoveGen
+static std::vector<std::uint32_t> generateKingPawnWins() noexcept
+{
+	std::vector<Result> results(positionCount);
+
+	for (std::size_t position{}; position < positionCount; ++position)
+	{
+		results[position] = initialResult(position);
+	}
+
+	//every pass settles the positions one move further from a known result until nothing changes
+	for (bool changed{ true }; changed;)
+	{
+		changed = false;
+
+		for (std::size_t position{}; position < positionCount; ++position)
+		{
+			if (results[position] != Result::Unknown) continue;
+
+			results[position] = classify(results, position);
+			changed |= results[position] != Result::Unknown;
+		}
+	}
+
+	std::vector<std::uint32_t> wins(kingPawnWins.size());
+
+	for (std::size_t position{}; position < positionCount; ++position)
+	{
+		if (results[position] == Result::Win)
+		{
+			wins[position / wordBits] |= 1U << (position % wordBits);
+		}
+	}
+
+	return wins;
+}
+
+
+
+namespace Bitbase
+{
+	bool kingPawnWin(bool strongWhite, int strongKing, int pawn, int weakKing, bool strongToMove) noexcept
+	{
+		//black is flipped to move up the board and the pawn is mirrored onto the queen side
+		const int rankFlip{ strongWhite ? 0 : 56 };
+		const int fileFlip{ ((pawn ^ rankFlip) % fileSize) < pawnFiles ? 0 : 7 };
+		const int flip{ rankFlip ^ fileFlip };
+
+		const std::size_t position{ index(strongToMove, weakKing ^ flip, strongKing ^ flip, pawn ^ flip) };
+
+		return kingPawnWins[position / wordBits] & (1U << (position % wordBits));
+	}
+
+	bool verify(std::ostream& out)
+	{
+		const std::vector<std::uint32_t> wins{ generateKingPawnWins() };
+		std::size_t differences{};
+
+		for (std::size_t word{}; word < wins.size(); ++word)
+		{
+			differences += wins[word] != kingPawnWins[word];
+		}
+
+		out << "kpk bitbase: " << kingPawnWins.size() << " words, " << differences << " differ\n";
+
+		if (!differences) return true;
+
+		//eight words to a line as in kingPawnWins
+		std::ostringstream table;
+		table << std::hex << std::uppercase << std::setfill('0');
+
+		for (std::size_t word{}; word < wins.size(); ++word)
+		{
+			table << (word % 8 ? " " : "\t") << "0x" << std::setw(8) << wins[word] << 'U'
+				<< (word + 1 == wins.size() ? "\n" : word % 8 == 7 ? ",\n" : ",");
+		}
+
+		out << table.str();
+		return false;
+	}
+}
\ No newline at end of file
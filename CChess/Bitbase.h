@@ -0,0 +1,16 @@
+#pragma once
+
+#include <iosfwd>
+
+
+
+// win or draw for every king and pawn against king position, a table of one bit per position built into the program
+namespace Bitbase
+{
+	// rebuilds the table by retrograde analysis and compares it with the built in one, a table that differs is written out 
+	// as the initializer to replace it with, reads the king and pawn tables of MoveGen
+	bool verify(std::ostream& out);
+
+	// true if the side with the pawn wins, squares are as on the board for either color
+	bool kingPawnWin(bool strongWhite, int strongKing, int pawn, int weakKing, bool strongToMove) noexcept;
+};
\ No newline at end of file
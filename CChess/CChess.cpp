@@ -2,6 +2,8 @@
 
 #include <exception>
 #include <algorithm>
+#include <string>
+#include <utility>
 
 #include "Engine.h"
 #include "Move.h"
@@ -11,6 +13,9 @@
 //engine instance
 static Engine* engine{ nullptr };
 
+//the last principal variation handed out by engine_search_info()
+static std::string principalVariation{};
+
 
 
 //	ENGINE
@@ -106,7 +111,8 @@ CCHESS_BOOL engine_search_info(CCHESS_BOOL* done, int* evaluation, int* depth, f
 		*depth = info.depth;
 		*nodes_per_second = info.nodesPerSecond;
 		*timeRemaining = info.timeRemaining;
-		*principal_variation = info.principalVariation.data();
+		principalVariation = std::move(info.principalVariation);
+		*principal_variation = principalVariation.c_str();
 
 		return true;
 	}
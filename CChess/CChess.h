@@ -54,7 +54,7 @@
 	//	Start async search. Stop with engine_stop_search(). Get statistics with engine_search_statistics().
 	void engine_start_search() CCHESS_NOEXCEPT;
 
-	//	Stop the async search. 
+	//	Stop the async search. Returns once the search has stopped and its best move is final.
 	void engine_stop_search() CCHESS_NOEXCEPT;
 
 	//	Get stats about the async search. Returns CCHESS_TRUE if any values changed since the last call - 
@@ -62,7 +62,7 @@
 	//		depth:					The current or final search depth.
 	//		nodes_per_second:		How many nodes (brances of search tree, moves made) are reached per second.
 	//		principal_variation:	A string containing the principal variation (line of best moves) seperated by commas. Memory 
-	//								is owned by the engine and invalid after engine_destroy() is called.
+	//								is owned by the library and invalid after the next call.
 	CCHESS_BOOL engine_search_info(CCHESS_BOOL* done, int* evaluation, int* depth, float* nodes_per_second, float* timeRemaining, const char** principal_variation) CCHESS_NOEXCEPT;
 
 	//	Get the best move after the search is done. If the search is not done or stopSearch() has not been called 'source' and 
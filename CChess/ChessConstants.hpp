@@ -10,7 +10,7 @@ static constexpr int fileSize{ 8 };
 static constexpr int rankSize{ 8 };
 static constexpr int maxSearchDepth{ 50 };
 static constexpr int maxLegalMoves{ 218 };
-static constexpr int maxLegalCaptures{ 30 };
+static constexpr int maxLegalCaptures{ 96 };
 
 #define cachealign alignas(std::hardware_destructive_interference_size)
 
@@ -0,0 +1,113 @@
+#include "Endgame.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+
+#include "Bitbase.h"
+#include "ChessConstants.hpp"
+#include "State.h"
+
+
+
+//	Static Helpers
+
+static constexpr int edgeBonus{ 20 };
+static constexpr int closenessBonus{ 10 };
+static constexpr int cornerBonus{ 40 };
+static constexpr std::uint64_t whitePawnMaterial{ 1ULL << (static_cast<int>(Piece::WhitePawn) * State::materialKeyBits) };
+static constexpr std::uint64_t blackPawnMaterial{ 1ULL << (static_cast<int>(Piece::BlackPawn) * State::materialKeyBits) };
+
+static int file(int square) noexcept
+{
+	return square % fileSize;
+}
+
+static int rank(int square) noexcept
+{
+	return square / fileSize;
+}
+
+static int distance(int first, int second) noexcept
+{
+	return std::max(std::abs(file(first) - file(second)), std::abs(rank(first) - rank(second)));
+}
+
+// 0 on the four centre squares up to 6 in the corners
+static int centreDistance(int square) noexcept
+{
+	const int fileDistance{ file(square) < fileSize / 2 ? fileSize / 2 - 1 - file(square) : file(square) - fileSize / 2 };
+	const int rankDistance{ rank(square) < rankSize / 2 ? rankSize / 2 - 1 - rank(square) : rank(square) - rankSize / 2 };
+
+	return fileDistance + rankDistance;
+}
+
+static int kingSquare(const State& state, bool white) noexcept
+{
+	return (white ? state.pieceOccupancyT<Piece::WhiteKing>() : state.pieceOccupancyT<Piece::BlackKing>()).leastSignificantBit();
+}
+
+static int strongMaterial(const State& state, bool strongWhite) noexcept
+{
+	return strongWhite ? state.score().endgame : -state.score().endgame;
+}
+
+static int fromWhite(int score, bool strongWhite) noexcept
+{
+	return strongWhite ? score : -score;
+}
+
+static bool kingPawnWin(const State& state, bool strongWhite, bool whiteToMove) noexcept
+{
+	const int pawn{ (strongWhite ? state.pieceOccupancyT<Piece::WhitePawn>() : state.pieceOccupancyT<Piece::BlackPawn>()).leastSignificantBit() };
+
+	return Bitbase::kingPawnWin(strongWhite, kingSquare(state, strongWhite), pawn, kingSquare(state, !strongWhite), whiteToMove == strongWhite);
+}
+
+
+
+namespace Endgame
+{
+	int loneKing(const State& state, bool strongWhite) noexcept
+	{
+		const int strongKing{ kingSquare(state, strongWhite) };
+		const int weakKing{ kingSquare(state, !strongWhite) };
+
+		const int score{ knownWin + strongMaterial(state, strongWhite) + edgeBonus * centreDistance(weakKing)
+			+ closenessBonus * (fileSize - 1 - distance(strongKing, weakKing)) };
+
+		return fromWhite(score, strongWhite);
+	}
+
+	int bishopKnight(const State& state, bool strongWhite) noexcept
+	{
+		const int strongKing{ kingSquare(state, strongWhite) };
+		const int weakKing{ kingSquare(state, !strongWhite) };
+		const int bishop{ (strongWhite ? state.pieceOccupancyT<Piece::WhiteBishop>() : state.pieceOccupancyT<Piece::BlackBishop>()).leastSignificantBit() };
+
+		//a1 and h8 are dark, a8 and h1 are light
+		const bool darkBishop{ (file(bishop) + rank(bishop)) % 2 == 0 };
+		const int cornerDistance{ darkBishop
+			? std::min(distance(weakKing, a1), distance(weakKing, h8))
+			: std::min(distance(weakKing, a8), distance(weakKing, h1)) };
+
+		const int score{ knownWin + strongMaterial(state, strongWhite) + cornerBonus * (fileSize - 1 - cornerDistance)
+			+ closenessBonus * (fileSize - 1 - distance(strongKing, weakKing)) };
+
+		return fromWhite(score, strongWhite);
+	}
+
+	int kingPawn(const State& state, bool strongWhite, bool whiteToMove) noexcept
+	{
+		//the material and piece-square score grow as the pawn advances, so the search still makes progress in a won ending
+		return kingPawnWin(state, strongWhite, whiteToMove) ? fromWhite(knownWin + strongMaterial(state, strongWhite), strongWhite) : 0;
+	}
+
+	bool kingPawnDraw(const State& state, bool whiteToMove) noexcept
+	{
+		const std::uint64_t material{ state.materialKey() };
+		if (material != whitePawnMaterial && material != blackPawnMaterial) return false;
+
+		return !kingPawnWin(state, material == whitePawnMaterial, whiteToMove);
+	}
+}
\ No newline at end of file
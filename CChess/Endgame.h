@@ -0,0 +1,24 @@
+#pragma once
+
+#include "State.h"
+
+
+
+// evaluators for endgames whose result the general evaluation does not see, all scores are white relative
+namespace Endgame
+{
+	// far above any material advantage and far below a mate score, so the search still prefers the actual mate
+	constexpr int knownWin{ 10000 };
+
+	// a bare king against a queen, a rook or two bishops, it is driven to the edge and the other king comes closer
+	int loneKing(const State& state, bool strongWhite) noexcept;
+
+	// a bare king against bishop and knight, it can only be mated in a corner of the bishop's color
+	int bishopKnight(const State& state, bool strongWhite) noexcept;
+
+	// a bare king against king and pawn, exact from the bitbase, a draw scores zero
+	int kingPawn(const State& state, bool strongWhite, bool whiteToMove) noexcept;
+
+	// true only for a king and pawn against king position the bitbase has as a draw, the search needs nothing more
+	bool kingPawnDraw(const State& state, bool whiteToMove) noexcept;
+};
\ No newline at end of file
@@ -4,24 +4,35 @@
 #include <array>
 #include <atomic>
 #include <chrono>
+#include <cmath>
 #include <condition_variable>
 #include <cstdint>
+#include <cstdlib>
+#include <deque>
 #include <functional>
+#include <iostream>
+#include <memory>
 #include <mutex>
 #include <span>
 #include <stop_token>
 #include <string_view>
 #include <thread>
 #include <string>
+#include <type_traits>
+#include <vector>
 
 #include "BitBoard.h"
 #include "Castle.hpp"
+#include "Endgame.h"
 #include "Evaluate.h"
 #include "KillerMoveHistory.h"
 #include "Move.h"
 #include "MoveGen.h"
 #include "MoveList.hpp"
+#include "MovePicker.h"
+#include "Nnue.h"
 #include "State.h"
+#include "TranspositionTable.h"
 
 
 
@@ -29,120 +40,108 @@
 
 static State startState{ "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR", Castle::All };
 
-static void findWhiteSquares(State& state) noexcept
+// Define CCHESS_COPY_MAKE to search on a fresh copy of State for every move instead of making and unmaking moves on one State. 
+// Which one is faster depends on the compiler and CPU, compare the nodes per second in SearchInfo.
+#ifdef CCHESS_COPY_MAKE
+static constexpr bool copyMake{ true };
+#else
+static constexpr bool copyMake{ false };
+#endif
+
+using SearchState = std::conditional_t<copyMake, State, State&>;
+
+// Define CCHESS_NO_NULL_MOVE, CCHESS_NO_LATE_MOVE_REDUCTIONS or CCHESS_NO_FUTILITY_PRUNING to turn a pruning technique off, 
+// compare the depth reached in SearchInfo and the games played against a build with it on.
+#ifdef CCHESS_NO_NULL_MOVE
+static constexpr bool nullMovePruning{ false };
+#else
+static constexpr bool nullMovePruning{ true };
+#endif
+
+#ifdef CCHESS_NO_LATE_MOVE_REDUCTIONS
+static constexpr bool lateMoveReductions{ false };
+#else
+static constexpr bool lateMoveReductions{ true };
+#endif
+
+#ifdef CCHESS_NO_FUTILITY_PRUNING
+static constexpr bool futilityPruning{ false };
+#else
+static constexpr bool futilityPruning{ true };
+#endif
+
+static constexpr int lateMoveTableMoves{ 64 };
+
+static constexpr std::array<int, pieceCount> pieceValues{ 0, 100, 300, 300, 500, 900, 0, 100, 300, 300, 500, 900, 0 };
+
+static void takeBackMove(State& state, Move move, bool whiteToMove, const State::Undo& undo) noexcept
 {
-	std::uint64_t squares{};
-
-	BitBoard pawns{ state.pieceOccupancyT<Piece::WhitePawn>() };
-	BitBoard knights{ state.pieceOccupancyT<Piece::WhiteKnight>() };
-	BitBoard bishops{ state.pieceOccupancyT<Piece::WhiteBishop>() };
-	BitBoard rooks{ state.pieceOccupancyT<Piece::WhiteRook>() };
-	BitBoard queens{ state.pieceOccupancyT<Piece::WhiteQueen>() };
-	BitBoard kings{ state.pieceOccupancyT<Piece::WhiteKing>() };
-
-	while (pawns.board())
-	{
-		const int index{ pawns.popLeastSignificantBit() };
-		squares |= MoveGen::whitePawnMoves(index).board();
-	}
-
-	while (knights.board())
+	if constexpr (!copyMake)
 	{
-		const int index{ knights.popLeastSignificantBit() };
-		squares |= MoveGen::knightMoves(index).board();
-	}
-
-	while (bishops.board())
-	{
-		const int index{ bishops.popLeastSignificantBit() };
-		squares |= MoveGen::bishopMoves(index, state.occupancy()).board();
-	}
-
-	while (rooks.board())
-	{
-		const int index{ rooks.popLeastSignificantBit() };
-		squares |= MoveGen::rookMoves(index, state.occupancy()).board();
+		state.unmakeMove(whiteToMove, move, undo);
 	}
+}
 
-	while (queens.board())
+static void takeBackNullMove(State& state, const State::Undo& undo) noexcept
+{
+	if constexpr (!copyMake)
 	{
-		const int index{ queens.popLeastSignificantBit() };
-		squares |= MoveGen::bishopMoves(index, state.occupancy()).board() | MoveGen::rookMoves(index, state.occupancy()).board();
+		state.unmakeNullMove(undo);
 	}
-
-	const int kingIndex{ kings.popLeastSignificantBit() };
-	squares |= MoveGen::kingMoves(kingIndex).board();
-
-	state.setWhiteSquares(squares & ~state.whiteOccupancy().board());
 }
 
-static void findBlackSquares(State& state) noexcept
+// the material the side to move has besides pawns and the king, without it zugzwang is too likely to trust a null move
+static int nonPawnMaterial(const State& state, bool white) noexcept
 {
-	std::uint64_t squares{};
-
-	BitBoard pawns{ state.pieceOccupancyT<Piece::BlackPawn>() };
-	BitBoard knights{ state.pieceOccupancyT<Piece::BlackKnight>() };
-	BitBoard bishops{ state.pieceOccupancyT<Piece::BlackBishop>() };
-	BitBoard rooks{ state.pieceOccupancyT<Piece::BlackRook>() };
-	BitBoard queens{ state.pieceOccupancyT<Piece::BlackQueen>() };
-	BitBoard kings{ state.pieceOccupancyT<Piece::BlackKing>() };
-
-	while (pawns.board())
-	{
-		const int index{ pawns.popLeastSignificantBit() };
-		squares |= MoveGen::blackPawnMoves(index).board();
-	}
+	const int offset{ white ? whitePieceOffset : blackPieceOffset };
+	int material{ 0 };
 
-	while (knights.board())
+	for (int piece{ offset + 1 }; piece < offset + 5; ++piece)
 	{
-		const int index{ knights.popLeastSignificantBit() };
-		squares |= MoveGen::knightMoves(index).board();
+		material += pieceValues[static_cast<std::size_t>(piece)] * static_cast<int>(state.pieceOccupancy(static_cast<Piece>(piece)).bitCount());
 	}
 
-	while (bishops.board())
-	{
-		const int index{ bishops.popLeastSignificantBit() };
-		squares |= MoveGen::bishopMoves(index, state.occupancy()).board();
-	}
+	return material;
+}
 
-	while (rooks.board())
-	{
-		const int index{ rooks.popLeastSignificantBit() };
-		squares |= MoveGen::rookMoves(index, state.occupancy()).board();
-	}
+// ln(depth) * ln(moves) shaped reductions, computed once since std::log is not constexpr
+static std::array<int, maxSearchDepth * lateMoveTableMoves> lateMoveReductionTable() noexcept
+{
+	std::array<int, maxSearchDepth * lateMoveTableMoves> reductions{};
 
-	while (queens.board())
+	for (int depth{ 1 }; depth < maxSearchDepth; ++depth)
 	{
-		const int index{ queens.popLeastSignificantBit() };
-		squares |= MoveGen::bishopMoves(index, state.occupancy()).board() | MoveGen::rookMoves(index, state.occupancy()).board();
+		for (int moves{ 1 }; moves < lateMoveTableMoves; ++moves)
+		{
+			const double reduction{ 0.75 + std::log(depth) * std::log(moves) / 2.25 };
+			reductions[static_cast<std::size_t>(depth * lateMoveTableMoves + moves)] = static_cast<int>(reduction);
+		}
 	}
 
-	const int kingIndex{ kings.popLeastSignificantBit() };
-	squares |= MoveGen::kingMoves(kingIndex).board();
-
-	state.setBlackSquares(squares & ~state.blackOccupancy().board());
+	return reductions;
 }
 
-static bool makeLegalMove(State& state, Move move, bool whiteToMove)
-{
-	state.makeMove(whiteToMove, move);
-
-	findWhiteSquares(state);
-	findBlackSquares(state);
+static const std::array<int, maxSearchDepth * lateMoveTableMoves> lateMoveReductionsTable{ lateMoveReductionTable() };
 
-	return whiteToMove
-		? (state.pieceOccupancyT<Piece::BlackKing>().board() && !state.whiteKingInCheck())
-		: (state.pieceOccupancyT<Piece::WhiteKing>().board() && !state.blackKingInCheck());
+static int lateMoveReduction(int depth, int moves) noexcept
+{
+	const std::size_t index{ static_cast<std::size_t>(std::min(depth, maxSearchDepth - 1) * lateMoveTableMoves + std::min(moves, lateMoveTableMoves - 1)) };
+	return lateMoveReductionsTable[index];
 }
 
+// the stop token is tested under the lock the destructor takes before notifying, so the last wake up can not be missed
 static void worker(std::stop_token token, std::mutex& mutex, std::condition_variable& cv, Engine& engine) noexcept
 {
-	while (!token.stop_requested())
+	while (true)
 	{
 		{
 			std::unique_lock lock(mutex);
 
-			cv.wait(lock);
+			cv.wait(lock, [&token, &engine]() {
+				return token.stop_requested() || engine.searching();
+				});
+
+			if (token.stop_requested()) return;
 		}
 
 		engine.searchRun();
@@ -186,50 +185,189 @@ static Move getCastleMove(int sourceSquare, int destinationSquare)
 
 //	Private Methods
 
-static thread_local std::uint32_t logCounter{};
-int Engine::search(const State& state, int color, int depth, int alpha, int beta) noexcept
+int Engine::search(SearchThread& thread, State& state, int color, int depth, int remainingDepth, int alpha, int beta) noexcept
 {
-	++m_nodeCount;
+	if (remainingDepth <= 0 || depth >= maxSearchDepth - 1)
+	{
+		return quiescence(thread, state, color, depth, alpha, beta);
+	}
 
-	if (!(logCounter & 0x00100000)) logSearchInfo();
-	++logCounter;
+	countNode(thread);
+	thread.principalVariationLengths[depth] = depth;
+	thread.keyStack[thread.rootKeyIndex + static_cast<std::size_t>(depth)] = state.hash();
 
-	if (depth == m_currentSearchDepth || m_stopSearch.load(std::memory_order_relaxed))
+	if (depth > 0 && (drawn(thread, state, depth) || Endgame::kingPawnDraw(state, color > 0))) return 0;
+
+	if (m_stopSearch.load(std::memory_order_relaxed))
+	{
+		return color * evaluate(state, color > 0, thread.pawnTable, thread.materialTable);
+	}
+
+	const int alphaOriginal{ alpha };
+	Move hashMove{ 0 };
+	TranspositionTable::Entry entry{};
+
+	if (m_transpositionTable.probe(state.hash(), entry))
+	{
+		hashMove = entry.move;
+
+		//the root always searches so the principal variation and best move are filled in
+		if (depth > 0 && entry.depth >= remainingDepth)
+		{
+			const int score{ scoreFromTable(entry.score, depth) };
+
+			if (entry.bound == TranspositionTable::Bound::Exact
+				|| (entry.bound == TranspositionTable::Bound::Lower && score >= beta)
+				|| (entry.bound == TranspositionTable::Bound::Upper && score <= alpha))
+			{
+				return score;
+			}
+		}
+	}
+
+	const bool white{ color > 0 };
+	const bool inCheck{ white ? state.whiteKingInCheck() : state.blackKingInCheck() };
+	const bool pvNode{ beta - alpha > 1 };
+	const int staticEvaluation{ inCheck ? worstValue : color * evaluate(state, color > 0, thread.pawnTable, thread.materialTable) };
+
+	//pruning decisions are never taken at the root, in check, in principal variation nodes or against mate scores
+	const bool canPrune{ depth > 0 && !inCheck && !pvNode && std::abs(beta) < checkmateThreshold };
+
+	//reverse futility, the position is so far above beta that a shallow search is not going to bring it back down
+	if (futilityPruning && canPrune && remainingDepth <= futilityDepth 
+		&& staticEvaluation - reverseFutilityMargin * remainingDepth >= beta)
 	{
-		return color * evaluate(state);
+		return staticEvaluation;
 	}
 
-	MoveList moves{ MoveGen::generateMoves(color > 0, state) };
-	moves.sort(m_killerMoves.killerMoves(depth), m_principalVariation[depth]);
+	//null move, if passing the turn still fails high a real move will too, except in zugzwang which is rare while the 
+	//side to move has pieces and checked for with a reduced search when it has little of them
+	const int material{ nonPawnMaterial(state, white) };
+
+	if (nullMovePruning && canPrune && !thread.verifyingNullMove && remainingDepth >= nullMoveMinimumDepth 
+		&& material > 0 && staticEvaluation >= beta && thread.moveStack[depth - 1].move())
+	{
+		const int reduction{ nullMoveReduction + remainingDepth / 4 };
+		thread.moveStack[depth] = Move{ 0 };
+
+		SearchState child{ state };
+		const State::Undo undo{ child.makeNullMove() };
+		int score{ -search(thread, child, -color, depth + 1, remainingDepth - 1 - reduction, -beta, -beta + 1) };
+		takeBackNullMove(child, undo);
+
+		if (score >= beta && material <= nullMoveVerificationMaterial)
+		{
+			thread.verifyingNullMove = true;
+			score = search(thread, state, color, depth, remainingDepth - 1 - reduction, beta - 1, beta);
+			thread.verifyingNullMove = false;
+		}
+
+		if (score >= beta && !m_stopSearch.load(std::memory_order_relaxed))
+		{
+			return score >= checkmateThreshold ? beta : score;
+		}
+	}
+
+	//along the best line of the previous iteration its moves go first, the table entry may have been replaced since
+	if (followingPrincipalVariation(thread, depth) && thread.principalVariation[depth].move())
+	{
+		hashMove = thread.principalVariation[depth];
+	}
+
+	//a verification search at this ply may have left a line behind
+	thread.principalVariationLengths[depth] = depth;
+
+	const ContinuationMoves continuation{ depth > 0 ? thread.moveStack[depth - 1] : Move{ 0 }, depth > 1 ? thread.moveStack[depth - 2] : Move{ 0 } };
+	MovePicker picker{ state, white, hashMove, thread.killerMoves.killerMoves(depth), thread.history, continuation };
 
-	int legalMoves{};
 	int bestScore{ worstValue };
-	Move bestMove{};
+	Move bestMove{ 0 };
+	int movesSearched{ 0 };
+	MoveList failedQuiets;
 
-	for (Move move : moves) 
+	for (Move move{ picker.next() }; move.move(); move = picker.next())
 	{
-		State stateCopy{ state };
+		++movesSearched;
+		thread.moveStack[depth] = move;
 
-		if (makeLegalMove(stateCopy, move, color > 0))
+		const bool quiet{ move.attackPiece() == Piece::NoPiece && move.promotePiece() == Piece::NoPiece };
+
+		//futility, near the leaves a quiet move can not make up for a static evaluation this far below alpha
+		if (futilityPruning && canPrune && quiet && movesSearched > 1 && remainingDepth <= futilityDepth
+			&& staticEvaluation + futilityMargin * remainingDepth <= alpha)
 		{
-			++legalMoves;
-			const int score{ -search(stateCopy, -color, depth + 1, -beta, -alpha) };
-			bestMove = score > bestScore ? move : bestMove;
-			bestScore = std::max(bestScore, score);
-			alpha = std::max(alpha, score);
+			continue;
+		}
 
-			if (alpha >= beta)
+		SearchState child{ state };
+		const State::Undo undo{ child.makeMove(white, move) };
+		const bool givesCheck{ white ? child.blackKingInCheck() : child.whiteKingInCheck() };
+
+		//principal variation search, only the first move gets the full window, the rest only have to prove they are no 
+		//better and are searched again when they are
+		int score{ 0 };
+
+		if (movesSearched == 1)
+		{
+			score = -search(thread, child, -color, depth + 1, remainingDepth - 1, -beta, -alpha);
+		}
+		else
+		{
+			//late move reductions, quiet moves this far down the ordering rarely raise alpha so they are searched 
+			//shallower first and only searched to full depth when they surprise
+			int reduction{ 0 };
+
+			if (lateMoveReductions && !inCheck && !givesCheck && quiet && remainingDepth >= lateMoveMinimumDepth 
+				&& movesSearched >= lateMoveMinimumMoves)
+			{
+				reduction = lateMoveReduction(remainingDepth, movesSearched) - static_cast<int>(pvNode);
+				reduction = std::clamp(reduction, 0, remainingDepth - 2);
+			}
+
+			score = -search(thread, child, -color, depth + 1, remainingDepth - 1 - reduction, -alpha - 1, -alpha);
+
+			if (reduction > 0 && score > alpha)
+			{
+				score = -search(thread, child, -color, depth + 1, remainingDepth - 1, -alpha - 1, -alpha);
+			}
+
+			if (score > alpha && score < beta)
+			{
+				score = -search(thread, child, -color, depth + 1, remainingDepth - 1, -beta, -alpha);
+			}
+		}
+
+		takeBackMove(child, move, white, undo);
+
+		bestMove = score > bestScore ? move : bestMove;
+		bestScore = std::max(bestScore, score);
+
+		if (score > alpha)
+		{
+			alpha = score;
+			updatePrincipalVariation(thread, depth, move);
+		}
+
+		if (alpha >= beta)
+		{
+			thread.killerMoves.push(depth, move);
+
+			if (move.attackPiece() == Piece::NoPiece)
 			{
-				m_killerMoves.push(depth, move);
-				break;
+				thread.history.update(white, move, { failedQuiets.begin(), failedQuiets.end() }, continuation, remainingDepth);
 			}
+
+			break;
 		}
+
+		if (move.attackPiece() == Piece::NoPiece) failedQuiets.push(move);
 	}
 
-	if (legalMoves == 0)
+	//the generator only returns legal moves so an empty list is checkmate or stalemate
+	if (movesSearched == 0)
 	{
 		//check for white or black checkmate
-		if (color > 0 ? state.whiteKingInCheck() : state.blackKingInCheck())
+		if (inCheck)
 		{
 			return checkmateScore + depth;
 		}
@@ -240,38 +378,271 @@ int Engine::search(const State& state, int color, int depth, int alpha, int beta
 	}
 	else
 	{
-		m_principalVariation[depth] = bestMove;
+		//scores from an interrupted search are not trustworthy
+		if (!m_stopSearch.load(std::memory_order_relaxed))
+		{
+			const TranspositionTable::Bound bound{ bestScore >= beta
+				? TranspositionTable::Bound::Lower
+				: bestScore > alphaOriginal ? TranspositionTable::Bound::Exact : TranspositionTable::Bound::Upper };
+
+			m_transpositionTable.store(state.hash(), bestMove, scoreToTable(bestScore, depth), remainingDepth, bound);
+		}
+
 		return bestScore;
 	}
 }
 
+int Engine::quiescence(SearchThread& thread, State& state, int color, int depth, int alpha, int beta) noexcept
+{
+	countNode(thread);
+
+	if (depth < maxSearchDepth) thread.principalVariationLengths[depth] = depth;
+
+	//stand pat, the side to move is assumed to have at least one move as good as doing nothing
+	const int standPat{ color * evaluate(state, color > 0, thread.pawnTable, thread.materialTable) };
+
+	if (standPat >= beta || depth >= maxSearchDepth || m_stopSearch.load(std::memory_order_relaxed))
+	{
+		return standPat;
+	}
+
+	alpha = std::max(alpha, standPat);
+
+	MovePicker picker{ state, color > 0 };
+
+	for (Move move{ picker.next() }; move.move(); move = picker.next())
+	{
+		//delta pruning, skip captures that can not raise alpha even if the captured piece comes for free
+		const int captureValue{ pieceValues[static_cast<std::size_t>(move.attackPiece())] };
+
+		if (move.promotePiece() == Piece::NoPiece && standPat + captureValue + deltaMargin <= alpha) continue;
+
+		SearchState child{ state };
+		const State::Undo undo{ child.makeMove(color > 0, move) };
+		const int score{ -quiescence(thread, child, -color, depth + 1, -beta, -alpha) };
+		takeBackMove(child, move, color > 0, undo);
+
+		if (score >= beta) return score;
+
+		alpha = std::max(alpha, score);
+	}
+
+	return alpha;
+}
+
+// search and quiescence nodes count down to the next poll alike, so a capture heavy tree can not run past the limits, the 
+// main thread polls the clock and the first iteration always finishes so there is a best move to play
+void Engine::countNode(SearchThread& thread) noexcept
+{
+	//only this thread writes its counter so a plain load and store is enough
+	thread.nodeCount.store(thread.nodeCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+	if (--thread.pollCountdown) return;
+
+	thread.pollCountdown = pollInterval;
+
+	if (&thread != m_searchThreads.front().get()) return;
+
+	logSearchInfo();
+
+	if (thread.completedDepth > 0 && m_timeManager.outOfTime(nodeCount())) m_stopSearch.store(true, std::memory_order_relaxed);
+}
+
+// mate scores are relative to the root, the table stores them relative to the node so they stay valid in transpositions
+int Engine::scoreToTable(int score, int depth) noexcept
+{
+	if (score >= checkmateThreshold) return score + depth;
+	if (score <= -checkmateThreshold) return score - depth;
+
+	return score;
+}
+
+int Engine::scoreFromTable(int score, int depth) noexcept
+{
+	if (score >= checkmateThreshold) return score - depth;
+	if (score <= -checkmateThreshold) return score + depth;
+
+	return score;
+}
+
+// searches the root in a window around the score of the previous iteration and widens the side that failed until the 
+// score lands inside, mate scores and shallow depths use the full window
+int Engine::aspirationSearch(SearchThread& thread, State& rootState, int depth) noexcept
+{
+	const int color{ m_currentWhiteToMove ? 1 : -1 };
+	const bool fullWindow{ depth < aspirationMinimumDepth || thread.completedDepth == 0 || std::abs(thread.score) >= checkmateThreshold };
+
+	int delta{ aspirationWindow };
+	int alpha{ fullWindow ? worstValue : thread.score - delta };
+	int beta{ fullWindow ? bestValue : thread.score + delta };
+
+	while (true)
+	{
+		const int score{ search(thread, rootState, color, 0, depth, alpha, beta) };
+
+		if (m_stopSearch.load(std::memory_order_relaxed) || (score > alpha && score < beta)) return score;
+
+		delta *= 2;
+
+		if (score <= alpha) alpha = delta > maxAspirationWindow ? worstValue : std::max(worstValue, score - delta);
+		if (score >= beta) beta = delta > maxAspirationWindow ? bestValue : std::min(bestValue, score + delta);
+	}
+}
+
+// the line below a node is the move that raised alpha followed by the line below that move's child, this keeps each ply's 
+// line in its own row so a later sibling can not overwrite the best line found so far
+void Engine::updatePrincipalVariation(SearchThread& thread, int depth, Move move) noexcept
+{
+	const std::size_t ply{ static_cast<std::size_t>(depth) };
+	const std::size_t childLength{ static_cast<std::size_t>(thread.principalVariationLengths[ply + 1]) };
+
+	PrincipalVariation& line{ thread.principalVariationTable[ply] };
+	const PrincipalVariation& childLine{ thread.principalVariationTable[ply + 1] };
+
+	line[ply] = move;
+	std::copy(childLine.begin() + ply + 1, childLine.begin() + std::max(childLength, ply + 1), line.begin() + ply + 1);
+	thread.principalVariationLengths[ply] = static_cast<int>(std::max(childLength, ply + 1));
+}
+
+bool Engine::followingPrincipalVariation(const SearchThread& thread, int depth) noexcept
+{
+	return std::equal(thread.moveStack.begin(), thread.moveStack.begin() + depth, thread.principalVariation.begin(), [](Move lhs, Move rhs) {
+		return lhs.move() == rhs.move();
+		});
+}
+
+// the game history and the search path share one key stack, a position is only compared with the positions since the last 
+// irreversible move or null move and with the same side to move, a single repetition inside the search already counts as a draw
+bool Engine::drawn(const SearchThread& thread, const State& state, int depth) noexcept
+{
+	if (state.halfmoveClock() >= fiftyMoveRulePlies) return true;
+
+	const std::size_t index{ thread.rootKeyIndex + static_cast<std::size_t>(depth) };
+	const std::size_t reversible{ std::min({ index, static_cast<std::size_t>(state.halfmoveClock()), 
+		static_cast<std::size_t>(state.pliesSinceNullMove()) }) };
+
+	for (std::size_t back{ 4 }; back <= reversible; back += 2)
+	{
+		if (thread.keyStack[index - back] == state.hash()) return true;
+	}
+
+	return false;
+}
+
+// moves until mate from a score, positive when white mates like the evaluation, zero when the score is no mate
+int Engine::mateMoves(int score) noexcept
+{
+	if (score >= checkmateThreshold) return (-checkmateScore - score + 1) / 2;
+	if (score <= -checkmateThreshold) return -(-checkmateScore + score + 1) / 2;
+
+	return 0;
+}
+
+void Engine::iterativeDeepening(SearchThread& thread, int startDepth) noexcept
+{
+	const bool mainThread{ &thread == m_searchThreads.front().get() };
+
+	thread.killerMoves = KillerMoveHistory();
+	thread.history.clear();
+	thread.verifyingNullMove = false;
+	thread.keyStack = m_gameHistory;
+	thread.keyStack.resize(m_gameHistory.size() + maxSearchDepth);
+	thread.rootKeyIndex = m_gameHistory.size();
+	thread.principalVariation.fill(0);
+	thread.completedDepth = 0;
+	thread.pollCountdown = pollInterval;
+
+	//the search makes and unmakes moves on its own copy so m_currentState can still be read while searching
+	State rootState{ m_currentState };
+	rootState.setNetwork(&m_network);
+
+	for (int depth{ startDepth }; depth <= m_timeManager.depthLimit(); ++depth)
+	{
+		thread.currentSearchDepth = depth;
+		const int score{ aspirationSearch(thread, rootState, depth) };
+
+		if (m_stopSearch.load(std::memory_order_relaxed)) break;
+
+		thread.completedDepth = depth;
+		thread.score = score;
+
+		//only a finished iteration has a complete line, it is what the next iteration searches first
+		const std::span<const Move> line{ thread.principalVariationTable.front().begin(), 
+			static_cast<std::size_t>(thread.principalVariationLengths.front()) };
+
+		thread.principalVariation.fill(0);
+		std::ranges::copy(line, thread.principalVariation.begin());
+
+		if (mainThread)
+		{
+			m_bestMove = thread.principalVariation.front();
+			logIteration(depth, score, thread.principalVariation);
+
+			if (m_timeManager.iterationDone(depth, m_bestMove)) break;
+		}
+	}
+}
+
+// the reporter reads the search info from another thread, everything is computed first and only copied in under the lock
 void Engine::logSearchInfo() noexcept
 {
-	const clock::time_point now{ clock::now() };
-	const std::chrono::duration<float> elapsed{ now - m_searchStart };
+	const std::chrono::duration<float> elapsed{ std::max(m_timeManager.elapsed(), TimeManager::milliseconds{ 1 }) };
+	const std::uint64_t nodes{ nodeCount() };
+	const float timeRemaining{ static_cast<float>(m_timeManager.remaining().count()) };
+
+	std::lock_guard lock(m_mutex);
+
+	m_searchInfo.nodes = nodes;
+	m_searchInfo.nodesPerSecond = nodes / elapsed.count();
+	m_searchInfo.timeRemaining = timeRemaining;
+	m_newInfo = true;
+}
+
+// a completed iteration replaces the whole line and is queued, so a reader polling slower than the iterations finish still 
+// sees every depth, its score comes from the side to move and is reported from white's side
+void Engine::logIteration(int depth, int score, const PrincipalVariation& principalVariation) noexcept
+{
+	const std::chrono::duration<float> elapsed{ std::max(m_timeManager.elapsed(), TimeManager::milliseconds{ 1 }) };
+	const std::uint64_t nodes{ nodeCount() };
+	const int evaluation{ m_currentWhiteToMove ? score : -score };
+
+	SearchInfo info{ depth, evaluation, mateMoves(evaluation), nodes, nodes / elapsed.count(), 
+		static_cast<float>(m_timeManager.remaining().count()), Engine::principalVariation(principalVariation) };
+
+	std::lock_guard lock(m_mutex);
 
-	m_searchInfo.nodesPerSecond = m_nodeCount / elapsed.count();
-	m_searchInfo.timeRemaining = static_cast<float>(m_searchMilliseconds) - std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count();
-	m_newInfo.store(true, std::memory_order_release);
+	m_iterations.push_back(info);
+	m_searchInfo = std::move(info);
+	m_newInfo = true;
 }
 
-std::string_view Engine::principalVariation() noexcept
+std::uint64_t Engine::nodeCount() const noexcept
 {
-	m_pvString.clear();
+	std::uint64_t nodes{};
+
+	std::ranges::for_each(m_searchThreads, [&nodes](const std::unique_ptr<SearchThread>& thread) {
+		nodes += thread->nodeCount.load(std::memory_order_relaxed);
+		});
+
+	return nodes;
+}
+
+std::string Engine::principalVariation(const PrincipalVariation& principalVariation) noexcept
+{
+	std::string line;
 
 	const std::span<const Move> moves{
-		m_principalVariation.begin(), std::ranges::find_if(m_principalVariation, [](Move move) {
+		principalVariation.begin(), std::ranges::find_if(principalVariation, [](Move move) {
 			return !move.move();
 		})
 	};
 
-	std::ranges::for_each(moves, [this](Move move) {
-		const std::string moveString{ move.string() };
-		m_pvString.push(moveString);
-		m_pvString.push(",");
+	std::ranges::for_each(moves, [&line](Move move) {
+		line += move.string();
+		line += ',';
 		});
 
-	return m_pvString.view();
+	return line;
 }
 
 
@@ -280,10 +651,21 @@ std::string_view Engine::principalVariation() noexcept
 
 // constructors
 Engine::Engine() noexcept
-	: m_currentState(startState), m_currentLegalMoves(MoveGen::generateMoves(m_currentWhiteToMove, m_currentState)), m_worker(worker, std::ref(m_mutex), std::ref(m_cv), std::ref(*this)) { }
+	: m_currentState(startState), m_currentLegalMoves(MoveGen::generateMoves(m_currentWhiteToMove, m_currentState)), m_worker(worker, std::ref(m_mutex), std::ref(m_cv), std::ref(*this))
+{
+	setThreads(1);
+	loadNetwork(Nnue::defaultNetworkFile);
+}
 
 Engine::~Engine()
 {
+	stopSearch();
+	m_worker.request_stop();
+
+	{
+		std::lock_guard lock(m_mutex);
+	}
+
 	m_cv.notify_one();
 }
 
@@ -292,47 +674,92 @@ Engine::~Engine()
 //search
 void Engine::startSearch() noexcept
 {
-	if (m_stopSearch.load(std::memory_order_relaxed))
+	startSearch(TimeManager::Limits{ .moveTime = defaultMoveTime });
+}
+
+// the worker stores the stop flag and its result after the search ends, starting before it is idle would let those stores 
+// overwrite the new search
+void Engine::startSearch(const TimeManager::Limits& limits) noexcept
+{
+	stopSearch();
+
+	std::ranges::for_each(m_searchThreads, [](std::unique_ptr<SearchThread>& thread) {
+		thread->nodeCount.store(0, std::memory_order_relaxed);
+		});
+
 	{
-		m_nodeCount = 0;
-		m_searchStart = clock::now();
+		//taking the lock publishes the position and thread setup to the worker when it wakes up
+		std::lock_guard lock(m_mutex);
+
+		//a search stopped before its first iteration completes still has a legal move to play
+		m_bestMove = m_currentLegalMoves.size() ? m_currentLegalMoves[0] : Move{ 0 };
+		m_timeManager.start(limits);
+		m_searchInfo = SearchInfo{};
+		m_searchInfo.principalVariation = "no pv";
+		m_newInfo = true;
+		m_iterations.clear();
 		m_stopSearch.store(false, std::memory_order_relaxed);
-		m_cv.notify_one();
-
-		std::thread([](std::atomic_bool& stopSearch, int searchMilliseconds) {
-			std::this_thread::sleep_for(std::chrono::milliseconds(searchMilliseconds));
-			stopSearch.store(true, std::memory_order_relaxed);
-			}, std::ref(m_stopSearch), m_searchMilliseconds).detach();
+		m_searching.store(true, std::memory_order_relaxed);
 	}
+
+	m_cv.notify_all();
 }
 
 void Engine::stopSearch() noexcept
 {
+	std::unique_lock lock(m_mutex);
+
 	m_stopSearch.store(true, std::memory_order_relaxed);
+
+	m_cv.wait(lock, [this]() {
+		return !m_searching.load(std::memory_order_relaxed);
+		});
 }
 
+// Lazy SMP, every thread runs its own iterative deepening on the same position and they only share the transposition table.
+// Helpers with an odd index start one ply deeper so the threads spread over different depths.
 void Engine::searchRun() noexcept
 {
-	m_killerMoves = KillerMoveHistory();
-	m_principalVariation.fill(0);
+	m_transpositionTable.newSearch();
 
-	m_searchInfo.principalVariation = "no pv";
-	m_newInfo.store(true, std::memory_order_release);
+	std::vector<std::jthread> helpers;
+	helpers.reserve(m_searchThreads.size() - 1);
 
-	for (int depth{ 1 }; depth <= maxSearchDepth; ++depth)
+	for (std::size_t i{ 1 }; i < m_searchThreads.size(); ++i)
 	{
+		helpers.emplace_back([this, i]() {
+			iterativeDeepening(*m_searchThreads[i], 1 + static_cast<int>(i & 1));
+			});
+	}
 
-		m_currentSearchDepth = depth; //had the idea to use this variable in the for loop but apparently it is considered bad practice
-		const int score{ search(m_currentState, m_currentWhiteToMove ? 1 : -1, 0, worstValue, bestValue) };
+	iterativeDeepening(*m_searchThreads.front(), 1);
 
-		if (m_stopSearch.load(std::memory_order_relaxed)) break;
+	//the main thread decides when the search is over
+	m_stopSearch.store(true, std::memory_order_relaxed);
+	helpers.clear();
+
+	//the deepest completed iteration has the most trustworthy best move, ties go to the main thread
+	const auto best{ std::ranges::max_element(m_searchThreads, [](const std::unique_ptr<SearchThread>& a, const std::unique_ptr<SearchThread>& b) {
+		return a->completedDepth < b->completedDepth;
+		}) };
+
+	if ((*best)->completedDepth > m_searchThreads.front()->completedDepth)
+	{
+		const SearchThread& thread{ **best };
+
+		m_bestMove = thread.principalVariation.front();
+		logIteration(thread.completedDepth, thread.score, thread.principalVariation);
+	}
+
+	logSearchInfo();
 
-		m_bestMove = m_principalVariation.front();
-		m_searchInfo.depth = depth;
-		m_searchInfo.evaluation = m_currentWhiteToMove ? score : -score;
-		m_searchInfo.principalVariation = principalVariation();
-		m_newInfo.store(true, std::memory_order_release);
+	{
+		std::lock_guard lock(m_mutex);
+		m_searching.store(false, std::memory_order_release);
 	}
+
+	//wakes the threads waiting in stopSearch(), the worker itself goes back to sleep
+	m_cv.notify_all();
 }
 
 
@@ -340,10 +767,12 @@ void Engine::searchRun() noexcept
 //getters
 bool Engine::searchInfo(SearchInfo& info) noexcept
 {
-	if (m_newInfo.load(std::memory_order_acquire))
+	std::lock_guard lock(m_mutex);
+
+	if (m_newInfo)
 	{
 		info = m_searchInfo;
-		m_newInfo.store(false, std::memory_order_relaxed);
+		m_newInfo = false;
 
 		return true;
 	}
@@ -353,6 +782,18 @@ bool Engine::searchInfo(SearchInfo& info) noexcept
 	}
 }
 
+bool Engine::nextIteration(SearchInfo& info) noexcept
+{
+	std::lock_guard lock(m_mutex);
+
+	if (m_iterations.empty()) return false;
+
+	info = std::move(m_iterations.front());
+	m_iterations.pop_front();
+
+	return true;
+}
+
 std::string_view Engine::fenPosition() noexcept
 {
 	m_fenPosition = m_currentState.fenPosition();
@@ -367,7 +808,7 @@ std::string_view Engine::charPosition() noexcept
 
 Move Engine::bestMove() const noexcept
 {
-	if (m_stopSearch.load(std::memory_order_relaxed))
+	if (!searching())
 	{
 		return m_bestMove;
 	}
@@ -377,24 +818,86 @@ Move Engine::bestMove() const noexcept
 	}
 }
 
+bool Engine::searching() const noexcept
+{
+	return m_searching.load(std::memory_order_acquire);
+}
+
+bool Engine::whiteToMove() const noexcept
+{
+	return m_currentWhiteToMove;
+}
+
+int Engine::threads() const noexcept
+{
+	return static_cast<int>(m_searchThreads.size());
+}
+
 
 
 //setters
 void Engine::setStartState() noexcept
 {
 	m_currentState = startState;
+	m_currentWhiteToMove = true;
+	m_gameHistory.clear();
 	m_currentLegalMoves = MoveGen::generateMoves(m_currentWhiteToMove, m_currentState);
 }
 
+void Engine::setThreads(int threads) noexcept
+{
+	//threads can not be added or removed while they are searching
+	if (searching()) return;
+
+	m_searchThreads.resize(static_cast<std::size_t>(std::clamp(threads, 1, maxThreads)));
+
+	std::ranges::for_each(m_searchThreads, [](std::unique_ptr<SearchThread>& thread) {
+		if (!thread) thread = std::make_unique<SearchThread>();
+		});
+}
+
+void Engine::setHashSize(std::size_t megabytes)
+{
+	//the table can not be reallocated under the threads probing it
+	if (searching()) return;
+
+	m_transpositionTable.resize(megabytes);
+}
+
+void Engine::clearHash() noexcept
+{
+	if (searching()) return;
+
+	m_transpositionTable.clear();
+}
+
+bool Engine::loadNetwork(std::string_view path)
+{
+	if (searching()) return false;
+
+	Nnue network{ path };
+	const bool loaded{ network.loaded() };
+
+	if (loaded) m_network = std::move(network);
+
+	std::clog << (loaded ? "network loaded from " : "no network in ") << path 
+		<< (m_network.loaded() ? "\n" : ", evaluating with the piece-square tables\n");
+
+	return loaded;
+}
+
 void Engine::setPositionChar(std::string_view position) noexcept
 {
 	m_currentState = State::fromChar(position);
+	m_gameHistory.clear();
 	m_currentLegalMoves = MoveGen::generateMoves(m_currentWhiteToMove, m_currentState);
 }
 
 void Engine::setPositionFen(std::string_view position) noexcept
 {
 	m_currentState = State::fromFen(position);
+	m_currentWhiteToMove = State::fenWhiteToMove(position);
+	m_gameHistory.clear();
 	m_currentLegalMoves = MoveGen::generateMoves(m_currentWhiteToMove, m_currentState);
 }
 
@@ -406,13 +909,10 @@ bool Engine::move(bool white, int source, int destination) noexcept
 		   return (move.sourceIndex() == source && move.destinationIndex() == destination) || (move.move() == castleMove.move());
 	   }) };
 
-	State stateCopy{ m_currentState };
-
-	if (it == m_currentLegalMoves.end() || !makeLegalMove(stateCopy, *it, white)) return false;
-	
-	const Move move{ *it };
+	if (it == m_currentLegalMoves.end()) return false;
 
-	m_currentState = stateCopy;
+	m_gameHistory.push_back(m_currentState.hash());
+	m_currentState.makeMove(white, *it);
 	m_currentWhiteToMove = !white;
 	m_currentLegalMoves = MoveGen::generateMoves(m_currentWhiteToMove, m_currentState);
 
@@ -425,6 +925,7 @@ void Engine::moveUnchecked(bool white, int source, int destination) noexcept
 
 	if (castleMove.move())
 	{
+		m_gameHistory.push_back(m_currentState.hash());
 		m_currentState.makeMove(white, castleMove);
 	}
 
@@ -436,6 +937,22 @@ bool Engine::move(int source, int destination) noexcept
 	return move(m_currentWhiteToMove, source, destination);
 }
 
+bool Engine::move(std::string_view move) noexcept
+{
+	const auto it{ std::ranges::find_if(m_currentLegalMoves, [move](Move legal) {
+		return legal.string() == move;
+		}) };
+
+	if (it == m_currentLegalMoves.end()) return false;
+
+	m_gameHistory.push_back(m_currentState.hash());
+	m_currentState.makeMove(m_currentWhiteToMove, *it);
+	m_currentWhiteToMove = !m_currentWhiteToMove;
+	m_currentLegalMoves = MoveGen::generateMoves(m_currentWhiteToMove, m_currentState);
+
+	return true;
+}
+
 void Engine::moveUnchecked(int source, int destination) noexcept
 {
 	move(m_currentWhiteToMove, source, destination);
@@ -5,17 +5,26 @@
 #include <chrono>
 #include <condition_variable>
 #include <cstdint>
+#include <deque>
+#include <memory>
 #include <mutex>
+#include <string>
 #include <string_view>
 #include <thread>
+#include <vector>
 
 #include "ChessConstants.hpp"
 #include "KillerMoveHistory.h"
 #include "Move.h"
 #include "MoveGen.h"
+#include "MoveHistory.h"
+#include "MaterialTable.h"
 #include "MoveList.hpp"
-#include "StackString.hpp"
+#include "Nnue.h"
+#include "PawnTable.h"
 #include "State.h"
+#include "TimeManager.h"
+#include "TranspositionTable.h"
 
 
 
@@ -30,12 +39,51 @@ private:
 	static constexpr int worstValue{ -9999999 };
 	static constexpr int checkmateScore{ -999999 };
 	static constexpr int maxSearchDepth{ 50 };
-	static constexpr int maxMoveStringSize{ 5 };
+	static constexpr int checkmateThreshold{ -checkmateScore - maxSearchDepth };
+	static constexpr int deltaMargin{ 200 };
+	static constexpr int aspirationWindow{ 50 };
+	static constexpr int maxAspirationWindow{ 1000 };
+	static constexpr int aspirationMinimumDepth{ 4 };
+	static constexpr int nullMoveMinimumDepth{ 3 };
+	static constexpr int nullMoveReduction{ 2 };
+	static constexpr int nullMoveVerificationMaterial{ 500 };
+	static constexpr int lateMoveMinimumDepth{ 3 };
+	static constexpr int lateMoveMinimumMoves{ 4 };
+	static constexpr int futilityDepth{ 3 };
+	static constexpr int futilityMargin{ 150 };
+	static constexpr int reverseFutilityMargin{ 120 };
+	static constexpr int maxThreads{ 256 };
+	static constexpr int fiftyMoveRulePlies{ 100 };
+	static constexpr std::uint64_t pollInterval{ 2048 };
+	static constexpr TimeManager::milliseconds defaultMoveTime{ 500 };
 
 	//usings
-	using clock = std::chrono::high_resolution_clock;
 	using PrincipalVariation = std::array<Move, maxSearchDepth>;
-	using PrincipalVariationString = StackString<maxSearchDepth * maxMoveStringSize>;
+	using PrincipalVariationTable = std::array<PrincipalVariation, maxSearchDepth>;
+	using PrincipalVariationLengths = std::array<int, maxSearchDepth>;
+	using MoveStack = std::array<Move, maxSearchDepth>;
+
+	//types
+	// everything a search thread writes to while searching, only the transposition table is shared between threads
+	struct SearchThread
+	{
+		cachealign KillerMoveHistory killerMoves;
+		cachealign PrincipalVariation principalVariation;
+		cachealign PrincipalVariationTable principalVariationTable;
+		PrincipalVariationLengths principalVariationLengths;
+		cachealign MoveHistory history;
+		MoveStack moveStack;
+		PawnTable pawnTable;
+		MaterialTable materialTable;
+		std::vector<std::uint64_t> keyStack;
+		std::size_t rootKeyIndex;
+		std::atomic<std::uint64_t> nodeCount;
+		std::uint64_t pollCountdown;
+		int currentSearchDepth;
+		int completedDepth;
+		int score;
+		bool verifyingNullMove;
+	};
 
 
 
@@ -43,13 +91,16 @@ public:
 
 	//	Public Definitions
 
+	// a copy of what the search published last, the principal variation is owned by the copy
 	struct SearchInfo
 	{
 		int depth;
 		int evaluation;
+		int mate;
+		std::uint64_t nodes;
 		float nodesPerSecond;
 		float timeRemaining;
-		std::string_view principalVariation;
+		std::string principalVariation;
 	};
 
 
@@ -61,41 +112,67 @@ private:
 	//state
 	State m_currentState;
 	bool m_currentWhiteToMove{ true };
+	std::vector<std::uint64_t> m_gameHistory;
 	State::FenPosition m_fenPosition;
 	State::CharPosition m_charPosition;
 	MoveList m_currentLegalMoves{ MoveGen::generateMoves(m_currentWhiteToMove, m_currentState) };
 
-	//worker
+	//worker, the mutex also guards the search info
 	std::mutex m_mutex;
 	std::condition_variable m_cv;
-	std::jthread m_worker;
 
-	//search
-	cachealign KillerMoveHistory m_killerMoves;
-	cachealign PrincipalVariation m_principalVariation{};
-	int m_searchMilliseconds{ 500 };
-	int m_currentSearchDepth{};
+	//search, the search states point to the network so it is only replaced while the worker is idle
+	Nnue m_network;
+	TranspositionTable m_transpositionTable;
+	std::vector<std::unique_ptr<SearchThread>> m_searchThreads;
+	TimeManager m_timeManager;
 	std::atomic_bool m_stopSearch{ true };
+	std::atomic_bool m_searching{ false };
 
-	//info
+	//info, every completed iteration is queued until it is read
 	SearchInfo m_searchInfo{};
-	std::atomic_bool m_newInfo;
-	clock::time_point m_searchStart;
-	std::uint64_t m_nodeCount{};
-	PrincipalVariationString m_pvString{};
+	bool m_newInfo{ false };
+	std::deque<SearchInfo> m_iterations;
 	Move m_bestMove{ 0 };
 
+	//declared last, the worker starts in the constructor and reads the members above
+	std::jthread m_worker;
+
 
 
 private:
 
 	//	Private Methods
 
-	int search(const State& state, int color, int depth, int alpha, int beta) noexcept;
+	int search(SearchThread& thread, State& state, int color, int depth, int remainingDepth, int alpha, int beta) noexcept;
+
+	int quiescence(SearchThread& thread, State& state, int color, int depth, int alpha, int beta) noexcept;
+
+	void countNode(SearchThread& thread) noexcept;
+
+	int aspirationSearch(SearchThread& thread, State& rootState, int depth) noexcept;
+
+	static void updatePrincipalVariation(SearchThread& thread, int depth, Move move) noexcept;
+
+	static bool followingPrincipalVariation(const SearchThread& thread, int depth) noexcept;
+
+	static bool drawn(const SearchThread& thread, const State& state, int depth) noexcept;
+
+	static int mateMoves(int score) noexcept;
+
+	void iterativeDeepening(SearchThread& thread, int startDepth) noexcept;
+
+	static int scoreToTable(int score, int depth) noexcept;
+
+	static int scoreFromTable(int score, int depth) noexcept;
 
 	void logSearchInfo() noexcept;
+
+	void logIteration(int depth, int score, const PrincipalVariation& principalVariation) noexcept;
+
+	std::uint64_t nodeCount() const noexcept;
 	
-	std::string_view principalVariation() noexcept;
+	static std::string principalVariation(const PrincipalVariation& principalVariation) noexcept;
 
 
 
@@ -113,6 +190,10 @@ public:
 	//search
 	void startSearch() noexcept;
 
+	// a search that is still running is stopped first and the new one starts once the worker is idle
+	void startSearch(const TimeManager::Limits& limits) noexcept;
+
+	// returns once the worker is idle and the best move of the stopped search is final
 	void stopSearch() noexcept;
 
 	void searchRun() noexcept;
@@ -122,17 +203,36 @@ public:
 	//getters
 	bool searchInfo(SearchInfo& info) noexcept;
 
+	// takes the oldest completed iteration of the current search that was not read yet, false once there is none
+	bool nextIteration(SearchInfo& info) noexcept;
+
 	std::string_view fenPosition() noexcept;
 
 	std::string_view charPosition() noexcept;
 
 	Move bestMove() const noexcept;
 
+	bool searching() const noexcept;
+
+	bool whiteToMove() const noexcept;
+
+	int threads() const noexcept;
+
 
 
 	//setters
 	void setStartState() noexcept;
 
+	void setThreads(int threads) noexcept;
+
+	void setHashSize(std::size_t megabytes);
+
+	void clearHash() noexcept;
+
+	// a network file as Nnue reads it, the old network is kept if the file can not be read and without any the evaluation 
+	// falls back to the piece-square tables
+	bool loadNetwork(std::string_view path);
+
 	void setPositionFen(std::string_view position) noexcept;
 
 	void setPositionChar(std::string_view position) noexcept;
@@ -143,5 +243,8 @@ public:
 
 	bool move(int source, int destination) noexcept;
 
+	// a move in coordinate notation as Move::string() writes it, e.g. e2e4 or e7e8q
+	bool move(std::string_view move) noexcept;
+
 	void moveUnchecked(int source, int destination) noexcept;
 };
\ No newline at end of file
@@ -1,38 +1,323 @@
 #include "Evaluate.h"
 
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
 
+#include "BitBoard.h"
+#include "ChessConstants.hpp"
+#include "Endgame.h"
+#include "MaterialTable.h"
+#include "Nnue.h"
+#include "PawnTable.h"
+#include "PieceSquare.h"
 
-static int pieceEvaluation(const State& state) noexcept
+
+
+//	Static Helpers
+
+static constexpr std::uint64_t fileA{ 0x0101010101010101ULL };
+static constexpr std::uint64_t fileH{ fileA << 7 };
+
+static constexpr TaperedScore doubledPenalty{ -10, -20 };
+static constexpr TaperedScore isolatedPenalty{ -10, -15 };
+static constexpr TaperedScore backwardPenalty{ -8, -10 };
+static constexpr std::array<TaperedScore, rankSize> passedBonus{ { { 0, 0 }, { 5, 10 }, { 10, 15 }, { 15, 25 }, { 30, 45 }, { 50, 80 }, { 80, 130 }, { 0, 0 } } };
+static constexpr std::array<int, rankSize> freePassedBonus{ 0, 0, 5, 10, 20, 35, 60, 0 };
+static constexpr int shieldBonus{ 12 };
+static constexpr TaperedScore bishopPairBonus{ 30, 50 };
+static constexpr int knightPawnBonus{ 4 };
+static constexpr int rookPawnPenalty{ 6 };
+static constexpr int imbalancePawns{ 5 };
+static constexpr int drawishScale{ 16 };
+static constexpr int oppositeBishopsScale{ 32 };
+static constexpr int minorValue{ 3 };
+static constexpr int rookValue{ 5 };
+static constexpr int queenValue{ 9 };
+
+static std::uint64_t northFill(std::uint64_t squares) noexcept
+{
+	squares |= squares << 8;
+	squares |= squares << 16;
+	return squares | squares << 32;
+}
+
+static std::uint64_t southFill(std::uint64_t squares) noexcept
+{
+	squares |= squares >> 8;
+	squares |= squares >> 16;
+	return squares | squares >> 32;
+}
+
+static std::uint64_t adjacentFiles(std::uint64_t squares) noexcept
+{
+	return ((squares & ~fileH) << 1) | ((squares & ~fileA) >> 1);
+}
+
+template<bool white>
+static std::uint64_t forward(std::uint64_t squares) noexcept
+{
+	return white ? squares << 8 : squares >> 8;
+}
+
+template<bool white>
+static std::uint64_t frontFill(std::uint64_t squares) noexcept
+{
+	return white ? northFill(squares) : southFill(squares);
+}
+
+template<bool white>
+static std::uint64_t pawnAttacks(std::uint64_t pawns) noexcept
+{
+	return white 
+		? ((pawns & ~fileA) << 7) | ((pawns & ~fileH) << 9)
+		: ((pawns & ~fileA) >> 9) | ((pawns & ~fileH) >> 7);
+}
+
+template<bool white>
+static int relativeRank(int square) noexcept
+{
+	return white ? square / fileSize : rankSize - 1 - square / fileSize;
+}
+
+static void addScore(TaperedScore& score, TaperedScore term, int count) noexcept
+{
+	score.middlegame += term.middlegame * count;
+	score.endgame += term.endgame * count;
+}
+
+// the structure terms of one side, they only depend on the pawns so they are cached in the pawn table
+template<bool white>
+static TaperedScore pawnStructure(std::uint64_t pawns, std::uint64_t enemyPawns, BitBoard& passed) noexcept
+{
+	TaperedScore score{};
+
+	const std::uint64_t files{ northFill(pawns) | southFill(pawns) };
+	const std::uint64_t isolated{ pawns & ~adjacentFiles(files) };
+
+	//only the rear pawn of a doubled pair is counted, it is also the one that can never become passed
+	const std::uint64_t doubled{ pawns & frontFill<!white>(forward<!white>(pawns)) };
+
+	//no pawn of its own beside or behind it can come up to defend it and an enemy pawn holds the square in front
+	const std::uint64_t defendable{ adjacentFiles(frontFill<white>(pawns)) };
+	const std::uint64_t backward{ pawns & ~defendable & ~isolated & forward<!white>(pawnAttacks<!white>(enemyPawns)) };
+
+	const std::uint64_t enemySpan{ frontFill<!white>(forward<!white>(enemyPawns)) };
+	passed = BitBoard(pawns & ~doubled & ~(enemySpan | adjacentFiles(enemySpan)));
+
+	addScore(score, doubledPenalty, std::popcount(doubled));
+	addScore(score, isolatedPenalty, std::popcount(isolated));
+	addScore(score, backwardPenalty, std::popcount(backward));
+
+	for (BitBoard remaining{ passed }; remaining.board();)
+	{
+		addScore(score, passedBonus[relativeRank<white>(remaining.popLeastSignificantBit())], 1);
+	}
+
+	return score;
+}
+
+static PawnTable::Entry evaluatePawns(const State& state) noexcept
+{
+	const std::uint64_t whitePawns{ state.pieceOccupancyT<Piece::WhitePawn>().board() };
+	const std::uint64_t blackPawns{ state.pieceOccupancyT<Piece::BlackPawn>().board() };
+
+	PawnTable::Entry entry{ state.pawnHash(), TaperedScore{}, BitBoard(), BitBoard() };
+	const TaperedScore white{ pawnStructure<true>(whitePawns, blackPawns, entry.whitePassed) };
+	const TaperedScore black{ pawnStructure<false>(blackPawns, whitePawns, entry.blackPassed) };
+
+	entry.score = { white.middlegame - black.middlegame, white.endgame - black.endgame };
+
+	return entry;
+}
+
+// the pieces of one side counted from a material key
+struct SideMaterial
+{
+	int pawns;
+	int knights;
+	int bishops;
+	int rooks;
+	int queens;
+};
+
+template<bool white>
+static SideMaterial sideMaterial(std::uint64_t key) noexcept
 {
-	constexpr int pawnValue{ 100 };
-	constexpr int knightValue{ 300 };
-	constexpr int bishopValue{ 300 };
-	constexpr int rookValue{ 500 };
-	constexpr int queenValue{ 900 };
+	return SideMaterial{
+		State::materialCount(key, white ? Piece::WhitePawn : Piece::BlackPawn),
+		State::materialCount(key, white ? Piece::WhiteKnight : Piece::BlackKnight),
+		State::materialCount(key, white ? Piece::WhiteBishop : Piece::BlackBishop),
+		State::materialCount(key, white ? Piece::WhiteRook : Piece::BlackRook),
+		State::materialCount(key, white ? Piece::WhiteQueen : Piece::BlackQueen) };
+}
+
+static int pieceMaterial(const SideMaterial& side) noexcept
+{
+	return (side.knights + side.bishops) * minorValue + side.rooks * rookValue + side.queens * queenValue;
+}
+
+static bool bare(const SideMaterial& side) noexcept
+{
+	return side.pawns == 0 && pieceMaterial(side) == 0;
+}
+
+// without pawns a single minor piece or two knights can not force mate
+static bool cannotMate(const SideMaterial& side) noexcept
+{
+	const bool noMajors{ side.rooks == 0 && side.queens == 0 };
+
+	return side.pawns == 0 && noMajors && (side.knights + side.bishops <= 1 || (side.knights == 2 && side.bishops == 0));
+}
+
+// knights get better and rooks worse as the board fills with pawns
+static TaperedScore imbalance(const SideMaterial& side) noexcept
+{
+	const int pairBonus{ side.bishops >= 2 ? 1 : 0 };
+	const int pawnAdjustment{ (side.knights * knightPawnBonus - side.rooks * rookPawnPenalty) * (side.pawns - imbalancePawns) };
+
+	return { bishopPairBonus.middlegame * pairBonus + pawnAdjustment, bishopPairBonus.endgame * pairBonus + pawnAdjustment };
+}
 
-	const int evaluation{
-		static_cast<int>(state.pieceOccupancyT<Piece::WhitePawn>().bitCount()) * pawnValue
-		+ static_cast<int>(state.pieceOccupancyT<Piece::WhiteKnight>().bitCount()) * knightValue
-		+ static_cast<int>(state.pieceOccupancyT<Piece::WhiteBishop>().bitCount()) * bishopValue
-		+ static_cast<int>(state.pieceOccupancyT<Piece::WhiteRook>().bitCount()) * rookValue
-		+ static_cast<int>(state.pieceOccupancyT<Piece::WhiteQueen>().bitCount()) * queenValue
-		- static_cast<int>(state.pieceOccupancyT<Piece::BlackPawn>().bitCount()) * pawnValue
-		- static_cast<int>(state.pieceOccupancyT<Piece::BlackKnight>().bitCount()) * knightValue
-		- static_cast<int>(state.pieceOccupancyT<Piece::BlackBishop>().bitCount()) * bishopValue
-		- static_cast<int>(state.pieceOccupancyT<Piece::BlackRook>().bitCount()) * rookValue
-		- static_cast<int>(state.pieceOccupancyT<Piece::BlackQueen>().bitCount()) * queenValue
-	};
+// a side without pawns that is at most a minor piece ahead rarely wins
+static std::uint8_t scale(const SideMaterial& side, const SideMaterial& other) noexcept
+{
+	const bool drawish{ side.pawns == 0 && pieceMaterial(side) - pieceMaterial(other) <= minorValue };
 
-	return evaluation;
+	return static_cast<std::uint8_t>(drawish ? drawishScale : MaterialTable::normalScale);
 }
 
-static int spaceEvaluation(const State& state)
+static MaterialTable::Entry evaluateMaterial(std::uint64_t key) noexcept
 {
-	return static_cast<int>(state.whiteSquares().bitCount() - state.blackSquares().bitCount());
+	const SideMaterial white{ sideMaterial<true>(key) };
+	const SideMaterial black{ sideMaterial<false>(key) };
+	const TaperedScore whiteImbalance{ imbalance(white) };
+	const TaperedScore blackImbalance{ imbalance(black) };
+
+	MaterialTable::Entry entry{ key, TaperedScore{}, MaterialTable::Evaluator::General, true, false, MaterialTable::normalScale, 
+		MaterialTable::normalScale };
+	entry.imbalance = { whiteImbalance.middlegame - blackImbalance.middlegame, whiteImbalance.endgame - blackImbalance.endgame };
+	entry.strongWhite = pieceMaterial(white) + white.pawns >= pieceMaterial(black) + black.pawns;
+	entry.whiteScale = scale(white, black);
+	entry.blackScale = scale(black, white);
+	entry.oppositeBishops = white.bishops == 1 && black.bishops == 1 && pieceMaterial(white) == minorValue && pieceMaterial(black) == minorValue;
+
+	const SideMaterial& strong{ entry.strongWhite ? white : black };
+	const SideMaterial& weak{ entry.strongWhite ? black : white };
+
+	if (cannotMate(white) && cannotMate(black))
+	{
+		entry.evaluator = MaterialTable::Evaluator::Draw;
+	}
+	else if (bare(weak) && strong.pawns == 0 && strong.knights == 1 && strong.bishops == 1 && strong.rooks == 0 && strong.queens == 0)
+	{
+		entry.evaluator = MaterialTable::Evaluator::BishopKnight;
+	}
+	else if (bare(weak) && (strong.queens > 0 || strong.rooks > 0 || (strong.pawns == 0 && strong.bishops >= 2 && strong.knights == 0)))
+	{
+		entry.evaluator = MaterialTable::Evaluator::LoneKing;
+	}
+	else if (bare(weak) && strong.pawns == 1 && pieceMaterial(strong) == 0)
+	{
+		entry.evaluator = MaterialTable::Evaluator::KingPawn;
+	}
+	else
+	{
+		entry.evaluator = MaterialTable::Evaluator::General;
+	}
+
+	return entry;
 }
 
-int evaluate(const State& state) noexcept
+static bool oppositeBishops(const State& state) noexcept
 {
-	return pieceEvaluation(state) + spaceEvaluation(state);
+	const int white{ state.pieceOccupancyT<Piece::WhiteBishop>().leastSignificantBit() };
+	const int black{ state.pieceOccupancyT<Piece::BlackBishop>().leastSignificantBit() };
+
+	return ((white / fileSize + white % fileSize) % 2) != ((black / fileSize + black % fileSize) % 2);
 }
 
+// pawns on the three files around the king one and two ranks in front of it, only worth something in the middlegame
+template<bool white>
+static int kingShield(std::uint64_t king, std::uint64_t pawns) noexcept
+{
+	const std::uint64_t front{ forward<white>(king) | forward<white>(forward<white>(king)) };
+
+	return std::popcount(pawns & (front | adjacentFiles(front))) * shieldBonus;
+}
+
+// passed pawns the pieces have not blocked yet, the part of the passed pawn evaluation that the pawn table can not hold
+template<bool white>
+static int freePassedPawns(BitBoard passed, std::uint64_t occupancy) noexcept
+{
+	int bonus{};
+
+	for (BitBoard free{ passed.board() & forward<!white>(~occupancy) }; free.board();)
+	{
+		bonus += freePassedBonus[relativeRank<white>(free.popLeastSignificantBit())];
+	}
+
+	return bonus;
+}
+
+
+
+//known endgames are handled by their own evaluators, otherwise the tables are summed by State on every move and the pawn 
+//structure and material imbalance come from their tables, all that is left is blending the two phases, a loaded network 
+//replaces everything but the known endgames
+int evaluate(const State& state, bool whiteToMove, PawnTable& pawnTable, MaterialTable& materialTable) noexcept
+{
+	MaterialTable::Entry& material{ materialTable.entry(state.materialKey()) };
+
+	if (material.key != state.materialKey())
+	{
+		material = evaluateMaterial(state.materialKey());
+	}
+
+	switch (material.evaluator)
+	{
+	case MaterialTable::Evaluator::Draw: return 0;
+	case MaterialTable::Evaluator::LoneKing: return Endgame::loneKing(state, material.strongWhite);
+	case MaterialTable::Evaluator::BishopKnight: return Endgame::bishopKnight(state, material.strongWhite);
+	case MaterialTable::Evaluator::KingPawn: return Endgame::kingPawn(state, material.strongWhite, whiteToMove);
+	case MaterialTable::Evaluator::General: break;
+	}
+
+	if (const Nnue* network{ state.network() })
+	{
+		const int score{ network->evaluate(state.accumulator(), whiteToMove) };
+		return whiteToMove ? score : -score;
+	}
+
+	PawnTable::Entry& pawns{ pawnTable.entry(state.pawnHash()) };
+
+	if (pawns.key != state.pawnHash())
+	{
+		pawns = evaluatePawns(state);
+	}
+
+	const std::uint64_t occupancy{ state.occupancy().board() };
+	TaperedScore score{ state.score() };
+
+	addScore(score, pawns.score, 1);
+	addScore(score, material.imbalance, 1);
+
+	score.middlegame += kingShield<true>(state.pieceOccupancyT<Piece::WhiteKing>().board(), state.pieceOccupancyT<Piece::WhitePawn>().board())
+		- kingShield<false>(state.pieceOccupancyT<Piece::BlackKing>().board(), state.pieceOccupancyT<Piece::BlackPawn>().board());
+
+	score.endgame += freePassedPawns<true>(pawns.whitePassed, occupancy) - freePassedPawns<false>(pawns.blackPassed, occupancy);
+
+	int endgameScale{ score.endgame > 0 ? material.whiteScale : material.blackScale };
+
+	if (material.oppositeBishops && oppositeBishops(state))
+	{
+		endgameScale = std::min(endgameScale, oppositeBishopsScale);
+	}
+
+	score.endgame = score.endgame * endgameScale / MaterialTable::normalScale;
+
+	const int phase{ std::min(state.phase(), PieceSquare::maxPhase) };
+
+	return (score.middlegame * phase + score.endgame * (PieceSquare::maxPhase - phase)) / PieceSquare::maxPhase;
+}
\ No newline at end of file
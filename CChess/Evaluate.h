@@ -1,7 +1,9 @@
 #pragma once
 
 #include "State.h"
+#include "PawnTable.h"
+#include "MaterialTable.h"
 
 
 
-int evaluate(const State& state) noexcept;
\ No newline at end of file
+int evaluate(const State& state, bool whiteToMove, PawnTable& pawnTable, MaterialTable& materialTable) noexcept;
\ No newline at end of file
@@ -1,11 +1,19 @@
 #include <iostream>
 #include <string_view>
 #include <chrono>
+#include <cstdlib>
+#include <span>
+#include <thread>
 
 
+#include "Bitbase.h"
 #include "Engine.h"
+#include "Nnue.h"
+#include "Perft.h"
+#include "PerftTable.h"
 #include "State.h"
 #include "PreGen.h"
+#include "Uci.h"
 
 //TODO: renaming and namespaces
 //TODO: for build -> performace guided optimization
@@ -13,7 +21,70 @@
 constexpr std::string_view startFen{ "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR" };
 constexpr std::string_view debugFen{ "Q7/4k3/7Q/8/8/3N4/2NK4/8" }; //Castle::None
 
-int main()
+int main(int argc, char* argv[])
 {
-	Engine engine;
+	const std::span<char*> arguments{ argv, static_cast<std::size_t>(argc) };
+	const std::string_view mode{ arguments.size() > 1 ? arguments[1] : "" };
+
+	//CChess perft [depth] [threads] checks the standard positions, CChess divide [depth] [threads] splits the start position
+	//CChess hashperft [depth] [threads] [megabytes] [file] memoizes subtrees, in a memory mapped file if one is given
+	if (mode == "perft" || mode == "divide" || mode == "hashperft")
+	{
+		const int depth{ arguments.size() > 2 ? std::atoi(arguments[2]) : 5 };
+		const int threads{ arguments.size() > 3 ? std::atoi(arguments[3]) : static_cast<int>(std::thread::hardware_concurrency()) };
+
+		if (mode == "perft") return Perft::benchmark(std::cout, depth, threads) ? EXIT_SUCCESS : EXIT_FAILURE;
+
+		if (mode == "hashperft")
+		{
+			const std::size_t megabytes{ arguments.size() > 4 ? static_cast<std::size_t>(std::atoll(arguments[4])) : PerftTable::defaultMegabytes };
+			PerftTable table{ megabytes };
+
+			if (arguments.size() > 5 && !table.map(arguments[5], megabytes))
+			{
+				std::cout << "could not map " << arguments[5] << ", using memory\n";
+			}
+
+			return Perft::benchmark(std::cout, depth, threads, table) ? EXIT_SUCCESS : EXIT_FAILURE;
+		}
+
+		const State state{ startFen, Castle::All };
+		Perft::printDivide(std::cout, Perft::run(state, true, depth, threads));
+
+		return EXIT_SUCCESS;
+	}
+
+	//CChess sliders compares the magic and pext slider lookups
+	if (mode == "sliders")
+	{
+		PreGen::benchmarkSliders(std::cout);
+		return EXIT_SUCCESS;
+	}
+
+	//CChess kpk rebuilds the king and pawn bitbase and compares it with the built in table
+	if (mode == "kpk")
+	{
+		return Bitbase::verify(std::cout) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	//CChess nnue [file] measures the evaluations per second of a network, the default network file without one
+	if (mode == "nnue")
+	{
+		const std::string_view file{ arguments.size() > 2 ? arguments[2] : Nnue::defaultNetworkFile };
+
+		const Nnue network{ file };
+
+		if (!network.loaded())
+		{
+			std::cout << "no network in " << file << '\n';
+			return EXIT_FAILURE;
+		}
+
+		network.benchmark(std::cout);
+		return EXIT_SUCCESS;
+	}
+
+	//without a mode CChess is a uci engine on the console
+	Uci uci{ std::cin, std::cout };
+	return uci.loop();
 }
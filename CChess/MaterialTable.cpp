@@ -0,0 +1,37 @@
+#include "MaterialTable.h"
+
+#include <bit>
+#include <cstdint>
+#include <vector>
+
+
+
+//	Static Helpers
+
+static constexpr int indexShift{ 64 - std::countr_zero(MaterialTable::entryCount) };
+
+static_assert(std::has_single_bit(MaterialTable::entryCount), "the material table size has to be a power of two");
+
+// material keys are packed counts and differ only in a few low bits, multiplying spreads them over the whole table
+static constexpr std::uint64_t keyMultiplier{ 0x9E3779B97F4A7C15ULL };
+
+// bare kings have the key zero, so empty slots need a key no position can have
+static constexpr std::uint64_t emptyKey{ ~0ULL };
+
+
+
+//	Public Methods
+
+//constructors
+MaterialTable::MaterialTable()
+	: m_entries(entryCount, Entry{ emptyKey, TaperedScore{}, Evaluator::General, true, false, normalScale, normalScale })
+{
+}
+
+
+
+//getters
+MaterialTable::Entry& MaterialTable::entry(std::uint64_t key) noexcept
+{
+	return m_entries[(key * keyMultiplier) >> indexShift];
+}
\ No newline at end of file
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "PieceSquare.h"
+
+
+
+// cache of everything evaluate() derives from the material balance alone, keyed by State::materialKey(), one per 
+// search thread like the pawn table, it picks a specialised evaluator for the endgames the general formula gets wrong
+class MaterialTable
+{
+public:
+
+	//	Public Definitions
+
+	//types
+	enum class Evaluator : std::uint8_t
+	{
+		General,
+		Draw,
+		LoneKing,
+		BishopKnight,
+		KingPawn
+	};
+
+	struct Entry
+	{
+		std::uint64_t key;
+		TaperedScore imbalance;
+		Evaluator evaluator;
+		bool strongWhite;
+		// one bishop each and no other pieces, the bishop squares decide if they are of opposite colors
+		bool oppositeBishops;
+		// out of MaterialTable::normalScale, applied to the endgame score of the side it belongs to when it is ahead
+		std::uint8_t whiteScale;
+		std::uint8_t blackScale;
+	};
+
+	//constants
+	static constexpr std::size_t entryCount{ 8192 };
+	static constexpr int normalScale{ 64 };
+
+
+
+private:
+
+	//	Private Members
+
+	std::vector<Entry> m_entries;
+
+
+
+public:
+
+	//	Public Methods
+
+	//constructors
+	MaterialTable();
+
+
+
+	//getters
+	// the slot the key maps to, a different key means the caller has to evaluate the material and fill it in
+	Entry& entry(std::uint64_t key) noexcept;
+};
\ No newline at end of file
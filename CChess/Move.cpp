@@ -62,10 +62,19 @@ std::string Move::string() const
 	}
 	else
 	{
+		//promotions end in the lower case piece letter like coordinate notation expects
+		constexpr std::array<char, pieceCount> promoteToChar{ ' ', ' ', 'n', 'b', 'r', 'q', ' ', ' ', 'n', 'b', 'r', 'q', ' ' };
+
 		std::string move;
-		move.reserve(4);
+		move.reserve(5);
 		move.append(squareToRF[sourceIndex()]);
 		move.append(squareToRF[destinationIndex()]);
+
+		if (promotePiece() != Piece::NoPiece)
+		{
+			move.push_back(promoteToChar[static_cast<std::size_t>(promotePiece())]);
+		}
+
 		return move;
 	}
 }
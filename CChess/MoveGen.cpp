@@ -1,5 +1,6 @@
 #include "MoveGen.h"
 
+#include <algorithm>
 #include <cstdint>
 
 #include "PreGen.h"
@@ -11,6 +12,10 @@ static cachealign PreGen preGen;
 
 
 
+using LegalMasks = MoveGen::LegalMasks;
+
+
+
 template<bool white>
 static BitBoard pawnDoublesMask(BitBoard pawns) noexcept
 {
@@ -58,16 +63,186 @@ static BitBoard pawnShiftedMoves(BitBoard pawns, std::uint64_t mask) noexcept
 
 
 
+//ATTACKS
 template<bool white>
-static void pawnPromotes(BitBoard pawns, MoveList& moveList, const State& state) noexcept
+static std::uint64_t attackers(int square, std::uint64_t occupancy, const State& state) noexcept
 {
+	constexpr Piece pawn{ white ? Piece::WhitePawn : Piece::BlackPawn };
+	constexpr Piece knight{ white ? Piece::WhiteKnight : Piece::BlackKnight };
+	constexpr Piece bishop{ white ? Piece::WhiteBishop : Piece::BlackBishop };
+	constexpr Piece rook{ white ? Piece::WhiteRook : Piece::BlackRook };
 	constexpr Piece queen{ white ? Piece::WhiteQueen : Piece::BlackQueen };
+	constexpr Piece king{ white ? Piece::WhiteKing : Piece::BlackKing };
+
+	const BitBoard pawnAttacks{ white ? preGen.blackPawnAttack(square) : preGen.whitePawnAttack(square) };
+	const std::uint64_t queens{ state.pieceOccupancyT<queen>().board() };
+
+	return (pawnAttacks.board() & state.pieceOccupancyT<pawn>().board())
+		| (preGen.knightMove(square).board() & state.pieceOccupancyT<knight>().board())
+		| (preGen.kingMove(square).board() & state.pieceOccupancyT<king>().board())
+		| (preGen.bishopMove(square, occupancy).board() & (state.pieceOccupancyT<bishop>().board() | queens))
+		| (preGen.rookMove(square, occupancy).board() & (state.pieceOccupancyT<rook>().board() | queens));
+}
+
+template<bool white>
+static bool squareAttacked(int square, std::uint64_t occupancy, const State& state) noexcept
+{
+	constexpr Piece pawn{ white ? Piece::WhitePawn : Piece::BlackPawn };
 	constexpr Piece knight{ white ? Piece::WhiteKnight : Piece::BlackKnight };
 	constexpr Piece bishop{ white ? Piece::WhiteBishop : Piece::BlackBishop };
 	constexpr Piece rook{ white ? Piece::WhiteRook : Piece::BlackRook };
+	constexpr Piece queen{ white ? Piece::WhiteQueen : Piece::BlackQueen };
+	constexpr Piece king{ white ? Piece::WhiteKing : Piece::BlackKing };
+
+	//a square is attacked by a piece if the same piece standing on the square would attack it back
+	const BitBoard pawnAttacks{ white ? preGen.blackPawnAttack(square) : preGen.whitePawnAttack(square) };
+
+	if (pawnAttacks.board() & state.pieceOccupancyT<pawn>().board()) return true;
+	if (preGen.knightMove(square).board() & state.pieceOccupancyT<knight>().board()) return true;
+	if (preGen.kingMove(square).board() & state.pieceOccupancyT<king>().board()) return true;
+
+	const std::uint64_t queens{ state.pieceOccupancyT<queen>().board() };
+	const std::uint64_t diagonals{ state.pieceOccupancyT<bishop>().board() | queens };
+	const std::uint64_t straights{ state.pieceOccupancyT<rook>().board() | queens };
+
+	if (diagonals && (preGen.bishopMove(square, occupancy).board() & diagonals)) return true;
+
+	return straights && (preGen.rookMove(square, occupancy).board() & straights);
+}
+
+template<bool white>
+static bool squareAttacked(int square, const State& state) noexcept
+{
+	return squareAttacked<white>(square, state.occupancy().board(), state);
+}
+
+template<bool white, typename... Squares>
+static bool squaresAttacked(const State& state, Squares... squares) noexcept
+{
+	return (squareAttacked<white>(squares, state) || ...);
+}
+
+template<bool white>
+static BitBoard attackedSquares(const State& state) noexcept
+{
 	constexpr Piece pawn{ white ? Piece::WhitePawn : Piece::BlackPawn };
+	constexpr Piece knight{ white ? Piece::WhiteKnight : Piece::BlackKnight };
+	constexpr Piece bishop{ white ? Piece::WhiteBishop : Piece::BlackBishop };
+	constexpr Piece rook{ white ? Piece::WhiteRook : Piece::BlackRook };
+	constexpr Piece queen{ white ? Piece::WhiteQueen : Piece::BlackQueen };
+	constexpr Piece king{ white ? Piece::WhiteKing : Piece::BlackKing };
+
+	std::uint64_t squares{};
+
+	BitBoard pawns{ state.pieceOccupancyT<pawn>() };
+	BitBoard knights{ state.pieceOccupancyT<knight>() };
+	BitBoard diagonals{ state.pieceOccupancyT<bishop>().board() | state.pieceOccupancyT<queen>().board() };
+	BitBoard straights{ state.pieceOccupancyT<rook>().board() | state.pieceOccupancyT<queen>().board() };
 
-	BitBoard shiftedPawns{ pawnShiftedMoves<white>(pawns, ~state.occupancy().board()) };
+	while (pawns.board())
+	{
+		const int index{ pawns.popLeastSignificantBit() };
+		squares |= white ? preGen.whitePawnAttack(index).board() : preGen.blackPawnAttack(index).board();
+	}
+
+	while (knights.board())
+	{
+		const int index{ knights.popLeastSignificantBit() };
+		squares |= preGen.knightMove(index).board();
+	}
+
+	while (diagonals.board())
+	{
+		const int index{ diagonals.popLeastSignificantBit() };
+		squares |= preGen.bishopMove(index, state.occupancy()).board();
+	}
+
+	while (straights.board())
+	{
+		const int index{ straights.popLeastSignificantBit() };
+		squares |= preGen.rookMove(index, state.occupancy()).board();
+	}
+
+	squares |= preGen.kingMove(state.pieceOccupancyT<king>().leastSignificantBit()).board();
+
+	return BitBoard(squares);
+}
+
+
+
+template<bool white>
+static LegalMasks legalMasks(const State& state) noexcept
+{
+	constexpr Piece king{ white ? Piece::WhiteKing : Piece::BlackKing };
+	constexpr Piece enemyBishop{ white ? Piece::BlackBishop : Piece::WhiteBishop };
+	constexpr Piece enemyRook{ white ? Piece::BlackRook : Piece::WhiteRook };
+	constexpr Piece enemyQueen{ white ? Piece::BlackQueen : Piece::WhiteQueen };
+
+	const int kingIndex{ state.pieceOccupancyT<king>().leastSignificantBit() };
+	const std::uint64_t occupancy{ state.occupancy().board() };
+	const std::uint64_t ownOccupancy{ white ? state.whiteOccupancy().board() : state.blackOccupancy().board() };
+	const BitBoard checkers{ attackers<!white>(kingIndex, occupancy, state) };
+
+	//no check allows every square, one check allows capturing or blocking the checker, double check allows no square
+	std::uint64_t checkMask{ ~0ULL };
+
+	if (checkers.board())
+	{
+		const int checkerIndex{ checkers.leastSignificantBit() };
+		checkMask = checkers.bitCount() > 1 ? 0 : checkers.board() | preGen.between(kingIndex, checkerIndex).board();
+	}
+
+	//a piece is pinned if it is the only piece between the king and an enemy slider on an empty board ray
+	const std::uint64_t enemyQueens{ state.pieceOccupancyT<enemyQueen>().board() };
+	BitBoard snipers{ (preGen.bishopMove(kingIndex, BitBoard()).board() & (state.pieceOccupancyT<enemyBishop>().board() | enemyQueens))
+		| (preGen.rookMove(kingIndex, BitBoard()).board() & (state.pieceOccupancyT<enemyRook>().board() | enemyQueens)) };
+
+	std::uint64_t pinned{};
+
+	while (snipers.board())
+	{
+		const int sniperIndex{ snipers.popLeastSignificantBit() };
+		const BitBoard blockers{ preGen.between(kingIndex, sniperIndex).board() & occupancy };
+
+		if (blockers.bitCount() == 1)
+		{
+			pinned |= blockers.board() & ownOccupancy;
+		}
+	}
+
+	return LegalMasks{ checkers.board(), checkMask, pinned, kingIndex };
+}
+
+// pinned pieces may only move along the line through their king
+static std::uint64_t targetMask(const LegalMasks& masks, int sourceIndex) noexcept
+{
+	const bool pinned{ static_cast<bool>(masks.pinned & (1ULL << sourceIndex)) };
+
+	return pinned ? masks.checkMask & preGen.line(masks.kingIndex, sourceIndex).board() : masks.checkMask;
+}
+
+// enpassant removes two pieces from one rank so it is tested by replaying the occupancy, which also covers discovered checks
+template<bool white>
+static bool enpassantLegal(int sourceIndex, int destinationIndex, int enpassantIndex, const LegalMasks& masks, const State& state) noexcept
+{
+	const std::uint64_t captured{ 1ULL << enpassantIndex };
+	const std::uint64_t occupancy{ (state.occupancy().board() & ~(1ULL << sourceIndex) & ~captured) | (1ULL << destinationIndex) };
+
+	return !(attackers<!white>(masks.kingIndex, occupancy, state) & ~captured);
+}
+
+
+
+template<bool white>
+static void pawnPromotes(BitBoard pawns, MoveList& moveList, const State& state, std::uint64_t mask) noexcept
+{
+	constexpr Piece queen{ white ? Piece::WhiteQueen : Piece::BlackQueen };
+	constexpr Piece knight{ white ? Piece::WhiteKnight : Piece::BlackKnight };
+	constexpr Piece bishop{ white ? Piece::WhiteBishop : Piece::BlackBishop };
+	constexpr Piece rook{ white ? Piece::WhiteRook : Piece::BlackRook };
+	constexpr Piece pawn{ white ? Piece::WhitePawn : Piece::BlackPawn };
+
+	BitBoard shiftedPawns{ pawnShiftedMoves<white>(pawns, ~state.occupancy().board() & mask) };
 
 	while (shiftedPawns.board())
 	{
@@ -84,9 +259,9 @@ static void pawnPromotes(BitBoard pawns, MoveList& moveList, const State& state)
 	{
 		const int sourceIndex{ pawns.popLeastSignificantBit() };
 
-		BitBoard pawnAttacks{ white
+		BitBoard pawnAttacks{ mask & (white
 			? (preGen.whitePawnAttack(sourceIndex).board() & state.blackOccupancy().board())
-			: (preGen.blackPawnAttack(sourceIndex).board() & state.whiteOccupancy().board()) };
+			: (preGen.blackPawnAttack(sourceIndex).board() & state.whiteOccupancy().board())) };
 
 		while (pawnAttacks.board())
 		{
@@ -102,11 +277,11 @@ static void pawnPromotes(BitBoard pawns, MoveList& moveList, const State& state)
 }
 
 template<bool white>
-static void pawnDoubles(BitBoard pawns, MoveList& moveList, const State& state) noexcept 
+static void pawnDoubles(BitBoard pawns, MoveList& moveList, const State& state, std::uint64_t mask) noexcept 
 {
-	const std::uint64_t mask{ ~state.occupancy().board() };
-	const BitBoard pawnsShiftedOnce{ pawnShiftedMoves<white>(pawns, mask) }; 
-	BitBoard pawnsShiftedTwice{ pawnShiftedMoves<white>(pawnsShiftedOnce, mask) };
+	const std::uint64_t empty{ ~state.occupancy().board() };
+	const BitBoard pawnsShiftedOnce{ pawnShiftedMoves<white>(pawns, empty) }; 
+	BitBoard pawnsShiftedTwice{ pawnShiftedMoves<white>(pawnsShiftedOnce, empty & mask) };
 
 	while (pawnsShiftedTwice.board())
 	{
@@ -118,7 +293,7 @@ static void pawnDoubles(BitBoard pawns, MoveList& moveList, const State& state)
 }
 
 template<bool white>
-static void pawnEnpassants(BitBoard pawns, MoveList& moveList, const State& state) noexcept
+static void pawnEnpassants(BitBoard pawns, MoveList& moveList, const State& state, const LegalMasks& masks) noexcept
 {
 	constexpr Piece sourcePiece{ white ? Piece::WhitePawn : Piece::BlackPawn };
 	constexpr Piece attackPiece{ white ? Piece::BlackPawn : Piece::WhitePawn };
@@ -135,18 +310,22 @@ static void pawnEnpassants(BitBoard pawns, MoveList& moveList, const State& stat
 		while (attacks.board())
 		{
 			const int attackIndex{ attacks.popLeastSignificantBit() };
+			const int enpassantIndex{ white ? attackIndex - 8 : attackIndex + 8 };
 
-			moveList.pushEnpassant<sourcePiece, attackPiece>(sourceIndex, attackIndex, white ? attackIndex - 8 : attackIndex + 8);
+			if (enpassantLegal<white>(sourceIndex, attackIndex, enpassantIndex, masks, state))
+			{
+				moveList.pushEnpassant<sourcePiece, attackPiece>(sourceIndex, attackIndex, enpassantIndex);
+			}
 		}
 	}
 }
 
 template<bool white>
-static void pawnNormals(BitBoard pawns, MoveList& moveList, const State& state) noexcept
+static void pawnNormals(BitBoard pawns, MoveList& moveList, const State& state, std::uint64_t mask) noexcept
 {
 	constexpr Piece pawn{ white ? Piece::WhitePawn : Piece::BlackPawn };
 
-	BitBoard shiftedPawns{ pawnShiftedMoves<white>(pawns, ~state.occupancy().board()) };
+	BitBoard shiftedPawns{ pawnShiftedMoves<white>(pawns, ~state.occupancy().board() & mask) };
 
 	//quiets
 	while (shiftedPawns.board())
@@ -162,9 +341,9 @@ static void pawnNormals(BitBoard pawns, MoveList& moveList, const State& state)
 	{
 		const int sourceIndex{ pawns.popLeastSignificantBit() };
 
-		BitBoard attack{ white 
+		BitBoard attack{ mask & (white 
 			? preGen.whitePawnAttack(sourceIndex).board() & state.blackOccupancy().board()
-			: preGen.blackPawnAttack(sourceIndex).board() & state.whiteOccupancy().board() };
+			: preGen.blackPawnAttack(sourceIndex).board() & state.whiteOccupancy().board()) };
 
 		while (attack.board())
 		{
@@ -177,30 +356,50 @@ static void pawnNormals(BitBoard pawns, MoveList& moveList, const State& state)
 }
 
 template<bool white>
-static void pawnMoves(BitBoard pawns, MoveList& moveList, const State& state) noexcept
+static void pawnMoves(BitBoard pawns, MoveList& moveList, const State& state, std::uint64_t mask) noexcept
 {
 	const BitBoard pawnPromoteMoves(pawnPromotesMask<white>(pawns));
 	const BitBoard pawnDoubleMoves(pawnDoublesMask<white>(pawns));
-	const BitBoard pawnEnpassantMoves(pawnEnpassantsMask<white>(pawns));
 	const BitBoard pawnNormalMoves(pawns.board() & ~pawnPromoteMoves.board());
 
-	pawnPromotes<white>(pawnPromoteMoves, moveList, state);
-	pawnDoubles<white>(pawnDoubleMoves, moveList, state);
-	pawnEnpassants<white>(pawnEnpassantMoves, moveList, state);
-	pawnNormals<white>(pawnNormalMoves, moveList, state);
+	pawnPromotes<white>(pawnPromoteMoves, moveList, state, mask);
+	pawnDoubles<white>(pawnDoubleMoves, moveList, state, mask);
+	pawnNormals<white>(pawnNormalMoves, moveList, state, mask);
+}
+
+template<bool white, bool captures = true>
+static void pawnMoves(BitBoard pawns, MoveList& moveList, const State& state, const LegalMasks& masks) noexcept
+{
+	//unpinned pawns share one mask and are generated together, pinned pawns each get their own line
+	BitBoard pinnedPawns{ pawns.board() & masks.pinned };
+	pawnMoves<white>(BitBoard(pawns.board() & ~masks.pinned), moveList, state, masks.checkMask);
+
+	while (pinnedPawns.board())
+	{
+		const int sourceIndex{ pinnedPawns.popLeastSignificantBit() };
+		pawnMoves<white>(BitBoard(1ULL << sourceIndex), moveList, state, targetMask(masks, sourceIndex));
+	}
+
+	if constexpr (captures)
+	{
+		pawnEnpassants<white>(pawnEnpassantsMask<white>(pawns), moveList, state, masks);
+	}
 }
 
 
 
 template<bool white>
-static void knightMoves(BitBoard knights, MoveList& moveList, const State& state) noexcept
+static void knightMoves(BitBoard knights, MoveList& moveList, const State& state, const LegalMasks& masks) noexcept
 {
 	constexpr Piece knight{ white ? Piece::WhiteKnight : Piece::BlackKnight };
 
+	//a pinned knight can never stay on its line
+	knights = BitBoard(knights.board() & ~masks.pinned);
+
 	while (knights.board())
 	{
 		const int sourceIndex{ knights.popLeastSignificantBit() };
-		const std::uint64_t knightMoves{ preGen.knightMove(sourceIndex).board() };
+		const std::uint64_t knightMoves{ preGen.knightMove(sourceIndex).board() & masks.checkMask };
 
 		BitBoard quiets{ knightMoves & ~state.occupancy().board() };
 		BitBoard attacks{ knightMoves & (white ? state.blackOccupancy().board() : state.whiteOccupancy().board()) };
@@ -228,9 +427,8 @@ static void kingCastles(MoveList& moveList, const State& state) noexcept
 		if (state.castleWhiteKingSide())
 		{
 			constexpr std::uint64_t castleOccupancyMask = (1ULL << 5) | (1ULL << 6); // f1, g1
-			constexpr std::uint64_t castleAttackMask = (1ULL << 4) | (1ULL << 5) | (1ULL << 6); // e1, f1, g1
 
-			if (!(state.occupancy().board() & castleOccupancyMask) && !(state.blackSquares().board() & castleAttackMask))
+			if (!(state.occupancy().board() & castleOccupancyMask) && !squaresAttacked<false>(state, e1, f1, g1))
 			{
 				moveList.pushCastle<Castle::WhiteKingSide>();
 			}
@@ -239,9 +437,8 @@ static void kingCastles(MoveList& moveList, const State& state) noexcept
 		if (state.castleWhiteQueenSide())
 		{
 			constexpr std::uint64_t castleOccupancyMask = (1ULL << 1) | (1ULL << 2) | (1ULL << 3); // b1, c1, d1
-			constexpr std::uint64_t castleAttackMask = (1ULL << 2) | (1ULL << 3) | (1ULL << 4); // c1, d1, e1
 
-			if (!(state.occupancy().board() & castleOccupancyMask) && !(state.blackSquares().board() & castleAttackMask))
+			if (!(state.occupancy().board() & castleOccupancyMask) && !squaresAttacked<false>(state, c1, d1, e1))
 			{
 				moveList.pushCastle<Castle::WhiteQueenSide>();
 			}
@@ -252,9 +449,8 @@ static void kingCastles(MoveList& moveList, const State& state) noexcept
 		if (state.castleBlackKingSide())
 		{
 			constexpr std::uint64_t castleOccupancyMask = (1ULL << 61) | (1ULL << 62); // f8, g8
-			constexpr std::uint64_t castleAttackMask = (1ULL << 60) | (1ULL << 61) | (1ULL << 62); // e8, f8, g8
 
-			if (!(state.occupancy().board() & castleOccupancyMask) && !(state.whiteSquares().board() & castleAttackMask))
+			if (!(state.occupancy().board() & castleOccupancyMask) && !squaresAttacked<true>(state, e8, f8, g8))
 			{
 				moveList.pushCastle<Castle::BlackKingSide>();
 			}
@@ -263,9 +459,8 @@ static void kingCastles(MoveList& moveList, const State& state) noexcept
 		if (state.castleBlackQueenSide())
 		{
 			constexpr std::uint64_t castleOccupancyMask = (1ULL << 57) | (1ULL << 58) | (1ULL << 59); // b8, c8, d8
-			constexpr std::uint64_t castleAttackMask = (1ULL << 58) | (1ULL << 59) | (1ULL << 60); // c8, d8, e8
 
-			if (!(state.occupancy().board() & castleOccupancyMask) && !(state.whiteSquares().board() & castleAttackMask))
+			if (!(state.occupancy().board() & castleOccupancyMask) && !squaresAttacked<true>(state, c8, d8, e8))
 			{
 				moveList.pushCastle<Castle::BlackQueenSide>();
 			}
@@ -273,42 +468,56 @@ static void kingCastles(MoveList& moveList, const State& state) noexcept
 	}
 }
 
-template<bool white>
-static void kingMoves(BitBoard kings, MoveList& moveList, const State& state) noexcept
+template<bool white, bool captures = true>
+static void kingMoves(BitBoard kings, MoveList& moveList, const State& state, const LegalMasks& masks) noexcept
 {
 	constexpr Piece king{ white ? Piece::WhiteKing : Piece::BlackKing };
 
 	const int sourceIndex{ kings.leastSignificantBit() };
 	const BitBoard kingMoves{ preGen.kingMove(sourceIndex) };
 
+	//the king is lifted off the board so sliders see through the square it is moving away from
+	const std::uint64_t occupancy{ state.occupancy().board() & ~(1ULL << sourceIndex) };
+
 	BitBoard quiets{ kingMoves.board() & ~state.occupancy().board() };
-	BitBoard attacks{ kingMoves.board() & (white ? state.blackOccupancy().board() : state.whiteOccupancy().board())};
+	BitBoard attacks{ captures ? kingMoves.board() & (white ? state.blackOccupancy().board() : state.whiteOccupancy().board()) : 0 };
 
 	while (quiets.board())
 	{
 		const int destinationIndex{ quiets.popLeastSignificantBit() };
-		moveList.pushQuiet<king>(sourceIndex, destinationIndex);
+
+		if (!squareAttacked<!white>(destinationIndex, occupancy, state))
+		{
+			moveList.pushQuiet<king>(sourceIndex, destinationIndex);
+		}
 	}
 
 	while (attacks.board())
 	{
 		const int attackIndex{ attacks.popLeastSignificantBit() };
-		const Piece attackPiece{ state.findPiece<!white>(attackIndex) };
-		moveList.pushAttack<king>(attackPiece, sourceIndex, attackIndex);
+
+		if (!squareAttacked<!white>(attackIndex, occupancy, state))
+		{
+			const Piece attackPiece{ state.findPiece<!white>(attackIndex) };
+			moveList.pushAttack<king>(attackPiece, sourceIndex, attackIndex);
+		}
 	}
 
-	kingCastles<white>(moveList, state);
+	if (!masks.checkers)
+	{
+		kingCastles<white>(moveList, state);
+	}
 }
 
 template<bool white>
-static void bishopMoves(BitBoard bishops, MoveList& moveList, const State& state) noexcept
+static void bishopMoves(BitBoard bishops, MoveList& moveList, const State& state, const LegalMasks& masks) noexcept
 {
 	constexpr Piece bishop{ white ? Piece::WhiteBishop : Piece::BlackBishop };
 
 	while (bishops.board())
 	{
 		const int sourceIndex{ bishops.popLeastSignificantBit() };
-		const BitBoard bishopMoves{ preGen.bishopMove(sourceIndex, state.occupancy()) };
+		const BitBoard bishopMoves{ preGen.bishopMove(sourceIndex, state.occupancy()).board() & targetMask(masks, sourceIndex) };
 
 		BitBoard quiets{ bishopMoves.board() & ~state.occupancy().board() };
 		BitBoard attacks{ bishopMoves.board() & (white ? state.blackOccupancy().board() : state.whiteOccupancy().board()) };
@@ -329,14 +538,14 @@ static void bishopMoves(BitBoard bishops, MoveList& moveList, const State& state
 }
 
 template<bool white>
-static void rookMoves(BitBoard rooks, MoveList& moveList, const State& state) noexcept
+static void rookMoves(BitBoard rooks, MoveList& moveList, const State& state, const LegalMasks& masks) noexcept
 {
 	constexpr Piece rook{ white ? Piece::WhiteRook : Piece::BlackRook };
 
 	while (rooks.board())
 	{
 		const int sourceIndex{ rooks.popLeastSignificantBit() };
-		const BitBoard rookMoves{ preGen.rookMove(sourceIndex, state.occupancy()) };
+		const BitBoard rookMoves{ preGen.rookMove(sourceIndex, state.occupancy()).board() & targetMask(masks, sourceIndex) };
 
 		BitBoard quiets{ rookMoves.board() & ~state.occupancy().board() };
 		BitBoard attacks{ rookMoves.board() & (white ? state.blackOccupancy().board() : state.whiteOccupancy().board()) };
@@ -358,14 +567,14 @@ static void rookMoves(BitBoard rooks, MoveList& moveList, const State& state) no
 }
 
 template<bool white>
-static void queenMoves(BitBoard queens, MoveList& moveList, const State& state) noexcept
+static void queenMoves(BitBoard queens, MoveList& moveList, const State& state, const LegalMasks& masks) noexcept
 {
 	constexpr Piece queen{ white ? Piece::WhiteQueen : Piece::BlackQueen };
 
 	while (queens.board())
 	{
 		const int sourceIndex{ queens.popLeastSignificantBit() };
-		const BitBoard queenMoves{ preGen.bishopMove(sourceIndex, state.occupancy()).board() | preGen.rookMove(sourceIndex, state.occupancy()).board() };
+		const BitBoard queenMoves{ (preGen.bishopMove(sourceIndex, state.occupancy()).board() | preGen.rookMove(sourceIndex, state.occupancy()).board()) & targetMask(masks, sourceIndex) };
 
 		BitBoard quiets{ queenMoves.board() & ~state.occupancy().board() };
 		BitBoard attacks{ queenMoves.board() & (white ? state.blackOccupancy().board() : state.whiteOccupancy().board()) };
@@ -390,7 +599,7 @@ static void queenMoves(BitBoard queens, MoveList& moveList, const State& state)
 
 //CAPTURE MOVES
 template<bool white>
-static void pawnPromoteCaptures(BitBoard pawns, CaptureList& captureList, const State& state) noexcept
+static void pawnPromoteCaptures(BitBoard pawns, CaptureList& captureList, const State& state, std::uint64_t mask) noexcept
 {
 	constexpr Piece queen{ white ? Piece::WhiteQueen : Piece::BlackQueen };
 	constexpr Piece knight{ white ? Piece::WhiteKnight : Piece::BlackKnight };
@@ -402,9 +611,9 @@ static void pawnPromoteCaptures(BitBoard pawns, CaptureList& captureList, const
 	{
 		const int sourceIndex{ pawns.popLeastSignificantBit() };
 
-		BitBoard pawnAttacks{ white
+		BitBoard pawnAttacks{ mask & (white
 			? (preGen.whitePawnAttack(sourceIndex).board() & state.blackOccupancy().board())
-			: (preGen.blackPawnAttack(sourceIndex).board() & state.whiteOccupancy().board()) };
+			: (preGen.blackPawnAttack(sourceIndex).board() & state.whiteOccupancy().board())) };
 
 		while (pawnAttacks.board())
 		{
@@ -420,7 +629,7 @@ static void pawnPromoteCaptures(BitBoard pawns, CaptureList& captureList, const
 }
 
 template<bool white>
-static void pawnNormalCaptures(BitBoard pawns, CaptureList& captureList, const State& state) noexcept
+static void pawnNormalCaptures(BitBoard pawns, CaptureList& captureList, const State& state, std::uint64_t mask) noexcept
 {
 	constexpr Piece pawn{ white ? Piece::WhitePawn : Piece::BlackPawn };
 
@@ -429,9 +638,9 @@ static void pawnNormalCaptures(BitBoard pawns, CaptureList& captureList, const S
 	{
 		const int sourceIndex{ pawns.popLeastSignificantBit() };
 
-		BitBoard attack{ white
+		BitBoard attack{ mask & (white
 			? preGen.whitePawnAttack(sourceIndex).board() & state.blackOccupancy().board()
-			: preGen.blackPawnAttack(sourceIndex).board() & state.whiteOccupancy().board() };
+			: preGen.blackPawnAttack(sourceIndex).board() & state.whiteOccupancy().board()) };
 
 		while (attack.board())
 		{
@@ -444,7 +653,7 @@ static void pawnNormalCaptures(BitBoard pawns, CaptureList& captureList, const S
 }
 
 template<bool white>
-static void pawnEnpassants(BitBoard pawns, CaptureList& captureList, const State& state) noexcept
+static void pawnEnpassants(BitBoard pawns, CaptureList& captureList, const State& state, const LegalMasks& masks) noexcept
 {
 	constexpr Piece sourcePiece{ white ? Piece::WhitePawn : Piece::BlackPawn };
 	constexpr Piece attackPiece{ white ? Piece::BlackPawn : Piece::WhitePawn };
@@ -461,33 +670,52 @@ static void pawnEnpassants(BitBoard pawns, CaptureList& captureList, const State
 		while (attacks.board())
 		{
 			const int attackIndex{ attacks.popLeastSignificantBit() };
+			const int enpassantIndex{ white ? attackIndex - 8 : attackIndex + 8 };
 
-			captureList.pushEnpassant<sourcePiece, attackPiece>(sourceIndex, attackIndex, white ? attackIndex - 8 : attackIndex + 8);
+			if (enpassantLegal<white>(sourceIndex, attackIndex, enpassantIndex, masks, state))
+			{
+				captureList.pushEnpassant<sourcePiece, attackPiece>(sourceIndex, attackIndex, enpassantIndex);
+			}
 		}
 	}
 }
 
 template<bool white>
-static void pawnCaptures(BitBoard pawns, CaptureList& captureList, const State& state) noexcept
+static void pawnCaptures(BitBoard pawns, CaptureList& captureList, const State& state, std::uint64_t mask) noexcept
 {
 	const BitBoard pawnPromoteMoves(pawnPromotesMask<white>(pawns));
-	const BitBoard pawnEnpassantMoves(pawnEnpassantsMask<white>(pawns));
 	const BitBoard pawnNormalMoves(pawns.board() & ~pawnPromoteMoves.board());
 
-	pawnPromoteCaptures<white>(pawnPromoteMoves, captureList, state);
-	pawnEnpassants<white>(pawnEnpassantMoves, captureList, state);
-	pawnNormalCaptures<white>(pawnNormalMoves, captureList, state);
+	pawnPromoteCaptures<white>(pawnPromoteMoves, captureList, state, mask);
+	pawnNormalCaptures<white>(pawnNormalMoves, captureList, state, mask);
 }
 
 template<bool white>
-static void knightCaptures(BitBoard knights, CaptureList& captureList, const State& state) noexcept
+static void pawnCaptures(BitBoard pawns, CaptureList& captureList, const State& state, const LegalMasks& masks) noexcept
+{
+	BitBoard pinnedPawns{ pawns.board() & masks.pinned };
+	pawnCaptures<white>(BitBoard(pawns.board() & ~masks.pinned), captureList, state, masks.checkMask);
+
+	while (pinnedPawns.board())
+	{
+		const int sourceIndex{ pinnedPawns.popLeastSignificantBit() };
+		pawnCaptures<white>(BitBoard(1ULL << sourceIndex), captureList, state, targetMask(masks, sourceIndex));
+	}
+
+	pawnEnpassants<white>(pawnEnpassantsMask<white>(pawns), captureList, state, masks);
+}
+
+template<bool white>
+static void knightCaptures(BitBoard knights, CaptureList& captureList, const State& state, const LegalMasks& masks) noexcept
 {
 	constexpr Piece knight{ white ? Piece::WhiteKnight : Piece::BlackKnight };
 
+	knights = BitBoard(knights.board() & ~masks.pinned);
+
 	while (knights.board())
 	{
 		const int sourceIndex{ knights.popLeastSignificantBit() };
-		const std::uint64_t knightMoves{ preGen.knightMove(sourceIndex).board() };
+		const std::uint64_t knightMoves{ preGen.knightMove(sourceIndex).board() & masks.checkMask };
 		BitBoard attacks{ knightMoves & (white ? state.blackOccupancy().board() : state.whiteOccupancy().board()) };
 
 		while (attacks.board())
@@ -506,25 +734,30 @@ static void kingCaptures(BitBoard kings, CaptureList& captureList, const State&
 
 	const int sourceIndex{ kings.leastSignificantBit() };
 	const BitBoard kingMoves{ preGen.kingMove(sourceIndex) };
+	const std::uint64_t occupancy{ state.occupancy().board() & ~(1ULL << sourceIndex) };
 	BitBoard attacks{ kingMoves.board() & (white ? state.blackOccupancy().board() : state.whiteOccupancy().board()) };
 
 	while (attacks.board())
 	{
 		const int attackIndex{ attacks.popLeastSignificantBit() };
-		const Piece attackPiece{ state.findPiece<!white>(attackIndex) };
-		captureList.pushAttack<king>(attackPiece, sourceIndex, attackIndex);
+
+		if (!squareAttacked<!white>(attackIndex, occupancy, state))
+		{
+			const Piece attackPiece{ state.findPiece<!white>(attackIndex) };
+			captureList.pushAttack<king>(attackPiece, sourceIndex, attackIndex);
+		}
 	}
 }
 
 template<bool white>
-static void bishopCaptures(BitBoard bishops, CaptureList& captureList, const State& state) noexcept
+static void bishopCaptures(BitBoard bishops, CaptureList& captureList, const State& state, const LegalMasks& masks) noexcept
 {
 	constexpr Piece bishop{ white ? Piece::WhiteBishop : Piece::BlackBishop };
 
 	while (bishops.board())
 	{
 		const int sourceIndex{ bishops.popLeastSignificantBit() };
-		const BitBoard bishopMoves{ preGen.bishopMove(sourceIndex, state.occupancy()) };
+		const BitBoard bishopMoves{ preGen.bishopMove(sourceIndex, state.occupancy()).board() & targetMask(masks, sourceIndex) };
 		BitBoard attacks{ bishopMoves.board() & (white ? state.blackOccupancy().board() : state.whiteOccupancy().board()) };
 
 		while (attacks.board())
@@ -537,14 +770,14 @@ static void bishopCaptures(BitBoard bishops, CaptureList& captureList, const Sta
 }
 
 template<bool white>
-static void rookCaptures(BitBoard rooks, CaptureList& captureList, const State& state) noexcept
+static void rookCaptures(BitBoard rooks, CaptureList& captureList, const State& state, const LegalMasks& masks) noexcept
 {
 	constexpr Piece rook{ white ? Piece::WhiteRook : Piece::BlackRook };
 
 	while (rooks.board())
 	{
 		const int sourceIndex{ rooks.popLeastSignificantBit() };
-		const BitBoard rookMoves{ preGen.rookMove(sourceIndex, state.occupancy()) };
+		const BitBoard rookMoves{ preGen.rookMove(sourceIndex, state.occupancy()).board() & targetMask(masks, sourceIndex) };
 		BitBoard attacks{ rookMoves.board() & (white ? state.blackOccupancy().board() : state.whiteOccupancy().board()) };
 
 		while (attacks.board())
@@ -558,14 +791,14 @@ static void rookCaptures(BitBoard rooks, CaptureList& captureList, const State&
 }
 
 template<bool white>
-static void queenCaptures(BitBoard queens, CaptureList& captureList, const State& state) noexcept 
+static void queenCaptures(BitBoard queens, CaptureList& captureList, const State& state, const LegalMasks& masks) noexcept 
 {
 	constexpr Piece queen{ white ? Piece::WhiteQueen : Piece::BlackQueen };
 
 	while (queens.board())
 	{
 		const int sourceIndex{ queens.popLeastSignificantBit() };
-		const BitBoard queenMoves{ preGen.bishopMove(sourceIndex, state.occupancy()).board() | preGen.rookMove(sourceIndex, state.occupancy()).board() };
+		const BitBoard queenMoves{ (preGen.bishopMove(sourceIndex, state.occupancy()).board() | preGen.rookMove(sourceIndex, state.occupancy()).board()) & targetMask(masks, sourceIndex) };
 		BitBoard attacks{ queenMoves.board() & (white ? state.blackOccupancy().board() : state.whiteOccupancy().board()) };
 
 		while (attacks.board())
@@ -580,60 +813,186 @@ static void queenCaptures(BitBoard queens, CaptureList& captureList, const State
 
 
 
+// without captures the check mask is limited to empty squares, which leaves every piece but the king with quiet moves only
+template<bool white, bool captures = true>
+static void legalMoves(MoveList& moveList, const State& state, LegalMasks masks) noexcept
+{
+	constexpr Piece pawn{ white ? Piece::WhitePawn : Piece::BlackPawn };
+	constexpr Piece knight{ white ? Piece::WhiteKnight : Piece::BlackKnight };
+	constexpr Piece bishop{ white ? Piece::WhiteBishop : Piece::BlackBishop };
+	constexpr Piece rook{ white ? Piece::WhiteRook : Piece::BlackRook };
+	constexpr Piece queen{ white ? Piece::WhiteQueen : Piece::BlackQueen };
+	constexpr Piece king{ white ? Piece::WhiteKing : Piece::BlackKing };
+
+	if constexpr (!captures)
+	{
+		masks.checkMask &= ~state.occupancy().board();
+	}
+
+	//in double check only the king can move
+	if (masks.checkMask)
+	{
+		pawnMoves<white, captures>(state.pieceOccupancyT<pawn>(), moveList, state, masks);
+		knightMoves<white>(state.pieceOccupancyT<knight>(), moveList, state, masks);
+		bishopMoves<white>(state.pieceOccupancyT<bishop>(), moveList, state, masks);
+		rookMoves<white>(state.pieceOccupancyT<rook>(), moveList, state, masks);
+		queenMoves<white>(state.pieceOccupancyT<queen>(), moveList, state, masks);
+	}
+
+	kingMoves<white, captures>(state.pieceOccupancyT<king>(), moveList, state, masks);
+}
+
+// generates the legal moves of the piece on the source square to the destination square only and looks for the move among 
+// them, enpassant can resolve a check without landing on the checker so it keeps the full mask
+template<bool white>
+static bool legalMove(Move move, const State& state, LegalMasks masks) noexcept
+{
+	constexpr Piece king{ white ? Piece::WhiteKing : Piece::BlackKing };
+
+	//castles carry no source square, they are generated with the king
+	const Piece sourcePiece{ move.castleFlag() ? king : move.sourcePiece() };
+	const BitBoard source{ move.castleFlag() ? state.pieceOccupancyT<king>().board() : 1ULL << move.sourceIndex() };
+
+	const std::uint64_t ownOccupancy{ white ? state.whiteOccupancy().board() : state.blackOccupancy().board() };
+
+	if (!(ownOccupancy & source.board()) || state.findPiece<white>(source.leastSignificantBit()) != sourcePiece) return false;
+
+	if (!move.castleFlag() && !move.enpassantFlag())
+	{
+		masks.checkMask &= 1ULL << move.destinationIndex();
+	}
+
+	MoveList moveList;
+
+	switch (sourcePiece)
+	{
+	case Piece::WhitePawn:
+	case Piece::BlackPawn:
+		if (masks.checkMask) pawnMoves<white>(source, moveList, state, masks);
+		break;
+
+	case Piece::WhiteKnight:
+	case Piece::BlackKnight:
+		if (masks.checkMask) knightMoves<white>(source, moveList, state, masks);
+		break;
+
+	case Piece::WhiteBishop:
+	case Piece::BlackBishop:
+		if (masks.checkMask) bishopMoves<white>(source, moveList, state, masks);
+		break;
+
+	case Piece::WhiteRook:
+	case Piece::BlackRook:
+		if (masks.checkMask) rookMoves<white>(source, moveList, state, masks);
+		break;
+
+	case Piece::WhiteQueen:
+	case Piece::BlackQueen:
+		if (masks.checkMask) queenMoves<white>(source, moveList, state, masks);
+		break;
+
+	default:
+		kingMoves<white>(source, moveList, state, masks);
+	}
+
+	return std::ranges::any_of(moveList, [move](Move legal) {
+		return legal.move() == move.move();
+		});
+}
+
+template<bool white>
+static void legalCaptures(CaptureList& captureList, const State& state, const LegalMasks& masks) noexcept
+{
+	constexpr Piece pawn{ white ? Piece::WhitePawn : Piece::BlackPawn };
+	constexpr Piece knight{ white ? Piece::WhiteKnight : Piece::BlackKnight };
+	constexpr Piece bishop{ white ? Piece::WhiteBishop : Piece::BlackBishop };
+	constexpr Piece rook{ white ? Piece::WhiteRook : Piece::BlackRook };
+	constexpr Piece queen{ white ? Piece::WhiteQueen : Piece::BlackQueen };
+	constexpr Piece king{ white ? Piece::WhiteKing : Piece::BlackKing };
+
+	if (masks.checkMask)
+	{
+		pawnCaptures<white>(state.pieceOccupancyT<pawn>(), captureList, state, masks);
+		knightCaptures<white>(state.pieceOccupancyT<knight>(), captureList, state, masks);
+		bishopCaptures<white>(state.pieceOccupancyT<bishop>(), captureList, state, masks);
+		rookCaptures<white>(state.pieceOccupancyT<rook>(), captureList, state, masks);
+		queenCaptures<white>(state.pieceOccupancyT<queen>(), captureList, state, masks);
+	}
+
+	kingCaptures<white>(state.pieceOccupancyT<king>(), captureList, state);
+}
+
+
+
 namespace MoveGen
 {
-	CaptureList generateCaptures(bool white, const State& state) noexcept
+	LegalMasks legalMasks(bool white, const State& state) noexcept
+	{
+		return white ? ::legalMasks<true>(state) : ::legalMasks<false>(state);
+	}
+
+	CaptureList generateCaptures(bool white, const State& state, const LegalMasks& masks) noexcept
 	{
 		CaptureList captureList;
 
 		if (white)
-		{ //TODO: maybe add if statements to test for occupancy before doing any logic?
-			pawnCaptures<true>(state.pieceOccupancyT<Piece::WhitePawn>(), captureList, state);
-			knightCaptures<true>(state.pieceOccupancyT<Piece::WhiteKnight>(), captureList, state);
-			bishopCaptures<true>(state.pieceOccupancyT<Piece::WhiteBishop>(), captureList, state);
-			rookCaptures<true>(state.pieceOccupancyT<Piece::WhiteRook>(), captureList, state);
-			queenCaptures<true>(state.pieceOccupancyT<Piece::WhiteQueen>(), captureList, state);
-			kingCaptures<true>(state.pieceOccupancyT<Piece::WhiteKing>(), captureList, state);
+		{
+			legalCaptures<true>(captureList, state, masks);
 		}
 		else
 		{
-			pawnCaptures<false>(state.pieceOccupancyT<Piece::BlackPawn>(), captureList, state);
-			knightCaptures<false>(state.pieceOccupancyT<Piece::BlackKnight>(), captureList, state);
-			bishopCaptures<false>(state.pieceOccupancyT<Piece::BlackBishop>(), captureList, state);
-			rookCaptures<false>(state.pieceOccupancyT<Piece::BlackRook>(), captureList, state);
-			queenCaptures<false>(state.pieceOccupancyT<Piece::BlackQueen>(), captureList, state);
-			kingCaptures<false>(state.pieceOccupancyT<Piece::BlackKing>(), captureList, state);
+			legalCaptures<false>(captureList, state, masks);
 		}
 
 		return captureList;
 	}
 
+	MoveList generateQuiets(bool white, const State& state, const LegalMasks& masks) noexcept
+	{
+		MoveList moveList;
+
+		if (white)
+		{
+			legalMoves<true, false>(moveList, state, masks);
+		}
+		else
+		{
+			legalMoves<false, false>(moveList, state, masks);
+		}
+
+		return moveList;
+	}
+
+	bool legalMove(bool white, Move move, const State& state, const LegalMasks& masks) noexcept
+	{
+		return move.move() && (white ? ::legalMove<true>(move, state, masks) : ::legalMove<false>(move, state, masks));
+	}
+
 	MoveList generateMoves(bool white, const State& state) noexcept
 	{
 		MoveList moveList;
 
 		if (white)
-		{ //TODO: maybe add if statements to test for occupancy before doing any logic?
-			pawnMoves<true>(state.pieceOccupancyT<Piece::WhitePawn>(), moveList, state);
-			knightMoves<true>(state.pieceOccupancyT<Piece::WhiteKnight>(), moveList, state);
-			bishopMoves<true>(state.pieceOccupancyT<Piece::WhiteBishop>(), moveList, state);
-			rookMoves<true>(state.pieceOccupancyT<Piece::WhiteRook>(), moveList, state);
-			queenMoves<true>(state.pieceOccupancyT<Piece::WhiteQueen>(), moveList, state);
-			kingMoves<true>(state.pieceOccupancyT<Piece::WhiteKing>(), moveList, state);
+		{
+			legalMoves<true>(moveList, state, ::legalMasks<true>(state));
 		}
 		else
 		{
-			pawnMoves<false>(state.pieceOccupancyT<Piece::BlackPawn>(), moveList, state);
-			knightMoves<false>(state.pieceOccupancyT<Piece::BlackKnight>(), moveList, state);
-			bishopMoves<false>(state.pieceOccupancyT<Piece::BlackBishop>(), moveList, state);
-			rookMoves<false>(state.pieceOccupancyT<Piece::BlackRook>(), moveList, state);
-			queenMoves<false>(state.pieceOccupancyT<Piece::BlackQueen>(), moveList, state);
-			kingMoves<false>(state.pieceOccupancyT<Piece::BlackKing>(), moveList, state);
+			legalMoves<false>(moveList, state, ::legalMasks<false>(state));
 		}
 
 		return moveList;
 	}
 
+	bool squareAttacked(bool white, int square, const State& state) noexcept
+	{
+		return white ? ::squareAttacked<true>(square, state) : ::squareAttacked<false>(square, state);
+	}
+
+	BitBoard attackedSquares(bool white, const State& state) noexcept
+	{
+		return white ? ::attackedSquares<true>(state) : ::attackedSquares<false>(state);
+	}
 
 	BitBoard whitePawnMoves(std::size_t square) noexcept
 	{
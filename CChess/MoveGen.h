@@ -1,13 +1,35 @@
 #pragma once
 
+#include <cstdint>
+
 #include "State.h"
 #include "MoveList.hpp"
 
 namespace MoveGen
 {
+	// Everything the legal generator needs to know about checks and pins, computed once per node.
+	struct LegalMasks
+	{
+		std::uint64_t checkers;
+		std::uint64_t checkMask;
+		std::uint64_t pinned;
+		int kingIndex;
+	};
+
+	LegalMasks legalMasks(bool white, const State& state) noexcept;
+
 	MoveList generateMoves(bool white, const State& state) noexcept;
 
-	CaptureList generateCaptures(bool white, const State& state) noexcept;
+	CaptureList generateCaptures(bool white, const State& state, const LegalMasks& masks) noexcept;
+
+	MoveList generateQuiets(bool white, const State& state, const LegalMasks& masks) noexcept;
+
+	// the masks of the position the move is played in, a node that checks several moves computes them once
+	bool legalMove(bool white, Move move, const State& state, const LegalMasks& masks) noexcept;
+
+	bool squareAttacked(bool white, int square, const State& state) noexcept;
+
+	BitBoard attackedSquares(bool white, const State& state) noexcept;
 
 	BitBoard whitePawnMoves(std::size_t square) noexcept;
 
@@ -0,0 +1,130 @@
+#include "MoveHistory.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <span>
+
+#include "Castle.hpp"
+#include "ChessConstants.hpp"
+#include "Move.h"
+
+
+
+//	Static Helpers
+
+static constexpr int maxBonus{ 1536 };
+
+// castles only carry their type, the tables see them as the king moving two squares
+static int historySource(Move move) noexcept
+{
+	if (!move.castleFlag()) return move.sourceIndex();
+
+	const bool white{ (move.castleType() & Castle::WhiteBoth) != Castle::None };
+	return white ? e1 : e8;
+}
+
+static int historyDestination(Move move) noexcept
+{
+	if (!move.castleFlag()) return move.destinationIndex();
+
+	switch (move.castleType())
+	{
+	case Castle::WhiteKingSide: return g1;
+	case Castle::WhiteQueenSide: return c1;
+	case Castle::BlackKingSide: return g8;
+	default: return c8;
+	}
+}
+
+static std::size_t pieceSquare(Move move) noexcept
+{
+	const bool white{ (move.castleType() & Castle::WhiteBoth) != Castle::None };
+	const Piece piece{ move.castleFlag() ? (white ? Piece::WhiteKing : Piece::BlackKing) : move.sourcePiece() };
+
+	return static_cast<std::size_t>(piece) * boardSize + static_cast<std::size_t>(historyDestination(move));
+}
+
+static std::size_t butterflyIndex(bool white, Move move) noexcept
+{
+	return (static_cast<std::size_t>(white) * boardSize + static_cast<std::size_t>(historySource(move))) * boardSize 
+		+ static_cast<std::size_t>(historyDestination(move));
+}
+
+static int historyBonus(int depth) noexcept
+{
+	return std::min(32 * depth * depth, maxBonus);
+}
+
+
+
+//	Private Methods
+
+// gravity, the closer an entry already is to the limit the less it moves so old statistics fade instead of saturating
+void MoveHistory::applyBonus(std::int16_t& entry, int bonus) noexcept
+{
+	entry = static_cast<std::int16_t>(entry + bonus - entry * std::abs(bonus) / maxHistory);
+}
+
+
+
+//	Public Methods
+
+//constructors
+MoveHistory::MoveHistory() noexcept
+	: m_butterfly(), m_continuation(), m_counterMoves()
+{
+	clear();
+}
+
+
+
+//getters
+int MoveHistory::score(bool white, Move move, ContinuationMoves continuation) const noexcept
+{
+	int score{ m_butterfly[butterflyIndex(white, move)] };
+
+	const std::size_t current{ pieceSquare(move) };
+
+	if (continuation.previous.move()) score += m_continuation[pieceSquare(continuation.previous) * pieceSquares + current];
+	if (continuation.followup.move()) score += m_continuation[pieceSquare(continuation.followup) * pieceSquares + current];
+
+	return score;
+}
+
+Move MoveHistory::counterMove(Move previous) const noexcept
+{
+	return previous.move() ? m_counterMoves[pieceSquare(previous)] : Move{ 0 };
+}
+
+
+
+//setters
+void MoveHistory::update(bool white, Move bestMove, std::span<const Move> failedQuiets, ContinuationMoves continuation, int depth) noexcept
+{
+	const int bonus{ historyBonus(depth) };
+
+	const auto reward = [this, white, continuation](Move move, int bonus) {
+		applyBonus(m_butterfly[butterflyIndex(white, move)], bonus);
+
+		const std::size_t current{ pieceSquare(move) };
+
+		if (continuation.previous.move()) applyBonus(m_continuation[pieceSquare(continuation.previous) * pieceSquares + current], bonus);
+		if (continuation.followup.move()) applyBonus(m_continuation[pieceSquare(continuation.followup) * pieceSquares + current], bonus);
+	};
+
+	reward(bestMove, bonus);
+
+	std::ranges::for_each(failedQuiets, [&reward, bonus](Move move) {
+		reward(move, -bonus);
+		});
+
+	if (continuation.previous.move()) m_counterMoves[pieceSquare(continuation.previous)] = bestMove;
+}
+
+void MoveHistory::clear() noexcept
+{
+	m_butterfly.fill(0);
+	m_continuation.fill(0);
+	m_counterMoves.fill(0);
+}
\ No newline at end of file
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+
+#include "ChessConstants.hpp"
+#include "Move.h"
+
+
+
+// the two moves played before the current node, the opponent's reply and our own move before it
+struct alignas(8) ContinuationMoves
+{
+	Move previous;
+	Move followup;
+};
+
+// quiet move ordering statistics gathered while searching, butterfly history by side and squares, continuation history 
+// by the previous move's piece and destination and a countermove for every previous move, all updated on beta cutoffs
+class MoveHistory
+{
+public:
+
+	//	Public Definitions
+
+	//constants
+	static constexpr int maxHistory{ 16384 };
+
+
+
+private:
+
+	//	Private Definitions
+
+	//constants
+	static constexpr std::size_t pieceSquares{ static_cast<std::size_t>(pieceCount * boardSize) };
+
+	//usings
+	using ButterflyTable = std::array<std::int16_t, 2 * boardSize * boardSize>;
+	using ContinuationTable = std::array<std::int16_t, pieceSquares * pieceSquares>;
+	using CounterMoveTable = std::array<Move, pieceSquares>;
+
+
+
+private:
+
+	//	Private Members
+
+	ButterflyTable m_butterfly;
+	ContinuationTable m_continuation;
+	CounterMoveTable m_counterMoves;
+
+
+
+private:
+
+	//	Private Methods
+
+	static void applyBonus(std::int16_t& entry, int bonus) noexcept;
+
+
+
+public:
+
+	//	Public Methods
+
+	//constructors
+	MoveHistory() noexcept;
+
+
+
+	//getters
+	int score(bool white, Move move, ContinuationMoves continuation) const noexcept;
+
+	Move counterMove(Move previous) const noexcept;
+
+
+
+	//setters
+	// rewards the quiet move that caused a cutoff and punishes the quiet moves searched before it
+	void update(bool white, Move bestMove, std::span<const Move> failedQuiets, ContinuationMoves continuation, int depth) noexcept;
+
+	void clear() noexcept;
+};
\ No newline at end of file
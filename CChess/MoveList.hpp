@@ -1,11 +1,9 @@
 #pragma once
 
 #include <array>
-#include <algorithm>
 
 #include "ChessConstants.hpp"
 #include "Move.h"
-#include "KillerMoveHistory.h"
 #include "Castle.hpp"
 
 
@@ -13,52 +11,6 @@
 template<std::size_t listSize>
 class cachealign MoveListT 
 {
-private:
-
-	static int moveScore(Move move) noexcept
-	{
-		static constexpr std::array<int, pieceCount* pieceCount> mvvLva{
-			//   X   P   N   B   R   Q   K     p,  n,  b,  r,  q,  k
-			/*X*/00, 00, 00, 00, 00, 00, 00,   00, 00, 00, 00, 00, 00,
-			/*P*/00, 00, 00, 00, 00, 00, 00,   61, 51, 41, 31, 21, 11,
-			/*N*/00, 00, 00, 00, 00, 00, 00,   62, 52, 42, 32, 22, 12,
-			/*B*/00, 00, 00, 00, 00, 00, 00,   63, 53, 43, 33, 23, 13,
-			/*R*/00, 00, 00, 00, 00, 00, 00,   64, 54, 44, 34, 24, 14,
-			/*Q*/00, 00, 00, 00, 00, 00, 00,   65, 55, 45, 35, 25, 15,
-			/*K*/00, 00, 00, 00, 00, 00, 00,   00, 00, 00, 00, 00, 00,
-
-			/*p*/00, 61, 51, 41, 31, 21, 11,   00, 00, 00, 00, 00, 00,
-			/*n*/00, 62, 52, 42, 32, 22, 12,   00, 00, 00, 00, 00, 00,
-			/*b*/00, 63, 53, 43, 33, 23, 13,   00, 00, 00, 00, 00, 00,
-			/*r*/00, 64, 54, 44, 34, 24, 14,   00, 00, 00, 00, 00, 00,
-			/*q*/00, 65, 55, 45, 35, 25, 15,   00, 00, 00, 00, 00, 00,
-			/*k*/00, 00, 00, 00, 00, 00, 00,   00, 00, 00, 00, 00, 00
-		};
-
-		const std::size_t sourcePiece{ static_cast<std::size_t>(move.sourcePiece()) };
-		const std::size_t capturePiece{ static_cast<std::size_t>(move.attackPiece()) };
-
-		const int score{ mvvLva[capturePiece * pieceCount + sourcePiece] };
-		return score + (static_cast<int>(move.promotePiece()) << 7);
-	}
-
-	static bool MoveGreater(Move lhs, Move rhs, KillerMoves killerMoves, Move pvMove) noexcept
-	{
-		const bool lhsKiller{ lhs.move() == killerMoves.first.move() || lhs.move() == killerMoves.second.move() };
-		const bool lhsIsPvMove{ lhs.move() == pvMove.move() };
-		const int lhsStaticScore{ moveScore(lhs) };
-		const int lhsScore = lhsStaticScore + (static_cast<int>(lhsKiller) << 10) + (static_cast<int>(lhsIsPvMove) << 14);
-
-		const bool rhsKiller{ rhs.move() == killerMoves.first.move() || rhs.move() == killerMoves.second.move() };
-		const bool rhsIsPvMove{ rhs.move() == pvMove.move() };
-		const int rhsStaticScore{ moveScore(rhs) };
-		const int rhsScore = rhsStaticScore + (static_cast<int>(rhsKiller) << 10) + (static_cast<int>(rhsIsPvMove) << 14);
-
-		return lhsScore > rhsScore;
-	}
-
-
-
 private:
 
 	std::array<Move, listSize>::iterator m_back;
@@ -111,9 +63,14 @@ public:
 		return m_back - m_moves.begin();
 	}
 
-	void sort(KillerMoves killerMoves, Move pvMove) noexcept
+	Move& operator[](std::size_t index) noexcept
 	{
-		std::sort(m_moves.begin(), m_back, [killerMoves, pvMove](Move lhs, Move rhs) { return MoveGreater(lhs, rhs, killerMoves, pvMove); });
+		return m_moves[index];
+	}
+
+	Move operator[](std::size_t index) const noexcept
+	{
+		return m_moves[index];
 	}
 
 	std::array<Move, listSize>::const_iterator begin() const noexcept 
@@ -128,6 +85,12 @@ public:
 
 
 
+	void push(Move move) noexcept
+	{
+		*m_back = move;
+		++m_back;
+	}
+
 	template<Piece piece>
 	void pushQuiet(int sourceIndex, int destinationIndex) noexcept 
 	{
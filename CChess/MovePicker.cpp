@@ -0,0 +1,208 @@
+#include "MovePicker.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+#include "ChessConstants.hpp"
+#include "KillerMoveHistory.h"
+#include "Move.h"
+#include "MoveGen.h"
+#include "MoveHistory.h"
+#include "MoveList.hpp"
+#include "State.h"
+
+
+
+//	Static Helpers
+
+static constexpr std::array<int, pieceCount * pieceCount> mvvLva{
+	//   X   P   N   B   R   Q   K     p,  n,  b,  r,  q,  k
+	/*X*/00, 00, 00, 00, 00, 00, 00,   00, 00, 00, 00, 00, 00,
+	/*P*/00, 00, 00, 00, 00, 00, 00,   61, 51, 41, 31, 21, 11,
+	/*N*/00, 00, 00, 00, 00, 00, 00,   62, 52, 42, 32, 22, 12,
+	/*B*/00, 00, 00, 00, 00, 00, 00,   63, 53, 43, 33, 23, 13,
+	/*R*/00, 00, 00, 00, 00, 00, 00,   64, 54, 44, 34, 24, 14,
+	/*Q*/00, 00, 00, 00, 00, 00, 00,   65, 55, 45, 35, 25, 15,
+	/*K*/00, 00, 00, 00, 00, 00, 00,   00, 00, 00, 00, 00, 00,
+
+	/*p*/00, 61, 51, 41, 31, 21, 11,   00, 00, 00, 00, 00, 00,
+	/*n*/00, 62, 52, 42, 32, 22, 12,   00, 00, 00, 00, 00, 00,
+	/*b*/00, 63, 53, 43, 33, 23, 13,   00, 00, 00, 00, 00, 00,
+	/*r*/00, 64, 54, 44, 34, 24, 14,   00, 00, 00, 00, 00, 00,
+	/*q*/00, 65, 55, 45, 35, 25, 15,   00, 00, 00, 00, 00, 00,
+	/*k*/00, 00, 00, 00, 00, 00, 00,   00, 00, 00, 00, 00, 00
+};
+
+static int captureScore(Move move) noexcept
+{
+	const std::size_t sourcePiece{ static_cast<std::size_t>(move.sourcePiece()) };
+	const std::size_t capturePiece{ static_cast<std::size_t>(move.attackPiece()) };
+
+	return mvvLva[capturePiece * pieceCount + sourcePiece] + (static_cast<int>(move.promotePiece()) << 7);
+}
+
+static bool quietMove(Move move) noexcept
+{
+	return move.attackPiece() == Piece::NoPiece;
+}
+
+
+
+//	Private Methods
+
+// selection sort one step at a time, most nodes cut off after the first few moves so sorting the whole list is wasted work
+template<typename List>
+Move MovePicker::pickBest(List& list) noexcept
+{
+	const std::size_t size{ list.size() };
+
+	if (m_index >= size) return Move{ 0 };
+
+	std::size_t bestIndex{ m_index };
+
+	for (std::size_t i{ m_index + 1 }; i < size; ++i)
+	{
+		bestIndex = m_scores[i] > m_scores[bestIndex] ? i : bestIndex;
+	}
+
+	std::swap(list[m_index], list[bestIndex]);
+	std::swap(m_scores[m_index], m_scores[bestIndex]);
+
+	return list[m_index++];
+}
+
+// promotions first, then the countermove, then history, the bonuses are above anything the history tables add up to
+int MovePicker::quietScore(Move move) const noexcept
+{
+	const int promoteScore{ static_cast<int>(move.promotePiece()) << 17 };
+	const int counterScore{ move.move() == m_counterMove.move() ? MoveHistory::maxHistory * 4 : 0 };
+
+	return promoteScore + counterScore + m_history->score(m_white, move, m_continuation);
+}
+
+bool MovePicker::alreadyPicked(Move move) const noexcept
+{
+	return move.move() == m_hashMove.move()
+		|| move.move() == m_killerMoves.first.move()
+		|| move.move() == m_killerMoves.second.move();
+}
+
+// killers come from another branch of the tree and are quiet by construction, anything else would be picked twice
+bool MovePicker::validKiller(Move killer) const noexcept
+{
+	return killer.move() != m_hashMove.move() && quietMove(killer) && MoveGen::legalMove(m_white, killer, m_state, m_masks);
+}
+
+
+
+//	Public Methods
+
+//constructors
+MovePicker::MovePicker(const State& state, bool white, Move hashMove, KillerMoves killerMoves, const MoveHistory& history, 
+	ContinuationMoves continuation) noexcept
+	: m_state(state), m_history(&history), m_masks(MoveGen::legalMasks(white, state)), m_white(white), m_capturesOnly(false), 
+	m_hashMove(0), m_killerMoves(killerMoves), m_continuation(continuation), m_counterMove(history.counterMove(continuation.previous)), 
+	m_stage(Stage::HashMove), m_index(0), m_captures(), m_quiets()
+{
+	//moves from the table may not be legal here, a hash collision can hand out anything, the killers are only checked 
+	//once their stage is reached since most nodes cut off before it
+	m_hashMove = MoveGen::legalMove(white, hashMove, state, m_masks) ? hashMove : Move{ 0 };
+}
+
+MovePicker::MovePicker(const State& state, bool white) noexcept
+	: m_state(state), m_history(nullptr), m_masks(MoveGen::legalMasks(white, state)), m_white(white), m_capturesOnly(true), 
+	m_hashMove(0), m_killerMoves{ 0, 0 }, m_continuation{ 0, 0 }, m_counterMove(0), m_stage(Stage::GenerateCaptures), m_index(0), 
+	m_captures(), m_quiets()
+{
+}
+
+
+
+//getters
+MovePicker::Stage MovePicker::stage() const noexcept
+{
+	return m_stage;
+}
+
+
+
+//setters
+Move MovePicker::next() noexcept
+{
+	switch (m_stage)
+	{
+	case Stage::HashMove:
+		m_stage = Stage::GenerateCaptures;
+
+		if (m_hashMove.move()) return m_hashMove;
+
+		[[fallthrough]];
+
+	case Stage::GenerateCaptures:
+		m_captures = MoveGen::generateCaptures(m_white, m_state, m_masks);
+		m_index = 0;
+
+		for (std::size_t i{ 0 }; i < m_captures.size(); ++i)
+		{
+			m_scores[i] = captureScore(m_captures[i]);
+		}
+
+		m_stage = Stage::Captures;
+		[[fallthrough]];
+
+	case Stage::Captures:
+		for (Move move{ pickBest(m_captures) }; move.move(); move = pickBest(m_captures))
+		{
+			if (move.move() != m_hashMove.move()) return move;
+		}
+
+		m_stage = m_capturesOnly ? Stage::Done : Stage::FirstKiller;
+
+		if (m_capturesOnly) return Move{ 0 };
+
+		[[fallthrough]];
+
+	case Stage::FirstKiller:
+		m_stage = Stage::SecondKiller;
+		m_killerMoves.first = validKiller(m_killerMoves.first) ? m_killerMoves.first : Move{ 0 };
+
+		if (m_killerMoves.first.move()) return m_killerMoves.first;
+
+		[[fallthrough]];
+
+	case Stage::SecondKiller:
+		m_stage = Stage::GenerateQuiets;
+		m_killerMoves.second = m_killerMoves.second.move() != m_killerMoves.first.move() && validKiller(m_killerMoves.second) 
+			? m_killerMoves.second : Move{ 0 };
+
+		if (m_killerMoves.second.move()) return m_killerMoves.second;
+
+		[[fallthrough]];
+
+	case Stage::GenerateQuiets:
+		m_quiets = MoveGen::generateQuiets(m_white, m_state, m_masks);
+		m_index = 0;
+
+		for (std::size_t i{ 0 }; i < m_quiets.size(); ++i)
+		{
+			m_scores[i] = quietScore(m_quiets[i]);
+		}
+
+		m_stage = Stage::Quiets;
+		[[fallthrough]];
+
+	case Stage::Quiets:
+		for (Move move{ pickBest(m_quiets) }; move.move(); move = pickBest(m_quiets))
+		{
+			if (!alreadyPicked(move)) return move;
+		}
+
+		m_stage = Stage::Done;
+		[[fallthrough]];
+
+	case Stage::Done:
+	default:
+		return Move{ 0 };
+	}
+}
\ No newline at end of file
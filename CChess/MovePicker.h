@@ -0,0 +1,96 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "ChessConstants.hpp"
+#include "KillerMoveHistory.h"
+#include "Move.h"
+#include "MoveGen.h"
+#include "MoveHistory.h"
+#include "MoveList.hpp"
+#include "State.h"
+
+
+
+// hands out the moves of a position one at a time, best guess first, and only generates the next group of moves once the 
+// previous one is used up, a cutoff on the hash move or a good capture skips generating and scoring the quiet moves
+class MovePicker
+{
+public:
+
+	//	Public Definitions
+
+	//types
+	enum class Stage : std::uint8_t
+	{
+		HashMove,
+		GenerateCaptures,
+		Captures,
+		FirstKiller,
+		SecondKiller,
+		GenerateQuiets,
+		Quiets,
+		Done
+	};
+
+
+
+private:
+
+	//	Private Members
+
+	const State& m_state;
+	const MoveHistory* m_history;
+	MoveGen::LegalMasks m_masks;
+	bool m_white;
+	bool m_capturesOnly;
+	Move m_hashMove;
+	KillerMoves m_killerMoves;
+	ContinuationMoves m_continuation;
+	Move m_counterMove;
+	Stage m_stage;
+	std::size_t m_index;
+	CaptureList m_captures;
+	MoveList m_quiets;
+	std::array<int, maxLegalMoves> m_scores;
+
+
+
+private:
+
+	//	Private Methods
+
+	template<typename List>
+	Move pickBest(List& list) noexcept;
+
+	int quietScore(Move move) const noexcept;
+
+	bool alreadyPicked(Move move) const noexcept;
+
+	bool validKiller(Move killer) const noexcept;
+
+
+
+public:
+
+	//	Public Methods
+
+	//constructors
+	MovePicker(const State& state, bool white, Move hashMove, KillerMoves killerMoves, const MoveHistory& history, 
+		ContinuationMoves continuation) noexcept;
+
+	// captures and capture promotions only, for the quiescence search
+	MovePicker(const State& state, bool white) noexcept;
+
+
+
+	//getters
+	Stage stage() const noexcept;
+
+
+
+	//setters
+	// returns Move{ 0 } once every move was handed out
+	Move next() noexcept;
+};
\ No newline at end of file
@@ -0,0 +1,426 @@
+#include "Nnue.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <ostream>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include "ChessConstants.hpp"
+
+// the dense layers are picked at compile time, msvc only defines __AVX2__ for /arch:AVX2 and never __SSE4_1__ so 
+// without /arch:AVX2 it runs the scalar loop
+#if defined(__AVX2__)
+	#define CCHESS_AVX2
+	#include <immintrin.h>
+#elif defined(__SSE4_1__)
+	#define CCHESS_SSE41
+	#include <smmintrin.h>
+#endif
+
+
+
+//	Static Helpers
+
+static constexpr std::size_t inputSize{ 2 * Nnue::accumulatorSize };
+static constexpr std::size_t hiddenSize{ 32 };
+static constexpr int weightShift{ 6 };
+static constexpr int outputScale{ 16 };
+static constexpr int clipMax{ 127 };
+
+// "CCNE" in a little endian file
+static constexpr std::uint32_t networkMagic{ 0x454E4343 };
+
+// the file holds the magic and then every member in this order, little endian and without padding, dense weights are 
+// stored one output row after another
+struct Nnue::Network
+{
+	alignas(64) std::array<std::int16_t, Nnue::accumulatorSize> featureBiases;
+	alignas(64) std::array<std::int16_t, Nnue::featureCount * Nnue::accumulatorSize> featureWeights;
+	alignas(64) std::array<std::int32_t, hiddenSize> firstBiases;
+	alignas(64) std::array<std::int8_t, hiddenSize * inputSize> firstWeights;
+	alignas(64) std::array<std::int32_t, hiddenSize> secondBiases;
+	alignas(64) std::array<std::int8_t, hiddenSize * hiddenSize> secondWeights;
+	alignas(64) std::array<std::int8_t, hiddenSize> outputWeights;
+	std::int32_t outputBias;
+};
+
+template<typename T, std::size_t size>
+static bool readArray(std::ifstream& file, std::array<T, size>& values)
+{
+	file.read(reinterpret_cast<char*>(values.data()), static_cast<std::streamsize>(sizeof(T) * size));
+	return static_cast<bool>(file);
+}
+
+template<typename T>
+static bool readValue(std::ifstream& file, T& value)
+{
+	file.read(reinterpret_cast<char*>(&value), static_cast<std::streamsize>(sizeof(T)));
+	return static_cast<bool>(file);
+}
+
+static consteval std::array<Piece, boardSize> generateBenchmarkBoard()
+{
+	constexpr std::string_view position{ "RNBQKBNRPPPPPPPP................................pppppppprnbqkbnr" };
+	constexpr std::string_view pieces{ ".PNBRQKpnbrqk" };
+
+	std::array<Piece, boardSize> board{};
+
+	for (std::size_t square{}; square < board.size(); ++square)
+	{
+		board[square] = static_cast<Piece>(pieces.find(position[square]));
+	}
+
+	return board;
+}
+
+static constexpr std::array<Piece, boardSize> benchmarkBoard{ generateBenchmarkBoard() };
+
+static bool isKing(Piece piece) noexcept
+{
+	return piece == Piece::WhiteKing || piece == Piece::BlackKing;
+}
+
+// the black view flips the board so both kings see their own pieces from the first rank
+static std::size_t featureIndex(bool whiteView, int kingSquare, Piece piece, int square) noexcept
+{
+	const int pieceIndex{ static_cast<int>(piece) };
+	const bool whitePiece{ pieceIndex < blackPieceOffset };
+	const int pieceType{ whitePiece ? pieceIndex - 1 : pieceIndex - blackPieceOffset };
+	const int flip{ whiteView ? 0 : 56 };
+	const int pieceFeature{ pieceType * 2 + (whitePiece == whiteView ? 0 : 1) };
+
+	return static_cast<std::size_t>(((kingSquare ^ flip) * static_cast<int>(Nnue::pieceFeatureCount) + pieceFeature) * boardSize + (square ^ flip));
+}
+
+// adds or subtracts one feature's weights from one view, the plain loop is not vectorized since the accumulator and the 
+// weights could alias, both are aligned to 64 bytes and every row is a multiple of 64 bytes long
+#if defined(CCHESS_AVX2)
+template<bool add>
+static void updateView(std::int16_t* values, const std::int16_t* weights) noexcept
+{
+	for (std::size_t i{}; i < Nnue::accumulatorSize; i += 16)
+	{
+		const __m256i value{ _mm256_load_si256(reinterpret_cast<const __m256i*>(values + i)) };
+		const __m256i weight{ _mm256_load_si256(reinterpret_cast<const __m256i*>(weights + i)) };
+
+		_mm256_store_si256(reinterpret_cast<__m256i*>(values + i), add ? _mm256_add_epi16(value, weight) : _mm256_sub_epi16(value, weight));
+	}
+}
+#elif defined(CCHESS_SSE41)
+template<bool add>
+static void updateView(std::int16_t* values, const std::int16_t* weights) noexcept
+{
+	for (std::size_t i{}; i < Nnue::accumulatorSize; i += 8)
+	{
+		const __m128i value{ _mm_load_si128(reinterpret_cast<const __m128i*>(values + i)) };
+		const __m128i weight{ _mm_load_si128(reinterpret_cast<const __m128i*>(weights + i)) };
+
+		_mm_store_si128(reinterpret_cast<__m128i*>(values + i), add ? _mm_add_epi16(value, weight) : _mm_sub_epi16(value, weight));
+	}
+}
+#else
+template<bool add>
+static void updateView(std::int16_t* values, const std::int16_t* weights) noexcept
+{
+	for (std::size_t i{}; i < Nnue::accumulatorSize; ++i)
+	{
+		values[i] = static_cast<std::int16_t>(add ? values[i] + weights[i] : values[i] - weights[i]);
+	}
+}
+#endif
+
+// clips one view to [0, 127] as the input of the first dense layer, packing saturates to [-128, 127] and the max takes 
+// care of the rest, the avx2 pack works within each 128 bit lane so the quarters are put back in order afterwards
+#if defined(CCHESS_AVX2)
+static void clipView(const std::int16_t* values, std::uint8_t* output) noexcept
+{
+	const __m256i zero{ _mm256_setzero_si256() };
+
+	for (std::size_t i{}; i < Nnue::accumulatorSize; i += 32)
+	{
+		const __m256i low{ _mm256_load_si256(reinterpret_cast<const __m256i*>(values + i)) };
+		const __m256i high{ _mm256_load_si256(reinterpret_cast<const __m256i*>(values + i + 16)) };
+		const __m256i packed{ _mm256_permute4x64_epi64(_mm256_packs_epi16(low, high), 0b11011000) };
+
+		_mm256_store_si256(reinterpret_cast<__m256i*>(output + i), _mm256_max_epi8(packed, zero));
+	}
+}
+#elif defined(CCHESS_SSE41)
+static void clipView(const std::int16_t* values, std::uint8_t* output) noexcept
+{
+	const __m128i zero{ _mm_setzero_si128() };
+
+	for (std::size_t i{}; i < Nnue::accumulatorSize; i += 16)
+	{
+		const __m128i low{ _mm_load_si128(reinterpret_cast<const __m128i*>(values + i)) };
+		const __m128i high{ _mm_load_si128(reinterpret_cast<const __m128i*>(values + i + 8)) };
+
+		_mm_store_si128(reinterpret_cast<__m128i*>(output + i), _mm_max_epi8(_mm_packs_epi16(low, high), zero));
+	}
+}
+#else
+static void clipView(const std::int16_t* values, std::uint8_t* output) noexcept
+{
+	for (std::size_t i{}; i < Nnue::accumulatorSize; ++i)
+	{
+		output[i] = static_cast<std::uint8_t>(std::clamp(static_cast<int>(values[i]), 0, clipMax));
+	}
+}
+#endif
+
+// raw sums of every output row, four rows at a time so each input load is shared and the horizontal adds are done once
+// per four outputs, inputs are clipped to [0, 127] so the pairwise u8 * i8 sums of maddubs can not saturate
+#if defined(CCHESS_AVX2)
+static void denseSums(const std::uint8_t* input, const std::int8_t* weights, std::size_t inputs, std::size_t outputs, std::int32_t* sums) noexcept
+{
+	const __m256i ones{ _mm256_set1_epi16(1) };
+
+	for (std::size_t row{}; row < outputs; row += 4)
+	{
+		const std::int8_t* rows{ weights + row * inputs };
+		__m256i sum0{ _mm256_setzero_si256() };
+		__m256i sum1{ _mm256_setzero_si256() };
+		__m256i sum2{ _mm256_setzero_si256() };
+		__m256i sum3{ _mm256_setzero_si256() };
+
+		for (std::size_t i{}; i < inputs; i += 32)
+		{
+			const __m256i in{ _mm256_load_si256(reinterpret_cast<const __m256i*>(input + i)) };
+
+			sum0 = _mm256_add_epi32(sum0, _mm256_madd_epi16(_mm256_maddubs_epi16(in, _mm256_load_si256(reinterpret_cast<const __m256i*>(rows + i))), ones));
+			sum1 = _mm256_add_epi32(sum1, _mm256_madd_epi16(_mm256_maddubs_epi16(in, _mm256_load_si256(reinterpret_cast<const __m256i*>(rows + inputs + i))), ones));
+			sum2 = _mm256_add_epi32(sum2, _mm256_madd_epi16(_mm256_maddubs_epi16(in, _mm256_load_si256(reinterpret_cast<const __m256i*>(rows + 2 * inputs + i))), ones));
+			sum3 = _mm256_add_epi32(sum3, _mm256_madd_epi16(_mm256_maddubs_epi16(in, _mm256_load_si256(reinterpret_cast<const __m256i*>(rows + 3 * inputs + i))), ones));
+		}
+
+		const __m256i pairs{ _mm256_hadd_epi32(_mm256_hadd_epi32(sum0, sum1), _mm256_hadd_epi32(sum2, sum3)) };
+		const __m128i total{ _mm_add_epi32(_mm256_castsi256_si128(pairs), _mm256_extracti128_si256(pairs, 1)) };
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(sums + row), total);
+	}
+}
+#elif defined(CCHESS_SSE41)
+static void denseSums(const std::uint8_t* input, const std::int8_t* weights, std::size_t inputs, std::size_t outputs, std::int32_t* sums) noexcept
+{
+	const __m128i ones{ _mm_set1_epi16(1) };
+
+	for (std::size_t row{}; row < outputs; row += 4)
+	{
+		const std::int8_t* rows{ weights + row * inputs };
+		__m128i sum0{ _mm_setzero_si128() };
+		__m128i sum1{ _mm_setzero_si128() };
+		__m128i sum2{ _mm_setzero_si128() };
+		__m128i sum3{ _mm_setzero_si128() };
+
+		for (std::size_t i{}; i < inputs; i += 16)
+		{
+			const __m128i in{ _mm_load_si128(reinterpret_cast<const __m128i*>(input + i)) };
+
+			sum0 = _mm_add_epi32(sum0, _mm_madd_epi16(_mm_maddubs_epi16(in, _mm_load_si128(reinterpret_cast<const __m128i*>(rows + i))), ones));
+			sum1 = _mm_add_epi32(sum1, _mm_madd_epi16(_mm_maddubs_epi16(in, _mm_load_si128(reinterpret_cast<const __m128i*>(rows + inputs + i))), ones));
+			sum2 = _mm_add_epi32(sum2, _mm_madd_epi16(_mm_maddubs_epi16(in, _mm_load_si128(reinterpret_cast<const __m128i*>(rows + 2 * inputs + i))), ones));
+			sum3 = _mm_add_epi32(sum3, _mm_madd_epi16(_mm_maddubs_epi16(in, _mm_load_si128(reinterpret_cast<const __m128i*>(rows + 3 * inputs + i))), ones));
+		}
+
+		const __m128i total{ _mm_hadd_epi32(_mm_hadd_epi32(sum0, sum1), _mm_hadd_epi32(sum2, sum3)) };
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(sums + row), total);
+	}
+}
+#else
+static void denseSums(const std::uint8_t* input, const std::int8_t* weights, std::size_t inputs, std::size_t outputs, std::int32_t* sums) noexcept
+{
+	for (std::size_t row{}; row < outputs; ++row)
+	{
+		std::int32_t sum{};
+
+		for (std::size_t i{}; i < inputs; ++i)
+		{
+			sum += static_cast<std::int32_t>(input[i]) * static_cast<std::int32_t>(weights[row * inputs + i]);
+		}
+
+		sums[row] = sum;
+	}
+}
+#endif
+
+// one dense layer with a clipped relu
+template<std::size_t inputs, std::size_t outputs>
+static void denseLayer(const std::array<std::uint8_t, inputs>& input, const std::array<std::int8_t, inputs * outputs>& weights, 
+	const std::array<std::int32_t, outputs>& biases, std::array<std::uint8_t, outputs>& output) noexcept
+{
+	alignas(64) std::array<std::int32_t, outputs> sums;
+	denseSums(input.data(), weights.data(), inputs, outputs, sums.data());
+
+	for (std::size_t i{}; i < outputs; ++i)
+	{
+		output[i] = static_cast<std::uint8_t>(std::clamp((biases[i] + sums[i]) >> weightShift, 0, clipMax));
+	}
+}
+
+
+
+//	Private Methods
+
+std::span<const std::int16_t, Nnue::accumulatorSize> Nnue::featureWeights(std::size_t feature) const noexcept
+{
+	return std::span<const std::int16_t, accumulatorSize>{ m_network->featureWeights.data() + feature * accumulatorSize, accumulatorSize };
+}
+
+
+
+//	Public Methods
+
+//constructors
+Nnue::Nnue() noexcept
+	: m_network()
+{
+}
+
+Nnue::Nnue(std::string_view path)
+	: m_network()
+{
+	std::ifstream file(std::string(path), std::ios::binary);
+	if (!file) return;
+
+	std::unique_ptr<Network> loading{ std::make_unique<Network>() };
+	std::uint32_t magic{};
+
+	const bool read{ readValue(file, magic) && magic == networkMagic
+		&& readArray(file, loading->featureBiases)
+		&& readArray(file, loading->featureWeights)
+		&& readArray(file, loading->firstBiases)
+		&& readArray(file, loading->firstWeights)
+		&& readArray(file, loading->secondBiases)
+		&& readArray(file, loading->secondWeights)
+		&& readArray(file, loading->outputWeights)
+		&& readValue(file, loading->outputBias) };
+
+	//a file with anything after the last weight belongs to another architecture
+	if (!read || file.peek() != std::ifstream::traits_type::eof()) return;
+
+	m_network = std::move(loading);
+}
+
+Nnue::Nnue(Nnue&& other) noexcept = default;
+
+Nnue& Nnue::operator=(Nnue&& other) noexcept = default;
+
+Nnue::~Nnue() = default;
+
+
+
+//getters
+bool Nnue::loaded() const noexcept
+{
+	return m_network != nullptr;
+}
+
+int Nnue::evaluate(const Accumulator& accumulator, bool whiteToMove) const noexcept
+{
+	alignas(64) std::array<std::uint8_t, inputSize> input;
+	alignas(64) std::array<std::uint8_t, hiddenSize> firstHidden;
+	alignas(64) std::array<std::uint8_t, hiddenSize> secondHidden;
+
+	const std::array<std::int16_t, accumulatorSize>& own{ accumulator.values[whiteToMove ? 0 : 1] };
+	const std::array<std::int16_t, accumulatorSize>& opponent{ accumulator.values[whiteToMove ? 1 : 0] };
+
+	clipView(own.data(), input.data());
+	clipView(opponent.data(), input.data() + accumulatorSize);
+
+	denseLayer(input, m_network->firstWeights, m_network->firstBiases, firstHidden);
+	denseLayer(firstHidden, m_network->secondWeights, m_network->secondBiases, secondHidden);
+
+	std::int32_t output{ m_network->outputBias };
+
+	for (std::size_t i{}; i < hiddenSize; ++i)
+	{
+		output += static_cast<std::int32_t>(secondHidden[i]) * static_cast<std::int32_t>(m_network->outputWeights[i]);
+	}
+
+	return output / outputScale;
+}
+
+
+
+//accumulator
+void Nnue::refresh(Accumulator& accumulator, const std::array<Piece, boardSize>& board, int whiteKing, int blackKing) const noexcept
+{
+	refreshView(accumulator, board, true, whiteKing);
+	refreshView(accumulator, board, false, blackKing);
+}
+
+void Nnue::refreshView(Accumulator& accumulator, const std::array<Piece, boardSize>& board, bool whiteView, int kingSquare) const noexcept
+{
+	std::array<std::int16_t, accumulatorSize>& values{ accumulator.values[whiteView ? 0 : 1] };
+	std::ranges::copy(m_network->featureBiases, values.begin());
+
+	for (int square{}; square < boardSize; ++square)
+	{
+		const Piece piece{ board[static_cast<std::size_t>(square)] };
+		if (piece == Piece::NoPiece || isKing(piece)) continue;
+
+		updateView<true>(values.data(), featureWeights(featureIndex(whiteView, kingSquare, piece, square)).data());
+	}
+}
+
+void Nnue::addPiece(Accumulator& accumulator, Piece piece, int square, int whiteKing, int blackKing) const noexcept
+{
+	const std::span<const std::int16_t, accumulatorSize> whiteWeights{ featureWeights(featureIndex(true, whiteKing, piece, square)) };
+	const std::span<const std::int16_t, accumulatorSize> blackWeights{ featureWeights(featureIndex(false, blackKing, piece, square)) };
+
+	updateView<true>(accumulator.values[0].data(), whiteWeights.data());
+	updateView<true>(accumulator.values[1].data(), blackWeights.data());
+}
+
+void Nnue::removePiece(Accumulator& accumulator, Piece piece, int square, int whiteKing, int blackKing) const noexcept
+{
+	const std::span<const std::int16_t, accumulatorSize> whiteWeights{ featureWeights(featureIndex(true, whiteKing, piece, square)) };
+	const std::span<const std::int16_t, accumulatorSize> blackWeights{ featureWeights(featureIndex(false, blackKing, piece, square)) };
+
+	updateView<false>(accumulator.values[0].data(), whiteWeights.data());
+	updateView<false>(accumulator.values[1].data(), blackWeights.data());
+}
+
+
+// a knight moves back and forth before every evaluation like a quiet move in the search, a king move refreshes one view 
+// instead, the checksum keeps the work from being optimized away
+void Nnue::benchmark(std::ostream& out) const
+{
+	constexpr std::size_t evaluations{ 1 << 22 };
+	constexpr std::size_t refreshes{ 1 << 18 };
+
+	Accumulator accumulator{};
+	refresh(accumulator, benchmarkBoard, e1, e8);
+
+	std::int64_t checksum{};
+	const auto evaluateStart{ std::chrono::steady_clock::now() };
+
+	for (std::size_t i{}; i < evaluations; ++i)
+	{
+		const bool back{ static_cast<bool>(i & 1) };
+
+		removePiece(accumulator, Piece::WhiteKnight, back ? f3 : g1, e1, e8);
+		addPiece(accumulator, Piece::WhiteKnight, back ? g1 : f3, e1, e8);
+		checksum += evaluate(accumulator, back);
+	}
+
+	const std::chrono::duration<double> evaluateElapsed{ std::chrono::steady_clock::now() - evaluateStart };
+	const auto refreshStart{ std::chrono::steady_clock::now() };
+
+	for (std::size_t i{}; i < refreshes; ++i)
+	{
+		refreshView(accumulator, benchmarkBoard, true, static_cast<bool>(i & 1) ? e1 : f1);
+		checksum += accumulator.values[0][i & (accumulatorSize - 1)];
+	}
+
+	const std::chrono::duration<double> refreshElapsed{ std::chrono::steady_clock::now() - refreshStart };
+
+	out << "updates and evaluations: " << evaluations / evaluateElapsed.count() << " per second\n";
+	out << "view refreshes: " << refreshes / refreshElapsed.count() << " per second, checksum " << checksum << '\n';
+}
\ No newline at end of file
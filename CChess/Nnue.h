@@ -0,0 +1,106 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <span>
+#include <string_view>
+
+#include "ChessConstants.hpp"
+
+
+
+// efficiently updatable network with HalfKP inputs, every non king piece is a feature relative to the square of each 
+// king, the first layer sums them into one int16 accumulator per king that State keeps up to date move by move, three 
+// small int8 layers read the side to move's accumulator first and the opponent's second and score for the side to move, 
+// the weights belong to the Nnue that loaded them and every State using them points to it
+class Nnue
+{
+public:
+
+	//	Public Definitions
+
+	//constants
+	static constexpr std::size_t pieceFeatureCount{ 10 };
+	static constexpr std::size_t featureCount{ boardSize * pieceFeatureCount * boardSize };
+	static constexpr std::size_t accumulatorSize{ 256 };
+	static constexpr std::string_view defaultNetworkFile{ "cchess.nnue" };
+
+	//types
+	// the view of the white king first and the black king second
+	struct Accumulator
+	{
+		alignas(64) std::array<std::array<std::int16_t, accumulatorSize>, 2> values;
+	};
+
+
+
+private:
+
+	//	Private Definitions
+
+	//types
+	struct Network;
+
+
+
+private:
+
+	//	Private Methods
+
+	std::span<const std::int16_t, accumulatorSize> featureWeights(std::size_t feature) const noexcept;
+
+
+
+private:
+
+	//	Private Members
+
+	std::unique_ptr<Network> m_network;
+
+
+
+public:
+
+	//	Public Methods
+
+	//constructors
+	// without a network, see Nnue::loaded()
+	Nnue() noexcept;
+
+	// reads the weights in the file, an unreadable file or one of another architecture leaves the Nnue without a network
+	explicit Nnue(std::string_view path);
+
+	Nnue(Nnue&& other) noexcept;
+
+	Nnue& operator=(Nnue&& other) noexcept;
+
+	~Nnue();
+
+
+
+	//getters
+	bool loaded() const noexcept;
+
+	int evaluate(const Accumulator& accumulator, bool whiteToMove) const noexcept;
+
+
+
+	//accumulator, only valid while a network is loaded
+	void refresh(Accumulator& accumulator, const std::array<Piece, boardSize>& board, int whiteKing, int blackKing) const noexcept;
+
+	// rebuilds the view of one king only, the other view does not depend on where that king stands
+	void refreshView(Accumulator& accumulator, const std::array<Piece, boardSize>& board, bool whiteView, int kingSquare) const noexcept;
+
+	// kings are not features, moving one needs a refresh of its own view
+	void addPiece(Accumulator& accumulator, Piece piece, int square, int whiteKing, int blackKing) const noexcept;
+
+	void removePiece(Accumulator& accumulator, Piece piece, int square, int whiteKing, int blackKing) const noexcept;
+
+
+
+	// evaluations and refreshes per second of the network on the start position
+	void benchmark(std::ostream& out) const;
+};
\ No newline at end of file
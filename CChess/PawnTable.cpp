@@ -0,0 +1,30 @@
+#include "PawnTable.h"
+
+#include <cstdint>
+#include <vector>
+
+
+
+//	Static Helpers
+
+static constexpr std::uint64_t indexMask{ PawnTable::entryCount - 1 };
+
+static_assert((PawnTable::entryCount & indexMask) == 0, "the pawn table size has to be a power of two");
+
+
+
+//	Public Methods
+
+//constructors
+PawnTable::PawnTable()
+	: m_entries(entryCount)
+{
+}
+
+
+
+//getters
+PawnTable::Entry& PawnTable::entry(std::uint64_t key) noexcept
+{
+	return m_entries[key & indexMask];
+}
\ No newline at end of file
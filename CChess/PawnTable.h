@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "BitBoard.h"
+#include "PieceSquare.h"
+
+
+
+// small always replace cache of pawn structure evaluations, one per search thread so it needs no synchronization, 
+// pawn structures repeat so often within a search that nearly every probe hits, entries never go stale so it is never cleared
+class PawnTable
+{
+public:
+
+	//	Public Definitions
+
+	//types
+	struct Entry
+	{
+		std::uint64_t key;
+		TaperedScore score;
+		BitBoard whitePassed;
+		BitBoard blackPassed;
+	};
+
+	//constants
+	static constexpr std::size_t entryCount{ 16384 };
+
+
+
+private:
+
+	//	Private Members
+
+	std::vector<Entry> m_entries;
+
+
+
+public:
+
+	//	Public Methods
+
+	//constructors
+	PawnTable();
+
+
+
+	//getters
+	// the slot the key maps to, a different key means the caller has to evaluate the pawns and fill it in, empty slots
+	// hold the key and the evaluation of a board without pawns
+	Entry& entry(std::uint64_t key) noexcept;
+};
\ No newline at end of file
@@ -0,0 +1,198 @@
+#include "Perft.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "Castle.hpp"
+#include "Move.h"
+#include "MoveGen.h"
+#include "MoveList.hpp"
+#include "PerftTable.h"
+#include "State.h"
+
+
+
+//	Static Helpers
+
+struct PerftPosition
+{
+	std::string_view name;
+	std::string_view fen;
+	Castle castle;
+	std::array<std::uint64_t, 8> expected;
+};
+
+// the standard perft positions from the chess programming wiki with their node counts for depth 1 to 8, 0 where unknown
+static constexpr std::array<PerftPosition, 6> perftPositions{ {
+	{ "startpos", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w", Castle::All, { 20, 400, 8902, 197281, 4865609, 119060324, 3195901860, 84998978956 } },
+	{ "kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w", Castle::All, { 48, 2039, 97862, 4085603, 193690690, 8031647685, 374190009323, 0 } },
+	{ "position 3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w", Castle::None, { 14, 191, 2812, 43238, 674624, 11030083, 178633661, 3009794393 } },
+	{ "position 4", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w", Castle::BlackBoth, { 6, 264, 9467, 422333, 15833292, 706045033, 0, 0 } },
+	{ "position 5", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w", Castle::WhiteBoth, { 44, 1486, 62379, 2103487, 89941194, 3048196529, 0, 0 } },
+	{ "position 6", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w", Castle::None, { 46, 2079, 89890, 3894594, 164075551, 6923051137, 0, 0 } }
+} };
+
+
+
+// root moves are handed out one at a time so threads that draw small subtrees pick up the remaining work
+template<typename Count>
+static Perft::Result splitRoot(const State& state, bool white, int depth, int threads, Count count)
+{
+	const std::chrono::steady_clock::time_point start{ std::chrono::steady_clock::now() };
+	const MoveList moves{ MoveGen::generateMoves(white, state) };
+
+	Perft::Result result{};
+	result.divide.resize(moves.size());
+
+	std::atomic<std::size_t> nextMove{};
+
+	{
+		std::vector<std::jthread> pool;
+		const std::size_t threadCount{ std::clamp<std::size_t>(static_cast<std::size_t>(std::max(threads, 1)), 1, std::max<std::size_t>(moves.size(), 1)) };
+
+		for (std::size_t i{}; i < threadCount; ++i)
+		{
+			pool.emplace_back([&state, &moves, &result, &nextMove, &count, white, depth]() {
+				State child{ state };
+
+				for (std::size_t index{ nextMove.fetch_add(1) }; index < moves.size(); index = nextMove.fetch_add(1))
+				{
+					const Move move{ moves.begin()[index] };
+					const State::Undo undo{ child.makeMove(white, move) };
+
+					result.divide[index] = Perft::Divide{ move, depth > 1 ? count(child, !white, depth - 1) : 1 };
+					child.unmakeMove(white, move, undo);
+				}
+				});
+		}
+	}
+
+	std::ranges::for_each(result.divide, [&result](const Perft::Divide& divide) {
+		result.nodes += divide.nodes;
+		});
+
+	result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	result.nodesPerSecond = result.seconds > 0.0 ? static_cast<double>(result.nodes) / result.seconds : 0.0;
+
+	return result;
+}
+
+template<typename Run>
+static bool benchmarkPositions(std::ostream& out, int maxDepth, Run run)
+{
+	bool passed{ true };
+	std::uint64_t totalNodes{};
+	double totalSeconds{};
+
+	std::ranges::for_each(perftPositions, [&](const PerftPosition& position) {
+		const State state{ position.fen, position.castle };
+		const int depth{ std::clamp(maxDepth, 1, static_cast<int>(position.expected.size())) };
+		const Perft::Result result{ run(state, depth) };
+		const std::uint64_t expected{ position.expected[static_cast<std::size_t>(depth - 1)] };
+		const bool correct{ !expected || result.nodes == expected };
+
+		out << position.name << " depth " << depth << " nodes " << result.nodes << (correct ? "" : " FAILED") << (expected ? "" : " unchecked")
+			<< " time " << result.seconds << "s nps " << static_cast<std::uint64_t>(result.nodesPerSecond) << '\n';
+
+		passed = passed && correct;
+		totalNodes += result.nodes;
+		totalSeconds += result.seconds;
+		});
+
+	out << "total nodes " << totalNodes << " time " << totalSeconds << "s nps "
+		<< static_cast<std::uint64_t>(totalSeconds > 0.0 ? static_cast<double>(totalNodes) / totalSeconds : 0.0) << '\n';
+
+	return passed;
+}
+
+
+
+//	Perft
+
+namespace Perft
+{
+	// the generator only returns legal moves so the last ply is counted from the size of the list without making the moves
+	std::uint64_t perft(State& state, bool white, int depth) noexcept
+	{
+		const MoveList moves{ MoveGen::generateMoves(white, state) };
+
+		if (depth <= 1) return depth == 1 ? moves.size() : 1;
+
+		std::uint64_t nodes{};
+
+		for (Move move : moves)
+		{
+			const State::Undo undo{ state.makeMove(white, move) };
+			nodes += perft(state, !white, depth - 1);
+			state.unmakeMove(white, move, undo);
+		}
+
+		return nodes;
+	}
+
+	// subtrees are looked up by Zobrist key and depth, the last ply is bulk counted and not worth a table entry
+	std::uint64_t perft(State& state, bool white, int depth, PerftTable& table) noexcept
+	{
+		if (depth <= 1) return perft(state, white, depth);
+
+		std::uint64_t nodes{};
+
+		if (table.probe(state.hash(), depth, nodes)) return nodes;
+
+		const MoveList moves{ MoveGen::generateMoves(white, state) };
+
+		for (Move move : moves)
+		{
+			const State::Undo undo{ state.makeMove(white, move) };
+			nodes += perft(state, !white, depth - 1, table);
+			state.unmakeMove(white, move, undo);
+		}
+
+		table.store(state.hash(), depth, nodes);
+		return nodes;
+	}
+
+	Result run(const State& state, bool white, int depth, int threads)
+	{
+		return splitRoot(state, white, depth, threads, [](State& child, bool childWhite, int childDepth) {
+			return perft(child, childWhite, childDepth);
+			});
+	}
+
+	Result run(const State& state, bool white, int depth, int threads, PerftTable& table)
+	{
+		return splitRoot(state, white, depth, threads, [&table](State& child, bool childWhite, int childDepth) {
+			return perft(child, childWhite, childDepth, table);
+			});
+	}
+
+	void printDivide(std::ostream& out, const Result& result)
+	{
+		std::ranges::for_each(result.divide, [&out](const Divide& divide) {
+			out << divide.move.string() << ": " << divide.nodes << '\n';
+			});
+
+		out << "\nnodes: " << result.nodes << '\n';
+	}
+
+	bool benchmark(std::ostream& out, int maxDepth, int threads)
+	{
+		return benchmarkPositions(out, maxDepth, [threads](const State& state, int depth) {
+			return run(state, true, depth, threads);
+			});
+	}
+
+	bool benchmark(std::ostream& out, int maxDepth, int threads, PerftTable& table)
+	{
+		return benchmarkPositions(out, maxDepth, [threads, &table](const State& state, int depth) {
+			return run(state, true, depth, threads, table);
+			});
+	}
+};
\ No newline at end of file
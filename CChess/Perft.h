@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+#include "Move.h"
+#include "PerftTable.h"
+#include "State.h"
+
+
+
+namespace Perft
+{
+	struct Divide
+	{
+		Move move;
+		std::uint64_t nodes;
+	};
+
+	struct Result
+	{
+		std::uint64_t nodes;
+		double seconds;
+		double nodesPerSecond;
+		std::vector<Divide> divide;
+	};
+
+	std::uint64_t perft(State& state, bool white, int depth) noexcept;
+
+	std::uint64_t perft(State& state, bool white, int depth, PerftTable& table) noexcept;
+
+	Result run(const State& state, bool white, int depth, int threads);
+
+	Result run(const State& state, bool white, int depth, int threads, PerftTable& table);
+
+	void printDivide(std::ostream& out, const Result& result);
+
+	bool benchmark(std::ostream& out, int maxDepth, int threads);
+
+	bool benchmark(std::ostream& out, int maxDepth, int threads, PerftTable& table);
+};
\ No newline at end of file
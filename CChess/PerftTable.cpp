@@ -0,0 +1,190 @@
+#include "PerftTable.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifdef _WIN32
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <Windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <unistd.h>
+#endif
+
+#include "Zobrist.h"
+
+
+
+//	Static Helpers
+
+static constexpr std::uint64_t depthMask{ 0xFF };
+
+// the first slot of a mapped file holds this and the slot count, a file written with other Zobrist keys is cleared
+static std::uint64_t fileMagic() noexcept
+{
+	return Zobrist::sideKey() ^ 0x5045524654ULL;
+}
+
+static std::uint64_t loadRelaxed(std::uint64_t& value) noexcept
+{
+	return std::atomic_ref<std::uint64_t>(value).load(std::memory_order_relaxed);
+}
+
+static void storeRelaxed(std::uint64_t& value, std::uint64_t newValue) noexcept
+{
+	std::atomic_ref<std::uint64_t>(value).store(newValue, std::memory_order_relaxed);
+}
+
+static std::size_t slotCount(std::size_t megabytes, std::size_t slotSize) noexcept
+{
+	return std::max<std::size_t>(std::bit_floor(std::max<std::size_t>(megabytes, 1) * 1024 * 1024 / slotSize), 2);
+}
+
+
+
+//	Private Methods
+
+void PerftTable::unmap() noexcept
+{
+	if (!m_view) return;
+
+#ifdef _WIN32
+	FlushViewOfFile(m_view, 0);
+	UnmapViewOfFile(m_view);
+#else
+	msync(m_view, m_viewBytes, MS_SYNC);
+	munmap(m_view, m_viewBytes);
+#endif
+
+	m_view = nullptr;
+	m_viewBytes = 0;
+}
+
+
+
+//	Public Methods
+
+//constructors
+PerftTable::PerftTable(std::size_t megabytes)
+{
+	resize(megabytes);
+}
+
+PerftTable::~PerftTable()
+{
+	unmap();
+}
+
+
+
+//getters
+bool PerftTable::probe(std::uint64_t key, int depth, std::uint64_t& nodes) const noexcept
+{
+	//a bucket is two slots, one kept for the deepest subtree and one that is always replaced
+	const std::size_t index{ static_cast<std::size_t>(key & m_indexMask & ~1ULL) };
+
+	return std::ranges::any_of(m_slots.subspan(index, 2), [key, depth, &nodes](Slot& slot) {
+		const std::uint64_t data{ loadRelaxed(slot.data) };
+
+		if ((loadRelaxed(slot.key) ^ data) != key || (data & depthMask) != static_cast<std::uint64_t>(depth)) return false;
+
+		nodes = data >> 8;
+		return true;
+		});
+}
+
+
+
+//setters
+void PerftTable::store(std::uint64_t key, int depth, std::uint64_t nodes) noexcept
+{
+	const std::size_t index{ static_cast<std::size_t>(key & m_indexMask & ~1ULL) };
+	const std::uint64_t data{ (nodes << 8) | (static_cast<std::uint64_t>(depth) & depthMask) };
+
+	Slot& deepest{ m_slots[index] };
+	Slot& slot{ (loadRelaxed(deepest.data) & depthMask) <= static_cast<std::uint64_t>(depth) ? deepest : m_slots[index + 1] };
+
+	storeRelaxed(slot.key, key ^ data);
+	storeRelaxed(slot.data, data);
+}
+
+void PerftTable::resize(std::size_t megabytes)
+{
+	unmap();
+
+	const std::size_t count{ slotCount(megabytes, sizeof(Slot)) };
+
+	m_memory.assign(count, Slot{});
+	m_slots = m_memory;
+	m_indexMask = count - 1;
+}
+
+bool PerftTable::map(std::string_view path, std::size_t megabytes)
+{
+	unmap();
+
+	const std::size_t count{ slotCount(megabytes, sizeof(Slot)) };
+	const std::size_t bytes{ (count + 1) * sizeof(Slot) };
+	const std::string fileName{ path };
+
+#ifdef _WIN32
+	const HANDLE file{ CreateFileA(fileName.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr) };
+
+	if (file == INVALID_HANDLE_VALUE) return false;
+
+	const HANDLE mapping{ CreateFileMappingA(file, nullptr, PAGE_READWRITE, static_cast<DWORD>(static_cast<std::uint64_t>(bytes) >> 32), static_cast<DWORD>(bytes), nullptr) };
+	void* view{ mapping ? MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, bytes) : nullptr };
+
+	//the view keeps the file open by itself
+	if (mapping) CloseHandle(mapping);
+	CloseHandle(file);
+#else
+	const int file{ open(fileName.c_str(), O_RDWR | O_CREAT, 0644) };
+
+	if (file < 0) return false;
+
+	void* view{ ftruncate(file, static_cast<off_t>(bytes)) == 0 ? mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0) : MAP_FAILED };
+	view = view == MAP_FAILED ? nullptr : view;
+
+	close(file);
+#endif
+
+	if (!view)
+	{
+		resize(megabytes);
+		return false;
+	}
+
+	m_memory.clear();
+	m_memory.shrink_to_fit();
+
+	m_view = view;
+	m_viewBytes = bytes;
+
+	const std::span<Slot> slots{ static_cast<Slot*>(view), count + 1 };
+	m_slots = slots.subspan(1);
+	m_indexMask = count - 1;
+
+	Slot& header{ slots.front() };
+
+	if (header.key != fileMagic() || header.data != count)
+	{
+		clear();
+		header = Slot{ fileMagic(), count };
+	}
+
+	return true;
+}
+
+void PerftTable::clear() noexcept
+{
+	std::ranges::fill(m_slots, Slot{});
+}
\ No newline at end of file
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+
+
+// Memoizes perft subtree counts by Zobrist key and depth. The table either lives in memory or in a memory mapped file so 
+// a later run on the same file starts with every subtree counted before.
+class PerftTable
+{
+public:
+
+	//	Public Definitions
+
+	//constants
+	static constexpr std::size_t defaultMegabytes{ 256 };
+
+
+
+private:
+
+	//	Private Definitions
+
+	//types
+	// the key is stored xored with the data so a slot written by two threads at once fails verification
+	struct Slot
+	{
+		std::uint64_t key;
+		std::uint64_t data;
+	};
+
+
+
+private:
+
+	//	Private Members
+
+	std::vector<Slot> m_memory;
+	std::span<Slot> m_slots;
+	void* m_view{ nullptr };
+	std::size_t m_viewBytes{};
+	std::uint64_t m_indexMask{};
+
+
+
+private:
+
+	//	Private Methods
+
+	void unmap() noexcept;
+
+
+
+public:
+
+	//	Public Methods
+
+	//constructors
+	PerftTable(std::size_t megabytes = defaultMegabytes);
+
+	PerftTable(const PerftTable&) = delete;
+
+	PerftTable& operator=(const PerftTable&) = delete;
+
+	~PerftTable();
+
+
+
+	//getters
+	bool probe(std::uint64_t key, int depth, std::uint64_t& nodes) const noexcept;
+
+
+
+	//setters
+	void store(std::uint64_t key, int depth, std::uint64_t nodes) noexcept;
+
+	void resize(std::size_t megabytes);
+
+	bool map(std::string_view path, std::size_t megabytes);
+
+	void clear() noexcept;
+};
\ No newline at end of file
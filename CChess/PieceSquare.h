@@ -0,0 +1,24 @@
+#pragma once
+
+#include "ChessConstants.hpp"
+
+
+
+struct TaperedScore
+{
+	int middlegame;
+	int endgame;
+};
+
+
+
+// material and placement of every piece, white positive and black negative, blended by the game phase in evaluate()
+namespace PieceSquare
+{
+	// phase of the starting material, knights and bishops count one, rooks two and queens four
+	constexpr int maxPhase{ 24 };
+
+	TaperedScore score(Piece piece, int square) noexcept;
+
+	int phase(Piece piece) noexcept;
+};
\ No newline at end of file
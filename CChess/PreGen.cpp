@@ -1,13 +1,26 @@
 #include "PreGen.h"
 
+#include <array>
 #include <chrono>
 #include <iostream>
 #include <vector>
 #include <cstdint>
-#include <random>
-#include <bitset>
 #include <concepts>
+#include <string_view>
 #include <algorithm>
+#include <memory>
+#include <ostream>
+
+#if defined(_M_X64) || defined(__x86_64__)
+	#define CCHESS_PEXT
+	#include <immintrin.h>
+
+	#ifdef _MSC_VER
+		#include <intrin.h>
+	#else
+		#include <cpuid.h>
+	#endif
+#endif
 
 
 //static helpers
@@ -18,16 +31,6 @@ static std::size_t boardIndex(T rank, T file) noexcept
 	return static_cast<std::size_t>(rank * fileSize + file);
 }
 
-static std::size_t bishopMagicIndex(std::size_t square, std::size_t magicIndex)
-{
-	return square * maxBishopAttacks + magicIndex;
-}
-
-static std::size_t rookMagicIndex(std::size_t square, std::size_t magicIndex)
-{
-	return square * maxRookAttacks + magicIndex;
-}
-
 static void setSafe(BitBoard& board, int rank, int file) noexcept
 {
 	if (rank >= 0 && rank < rankSize && file >= 0 && file < fileSize)
@@ -62,24 +65,68 @@ static std::vector<BitBoard> generateOccupancies(BitBoard relavantBitsMask, std:
 	return occupancies;
 }
 
-//outside of function to remove initialization guard
-//namespace rnd
-//{
-//	static std::mt19937_64 gen{ std::random_device{}() };
-//	static std::uniform_int_distribution<std::uint64_t> dist;
-//}
-//static std::uint64_t randomMagic() noexcept
-//{
-//	return rnd::dist(rnd::gen) & rnd::dist(rnd::gen) & rnd::dist(rnd::gen);
-//}
-
-static std::uint64_t randomMagic() noexcept
+// Magic numbers for the relevant occupancy bits of every square, found once offline with a seeded xorshift search so the 
+// tables are the same on every start and nothing has to be searched at runtime.
+static constexpr std::array<std::uint64_t, boardSize> bishopMagics{
+	0x10102002004A1420ULL, 0x8020040400584008ULL, 0x10510800811201C8ULL, 0x5204042080000088ULL,
+	0x2204106880000002ULL, 0x1401042004000000ULL, 0x0400880410042004ULL, 0x0028208200A02020ULL,
+	0x1500241990010E00ULL, 0x8001200182020A40ULL, 0x40004101030B0000ULL, 0x8002041042000100ULL,
+	0x4010011041020038ULL, 0x0000010421044000ULL, 0x1500210808020A00ULL, 0x8000088400880520ULL,
+	0x0405004010040100ULL, 0x1005823210040108ULL, 0x2708008102040011ULL, 0x4048200404009100ULL,
+	0x0018104101400024ULL, 0x0003000601190101ULL, 0x8004803108491000ULL, 0x8014241200820800ULL,
+	0x0006E080100C3040ULL, 0x0501044A11041800ULL, 0x9020300008004045ULL, 0x0894080000220040ULL,
+	0x1001010083104000ULL, 0x5004030040900080ULL, 0x000400422C012400ULL, 0x0002128698404812ULL,
+	0x1010108404900440ULL, 0x0928021182084100ULL, 0x2006080409020024ULL, 0x1010202020180080ULL,
+	0xA010008200202200ULL, 0x2098015100019004ULL, 0x0002041440810811ULL, 0x802A02020000B098ULL,
+	0x0009015090004060ULL, 0x4000821082081001ULL, 0x0100210040420800ULL, 0x0800004010488A00ULL,
+	0x2000081104004040ULL, 0x4C8E029015000082ULL, 0x0420340322224842ULL, 0x1298260043400210ULL,
+	0x0000822802400008ULL, 0x00008A0101600000ULL, 0x3040003412080021ULL, 0x3040290220884800ULL,
+	0x4A1500401041004AULL, 0x8010200282020781ULL, 0x0020203142209091ULL, 0x0070300600902110ULL,
+	0x0040808800B62048ULL, 0x0000810400C44420ULL, 0x00080400440C0441ULL, 0x8340080020840411ULL,
+	0x0000000104208200ULL, 0x0000800810D00080ULL, 0x0400530411080200ULL, 0x4040702400932244ULL
+};
+
+static constexpr std::array<std::uint64_t, boardSize> rookMagics{
+	0x1080004008801020ULL, 0x0840092002C03000ULL, 0x1900200010400900ULL, 0x0880100008000480ULL,
+	0x4200100420080200ULL, 0x8100020100080400ULL, 0x0200040110886200ULL, 0x0200008040220411ULL,
+	0x0404800084400220ULL, 0x0000401000402000ULL, 0x0086001081220440ULL, 0x0408800800100280ULL,
+	0x000A001201040820ULL, 0x8848800200840080ULL, 0x4001000100040200ULL, 0x0442000102105084ULL,
+	0x9080010020804100ULL, 0x0040404000201009ULL, 0x0000808010002009ULL, 0x2200090021D00100ULL,
+	0x0008008008040080ULL, 0x0004004002010040ULL, 0x0011040008015042ULL, 0x00000A0001768104ULL,
+	0x0000800080204009ULL, 0x2010004140002001ULL, 0x9800200280100080ULL, 0x1000100080080080ULL,
+	0x0442000A00049020ULL, 0x2100040080020080ULL, 0x0800120400900148ULL, 0x0010040A00128541ULL,
+	0x2800804000800030ULL, 0x1010002000400041ULL, 0x4000200011004100ULL, 0x0610008410800800ULL,
+	0x0400802402800800ULL, 0xC100020080800400ULL, 0x0002000802000401ULL, 0x0182085882000401ULL,
+	0x0220204000808000ULL, 0x2860100040024022ULL, 0x0001002004110040ULL, 0x99101042000A0020ULL,
+	0x0004080004008080ULL, 0x0010040002008080ULL, 0x2012004881020004ULL, 0x8300842444820011ULL,
+	0x0088403882010200ULL, 0x0820400080210100ULL, 0x0110910040A00300ULL, 0x0801100280080480ULL,
+	0x0242009008200600ULL, 0x1002000489500200ULL, 0x0040800200010080ULL, 0x0091800041000080ULL,
+	0x0000209300488001ULL, 0x04C1002414824001ULL, 0x020020000B001041ULL, 0x7000100004200901ULL,
+	0x8002002004100802ULL, 0x30010002084C0007ULL, 0x0888221800813004ULL, 0x4000002840840112ULL
+};
+
+// gcc and clang only emit pext inside functions compiled for BMI2, msvc emits intrinsics for any target
+#ifdef CCHESS_PEXT
+#if defined(__GNUC__) && !defined(_MSC_VER)
+__attribute__((target("bmi2")))
+#endif
+static std::uint64_t parallelExtract(std::uint64_t bits, std::uint64_t mask) noexcept
+{
+	return _pext_u64(bits, mask);
+}
+#else
+static std::uint64_t parallelExtract(std::uint64_t bits, std::uint64_t mask) noexcept
 {
-	static std::mt19937_64 gen{ std::random_device{}() };
-	static std::uniform_int_distribution<std::uint64_t> dist;
+	std::uint64_t extracted{};
+
+	for (std::uint64_t bit{ 1 }; mask; mask &= mask - 1, bit <<= 1)
+	{
+		extracted |= (bits & mask & (~mask + 1)) ? bit : 0;
+	}
 
-	return dist(gen) & dist(gen) & dist(gen);
+	return extracted;
 }
+#endif
 
 static BitBoard generateBishopAttack(int rank, int file, BitBoard occupancy) noexcept
 {
@@ -154,23 +201,27 @@ static BitBoard generateRookAttack(int rank, int file, BitBoard occupancy) noexc
 
 
 //constructor
-PreGen::PreGen() noexcept :
+PreGen::PreGen() noexcept
+	: PreGen(pextSupported() ? SliderBackend::Pext : SliderBackend::Magic) { }
 
-	//attack tables
-	m_whitePawnAttacks(), m_blackPawnAttacks(), m_knightMoves(), m_kingMoves(), m_bishopMoves(), m_rookMoves(),
+PreGen::PreGen(SliderBackend sliderBackend) noexcept :
 
 	//magic numbers
-	m_bishopMagicData(), m_rookMagicData(), m_bishopMagics(), m_rookMagics()
+	m_bishopMagicData(), m_rookMagicData(), m_sliderBackend(sliderBackend),
+
+	//attack tables
+	m_whitePawnAttacks(), m_blackPawnAttacks(), m_knightMoves(), m_kingMoves(), m_sliderMoves(),
+
+	//line tables
+	m_betweenSquares(), m_lineSquares()
 
 {
-	std::cout << "generating tables\n";
+	std::clog << "generating tables\n";
 	const auto start{ std::chrono::high_resolution_clock::now() };
 
 	//magic numbers
 	generateBishopRelevantBits();
 	generateRookRelevantBits();
-	generateBishopMagics();
-	generateRookMagics();
 
 	//tables
 	generatePawnAttacks();
@@ -178,9 +229,81 @@ PreGen::PreGen() noexcept :
 	generateKingMoves();
 	generateBishopMoves();
 	generateRookMoves();
+	generateLines();
 
 	const std::chrono::duration<double> elapsed{ std::chrono::high_resolution_clock::now() - start };
-	std::cout << "tables generated in " << elapsed.count() << " seconds\n" << std::endl;
+	std::clog << "tables generated in " << elapsed.count() << " seconds" << (m_sliderBackend == SliderBackend::Pext ? " using pext" : "") << "\n" << std::endl;
+}
+
+
+
+//slider backend
+bool PreGen::pextSupported() noexcept
+{
+#ifdef CCHESS_PEXT
+	//CPUID leaf 7 reports BMI2 in bit 8 of ebx
+	#ifdef _MSC_VER
+		std::array<int, 4> registers{};
+		__cpuidex(registers.data(), 7, 0);
+
+		return registers[1] & (1 << 8);
+	#else
+		unsigned int eax{}, ebx{}, ecx{}, edx{};
+
+		return __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) && (ebx & (1 << 8));
+	#endif
+#else
+	return false;
+#endif
+}
+
+// looks up the same random occupancies with both backends, the checksum keeps the lookups from being optimized away
+void PreGen::benchmarkSliders(std::ostream& out)
+{
+	constexpr std::size_t lookups{ 1 << 24 };
+	constexpr std::size_t occupancyCount{ 1 << 12 };
+
+	std::vector<std::uint64_t> occupancies(occupancyCount);
+	std::uint64_t seed{ 0x9E3779B97F4A7C15ULL };
+
+	std::ranges::generate(occupancies, [&seed]() {
+		seed ^= seed >> 12;
+		seed ^= seed << 25;
+		seed ^= seed >> 27;
+		return (seed * 2685821657736338717ULL) & (seed * 0x2545F4914F6CDD1DULL);
+		});
+
+	const auto run{ [&out, &occupancies](const PreGen& preGen, std::string_view name) {
+		std::uint64_t checksum{};
+		const auto start{ std::chrono::steady_clock::now() };
+
+		for (std::size_t i{}; i < lookups; ++i)
+		{
+			const BitBoard occupancy{ occupancies[i & (occupancyCount - 1)] };
+			const std::size_t square{ i & (boardSize - 1) };
+
+			checksum += preGen.bishopMove(square, occupancy).board() ^ preGen.rookMove(square, occupancy).board();
+		}
+
+		const std::chrono::duration<double> elapsed{ std::chrono::steady_clock::now() - start };
+		out << name << ": " << elapsed.count() * 1e9 / (lookups * 2) << " ns per lookup, checksum " << checksum << '\n';
+	} };
+
+	run(*std::make_unique<PreGen>(SliderBackend::Magic), "magic");
+
+	if (pextSupported())
+	{
+		run(*std::make_unique<PreGen>(SliderBackend::Pext), "pext");
+	}
+	else
+	{
+		out << "pext: not supported on this cpu\n";
+	}
+}
+
+PreGen::SliderBackend PreGen::sliderBackend() const noexcept
+{
+	return m_sliderBackend;
 }
 
 
@@ -211,6 +334,9 @@ void PreGen::generateBishopRelevantBits() noexcept
 			{
 				m_bishopMagicData[boardIndex(rank, file)].relevantBits.set(newRank, newFile);
 			}
+
+			m_bishopMagicData[boardIndex(rank, file)].magicShift = boardSize - static_cast<int>(m_bishopMagicData[boardIndex(rank, file)].relevantBits.bitCount());
+			m_bishopMagicData[boardIndex(rank, file)].magic = bishopMagics[boardIndex(rank, file)];
 		}
 	}
 }
@@ -240,90 +366,9 @@ void PreGen::generateRookRelevantBits() noexcept
 			{
 				m_rookMagicData[boardIndex(rank, file)].relevantBits.set(rank, newFile);
 			}
-		}
-	}
-}
-
-void PreGen::generateBishopMagics() noexcept
-{
-	for (std::size_t i{}; i < boardSize; ++i)
-	{
-		const std::size_t bitCount{ m_bishopMagicData[i].relevantBits.bitCount() };
-		m_bishopMagicData[i].magicShift = boardSize - static_cast<int>(bitCount);
-
-		const std::size_t occupanciesCount{ 1ULL << bitCount };
-		const std::size_t shift{ boardSize - bitCount };
 
-		const std::vector<BitBoard> occupancies{ generateOccupancies(m_bishopMagicData[i].relevantBits, bitCount, occupanciesCount) };
-
-		while (true)
-		{
-			const std::uint64_t magic{ randomMagic() };
-			bool valid{ true };
-			std::bitset<maxBishopAttacks> indexes;
-
-			for (BitBoard occupancy : occupancies)
-			{
-				const std::size_t index{ (occupancy.board() * magic) >> shift };
-
-				if (indexes.test(index))
-				{
-					valid = false;
-					break;
-				}
-				else
-				{
-					indexes.set(index);
-				}
-			}
-
-			if (valid)
-			{
-				m_bishopMagics[i] = magic;
-				break;
-			}
-		}
-	}
-}
-
-void PreGen::generateRookMagics() noexcept
-{
-	for (std::size_t i{}; i < boardSize; ++i)
-	{
-		const std::size_t bitCount{ m_rookMagicData[i].relevantBits.bitCount() };
-		m_rookMagicData[i].magicShift = boardSize - static_cast<int>(bitCount);
-
-		const std::size_t occupanciesCount{ 1ULL << bitCount };
-		const std::size_t shift{ boardSize - bitCount };
-
-		const std::vector<BitBoard> occupancies{ generateOccupancies(m_rookMagicData[i].relevantBits, bitCount, occupanciesCount) };
-		
-		while (true)
-		{
-			const std::uint64_t magic{ randomMagic() };
-			bool valid{ true };
-			std::bitset<maxRookAttacks> indexes;
-
-			for (BitBoard occupancy : occupancies)
-			{
-				const std::size_t index{ (occupancy.board() * magic) >> shift };
-
-				if (indexes.test(index))
-				{
-					valid = false;
-					break;
-				}
-				else
-				{
-					indexes.set(index);
-				}
-			}
-
-			if (valid)
-			{
-				m_rookMagics[i] = magic;
-				break;
-			}
+			m_rookMagicData[boardIndex(rank, file)].magicShift = boardSize - static_cast<int>(m_rookMagicData[boardIndex(rank, file)].relevantBits.bitCount());
+			m_rookMagicData[boardIndex(rank, file)].magic = rookMagics[boardIndex(rank, file)];
 		}
 	}
 }
@@ -401,6 +446,8 @@ void PreGen::generateKingMoves() noexcept
 
 void PreGen::generateBishopMoves() noexcept
 {
+	std::uint32_t offset{};
+
 	for (int rank{}; rank < rankSize; ++rank)
 	{
 		for (int file{}; file < fileSize; ++file)
@@ -410,13 +457,20 @@ void PreGen::generateBishopMoves() noexcept
 			const std::size_t occupanciesCount{ 1ULL << bitCount };
 			const std::size_t shift{ boardSize - bitCount };
 
+			//each square only takes as many entries as it has occupancies
+			m_bishopMagicData[square].offset = offset;
+			offset += static_cast<std::uint32_t>(occupanciesCount);
+
 			std::vector<BitBoard> occupancies{ generateOccupancies(m_bishopMagicData[square].relevantBits, bitCount, occupanciesCount) };
 			
 			for (BitBoard occupancy : occupancies)
 			{
 				const BitBoard attack{ generateBishopAttack(rank, file, occupancy) };
-				const std::size_t magicIndex{ (occupancy.board() * m_bishopMagics[square]) >> shift };
-				m_bishopMoves[bishopMagicIndex(square, magicIndex)] = attack;
+				const std::size_t magicIndex{ m_sliderBackend == SliderBackend::Pext
+					? parallelExtract(occupancy.board(), m_bishopMagicData[square].relevantBits.board())
+					: (occupancy.board() * m_bishopMagicData[square].magic) >> shift };
+
+				m_sliderMoves[m_bishopMagicData[square].offset + magicIndex] = attack;
 			}
 		}
 	}
@@ -424,6 +478,8 @@ void PreGen::generateBishopMoves() noexcept
 
 void PreGen::generateRookMoves() noexcept
 {
+	std::uint32_t offset{ bishopAttacksSize };
+
 	for (int rank{}; rank < rankSize; ++rank)
 	{
 		for (int file{}; file < fileSize; ++file)
@@ -433,14 +489,52 @@ void PreGen::generateRookMoves() noexcept
 			const std::size_t occupanciesCount{ 1ULL << bitCount };
 			const std::size_t shift{ boardSize - bitCount };
 
+			m_rookMagicData[square].offset = offset;
+			offset += static_cast<std::uint32_t>(occupanciesCount);
+
 			std::vector<BitBoard> occupancies{ generateOccupancies(m_rookMagicData[square].relevantBits, bitCount, occupanciesCount) };
 
 			for (BitBoard occupancy : occupancies)
 			{
 				const BitBoard attack{ generateRookAttack(rank, file, occupancy) };
+				const std::size_t magicIndex{ m_sliderBackend == SliderBackend::Pext
+					? parallelExtract(occupancy.board(), m_rookMagicData[square].relevantBits.board())
+					: (occupancy.board() * m_rookMagicData[square].magic) >> shift };
+
+				m_sliderMoves[m_rookMagicData[square].offset + magicIndex] = attack;
+			}
+		}
+	}
+}
+
+void PreGen::generateLines() noexcept
+{
+	for (int from{}; from < boardSize; ++from)
+	{
+		const int fromRank{ from / fileSize };
+		const int fromFile{ from % fileSize };
+		const BitBoard fromBishop{ generateBishopAttack(fromRank, fromFile, BitBoard()) };
+		const BitBoard fromRook{ generateRookAttack(fromRank, fromFile, BitBoard()) };
+
+		for (int to{}; to < boardSize; ++to)
+		{
+			const int toRank{ to / fileSize };
+			const int toFile{ to % fileSize };
+			const std::size_t index{ static_cast<std::size_t>(from * boardSize + to) };
+			const std::uint64_t ends{ (1ULL << from) | (1ULL << to) };
 
-				const std::size_t magicIndex{ (occupancy.board() * m_rookMagics[square]) >> shift };
-				m_rookMoves[rookMagicIndex(square, magicIndex)] = attack;
+			//squares strictly between the two and the whole line through both, empty if they do not share a line
+			if (fromBishop.test(to))
+			{
+				const BitBoard toBishop{ generateBishopAttack(toRank, toFile, BitBoard()) };
+				m_betweenSquares[index] = generateBishopAttack(fromRank, fromFile, BitBoard(1ULL << to)).board() & generateBishopAttack(toRank, toFile, BitBoard(1ULL << from)).board();
+				m_lineSquares[index] = (fromBishop.board() & toBishop.board()) | ends;
+			}
+			else if (fromRook.test(to))
+			{
+				const BitBoard toRook{ generateRookAttack(toRank, toFile, BitBoard()) };
+				m_betweenSquares[index] = generateRookAttack(fromRank, fromFile, BitBoard(1ULL << to)).board() & generateRookAttack(toRank, toFile, BitBoard(1ULL << from)).board();
+				m_lineSquares[index] = (fromRook.board() & toRook.board()) | ends;
 			}
 		}
 	}
@@ -471,18 +565,32 @@ BitBoard PreGen::kingMove(std::size_t index) const noexcept
 
 BitBoard PreGen::bishopMove(std::size_t index, BitBoard occupancy) const noexcept
 {
-	const std::size_t magic{ m_bishopMagics[index] };
-	const std::uint64_t relevantBits{ occupancy.board() & m_bishopMagicData[index].relevantBits.board() };
-	const std::size_t attackIndex{ (relevantBits * magic) >> m_bishopMagicData[index].magicShift };
+	const MagicData& data{ m_bishopMagicData[index] };
+	const std::uint64_t mask{ data.relevantBits.board() };
+	const std::size_t attackIndex{ m_sliderBackend == SliderBackend::Pext
+		? parallelExtract(occupancy.board(), mask)
+		: ((occupancy.board() & mask) * data.magic) >> data.magicShift };
 
-	return m_bishopMoves[bishopMagicIndex(index, attackIndex)];
+	return m_sliderMoves[data.offset + attackIndex];
 }
 
 BitBoard PreGen::rookMove(std::size_t index, BitBoard occupancy) const noexcept
 {
-	const std::size_t magic{ m_rookMagics[index] };
-	const std::uint64_t relevantBits{ occupancy.board() & m_rookMagicData[index].relevantBits.board() };
-	const std::size_t attackIndex{ (relevantBits * magic) >> m_rookMagicData[index].magicShift };
+	const MagicData& data{ m_rookMagicData[index] };
+	const std::uint64_t mask{ data.relevantBits.board() };
+	const std::size_t attackIndex{ m_sliderBackend == SliderBackend::Pext
+		? parallelExtract(occupancy.board(), mask)
+		: ((occupancy.board() & mask) * data.magic) >> data.magicShift };
 
-	return m_rookMoves[rookMagicIndex(index, attackIndex)];
+	return m_sliderMoves[data.offset + attackIndex];
+}
+
+BitBoard PreGen::between(std::size_t from, std::size_t to) const noexcept
+{
+	return m_betweenSquares[from * boardSize + to];
+}
+
+BitBoard PreGen::line(std::size_t from, std::size_t to) const noexcept
+{
+	return m_lineSquares[from * boardSize + to];
 }
\ No newline at end of file
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <array>
+#include <cstdint>
+#include <ostream>
 
 #include "ChessConstants.hpp"
 #include "BitBoard.h"
@@ -9,36 +11,55 @@
 
 
 
-constexpr int maxBishopAttacks{ 512 };
-constexpr int maxRookAttacks{ 4096 };
+// every square gets exactly 2^relevant bits attack sets in one shared arena, bishops first and rooks after them
+constexpr int bishopAttacksSize{ 5248 };
+constexpr int rookAttacksSize{ 102400 };
 
 
 
 class cachealign PreGen
 {
+	/* Class Definitions */
+
+public:
+
+	// how the slider tables are indexed, pext needs BMI2 and is only picked when CPUID reports it
+	enum class SliderBackend : std::uint8_t
+	{
+		Magic,
+		Pext
+	};
+
+
+
 	/* Class Members*/
 
 private:
 
-	struct alignas(16) MagicData
+	// everything one slider lookup reads besides the attack set, aligned so it never straddles a cache line
+	struct alignas(32) MagicData
 	{
 		BitBoard relevantBits;
+		std::uint64_t magic;
+		std::uint32_t offset;
 		int magicShift;
 	};
 
-	//magic numbers //TODO: use stockfish method.
+	//magic numbers
 	std::array<MagicData, boardSize> m_bishopMagicData;
 	std::array<MagicData, boardSize> m_rookMagicData;
-	std::array<std::uint64_t, boardSize> m_bishopMagics;
-	std::array<std::uint64_t, boardSize> m_rookMagics;
+	SliderBackend m_sliderBackend;
 
 	//attack tables
 	std::array<BitBoard, boardSize> m_whitePawnAttacks;
 	std::array<BitBoard, boardSize> m_blackPawnAttacks;
 	std::array<BitBoard, boardSize> m_knightMoves; 
 	std::array<BitBoard, boardSize> m_kingMoves;
-	std::array<BitBoard, boardSize * maxBishopAttacks> m_bishopMoves;
-	std::array<BitBoard, boardSize * maxRookAttacks> m_rookMoves;
+	std::array<BitBoard, bishopAttacksSize + rookAttacksSize> m_sliderMoves;
+
+	//line tables
+	std::array<BitBoard, boardSize * boardSize> m_betweenSquares;
+	std::array<BitBoard, boardSize * boardSize> m_lineSquares;
 
 
 
@@ -52,10 +73,6 @@ private:
 
 	void generateRookRelevantBits() noexcept;
 
-	void generateBishopMagics() noexcept;
-
-	void generateRookMagics() noexcept;
-
 
 
 	//tables
@@ -69,6 +86,8 @@ private:
 
 	void generateRookMoves() noexcept;
 
+	void generateLines() noexcept;
+
 
 
 public:
@@ -76,6 +95,17 @@ public:
 	//constructor
 	PreGen() noexcept;
 
+	PreGen(SliderBackend sliderBackend) noexcept;
+
+
+
+	//slider backend
+	static bool pextSupported() noexcept;
+
+	static void benchmarkSliders(std::ostream& out);
+
+	SliderBackend sliderBackend() const noexcept;
+
 
 
 	//getters
@@ -90,5 +120,9 @@ public:
 	BitBoard bishopMove(std::size_t index, BitBoard occupancy) const noexcept;
 
 	BitBoard rookMove(std::size_t index, BitBoard occupancy) const noexcept;
+
+	BitBoard between(std::size_t from, std::size_t to) const noexcept;
+
+	BitBoard line(std::size_t from, std::size_t to) const noexcept;
 };
 
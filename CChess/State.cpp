@@ -6,15 +6,42 @@
 #include <span>
 #include <stdexcept>
 #include <algorithm>
+#include <charconv>
 
 #include "Move.h"
 #include "ChessConstants.hpp"
 #include "BitBoard.h"
+#include "MoveGen.h"
+#include "Zobrist.h"
+#include "PieceSquare.h"
+#include "Nnue.h"
 
 
 
 // Static Helpers
 
+static constexpr std::size_t fenFieldCount{ 6 };
+
+// splits a FEN on spaces, missing fields are left empty
+static std::array<std::string_view, fenFieldCount> fenFields(std::string_view position) noexcept
+{
+	std::array<std::string_view, fenFieldCount> fields{};
+
+	for (std::string_view& field : fields)
+	{
+		const std::size_t start{ position.find_first_not_of(' ') };
+		if (start == std::string_view::npos) break;
+
+		position = position.substr(start);
+		const std::size_t end{ std::min(position.find(' '), position.size()) };
+
+		field = position.substr(0, end);
+		position = position.substr(end);
+	}
+
+	return fields;
+}
+
 static consteval std::array<Piece, 255>  generateCharToPiece()
 {
 	std::array<Piece, 255> table{};
@@ -44,6 +71,25 @@ static char pieceToChar(Piece piece)
 
 static constexpr std::array<Piece, 255> charToPiece{ generateCharToPiece() };
 
+// the rook's source and destination square
+static std::array<int, 2> castleRookSquares(Castle castle) noexcept
+{
+	switch (castle)
+	{
+	case Castle::WhiteKingSide: return { h1, f1 };
+	case Castle::WhiteQueenSide: return { a1, d1 };
+	case Castle::BlackKingSide: return { h8, f8 };
+	default: return { a8, d8 };
+	}
+}
+
+static std::uint64_t materialUnit(Piece piece) noexcept
+{
+	const bool king{ piece == Piece::WhiteKing || piece == Piece::BlackKing };
+
+	return king ? 0 : 1ULL << (static_cast<int>(piece) * State::materialKeyBits);
+}
+
 
 //	Private Methods
 
@@ -87,6 +133,33 @@ void State::movePiece(Piece piece, int sourceIndex, int destinationIndex) noexce
 {
 	m_pieceOccupancy[static_cast<std::size_t>(piece)].reset(sourceIndex);
 	m_pieceOccupancy[static_cast<std::size_t>(piece)].set(destinationIndex);
+	m_board[sourceIndex] = Piece::NoPiece;
+	m_board[destinationIndex] = piece;
+	m_hash ^= Zobrist::pieceKey(piece, sourceIndex) ^ Zobrist::pieceKey(piece, destinationIndex);
+	m_pawnHash ^= Zobrist::pawnKey(piece, sourceIndex) ^ Zobrist::pawnKey(piece, destinationIndex);
+
+	const TaperedScore sourceScore{ PieceSquare::score(piece, sourceIndex) };
+	const TaperedScore destinationScore{ PieceSquare::score(piece, destinationIndex) };
+	m_score.middlegame += destinationScore.middlegame - sourceScore.middlegame;
+	m_score.endgame += destinationScore.endgame - sourceScore.endgame;
+}
+
+void State::addMaterial(Piece piece, int index) noexcept
+{
+	const TaperedScore score{ PieceSquare::score(piece, index) };
+	m_score.middlegame += score.middlegame;
+	m_score.endgame += score.endgame;
+	m_phase += PieceSquare::phase(piece);
+	m_materialKey += materialUnit(piece);
+}
+
+void State::removeMaterial(Piece piece, int index) noexcept
+{
+	const TaperedScore score{ PieceSquare::score(piece, index) };
+	m_score.middlegame -= score.middlegame;
+	m_score.endgame -= score.endgame;
+	m_phase -= PieceSquare::phase(piece);
+	m_materialKey -= materialUnit(piece);
 }
 
 void State::testCastleRights(bool white, Piece sourcePiece, int sourceIndex) noexcept
@@ -211,6 +284,9 @@ void State::moveCapture(bool white, Piece sourcePiece, Piece capturePiece, int s
 	moveOccupancyCapture(white, sourceIndex, destinationIndex);
 	movePiece(sourcePiece, sourceIndex, destinationIndex);
 	m_pieceOccupancy[static_cast<std::size_t>(capturePiece)].reset(destinationIndex);
+	m_hash ^= Zobrist::pieceKey(capturePiece, destinationIndex);
+	m_pawnHash ^= Zobrist::pawnKey(capturePiece, destinationIndex);
+	removeMaterial(capturePiece, destinationIndex);
 }
 
 
@@ -242,6 +318,10 @@ void State::moveEnpassant(bool white, Piece sourcePiece, Piece capturePiece, int
 	movePiece(sourcePiece, sourceIndex, destinationIndex);
 
 	m_pieceOccupancy[static_cast<std::size_t>(capturePiece)].reset(enpassantIndex);
+	m_board[enpassantIndex] = Piece::NoPiece;
+	m_hash ^= Zobrist::pieceKey(capturePiece, enpassantIndex);
+	m_pawnHash ^= Zobrist::pieceKey(capturePiece, enpassantIndex);
+	removeMaterial(capturePiece, enpassantIndex);
 }
 
 
@@ -305,6 +385,51 @@ void State::unmoveCastle(Castle castle) noexcept
 
 
 
+//unmove
+void State::unmoveCapture(bool white, Piece sourcePiece, Piece capturePiece, int sourceIndex, int destinationIndex) noexcept
+{
+	moveOccupancy(white, destinationIndex, sourceIndex);
+	movePiece(sourcePiece, destinationIndex, sourceIndex);
+
+	m_occupancy.set(destinationIndex);
+	(white ? m_blackOccupancy : m_whiteOccupancy).set(destinationIndex);
+	m_pieceOccupancy[static_cast<std::size_t>(capturePiece)].set(destinationIndex);
+	m_board[destinationIndex] = capturePiece;
+}
+
+void State::unmoveEnpassant(bool white, Piece sourcePiece, Piece capturePiece, int sourceIndex, int destinationIndex, int enpassantIndex) noexcept
+{
+	moveOccupancy(white, destinationIndex, sourceIndex);
+	movePiece(sourcePiece, destinationIndex, sourceIndex);
+
+	m_occupancy.set(enpassantIndex);
+	(white ? m_blackOccupancy : m_whiteOccupancy).set(enpassantIndex);
+	m_pieceOccupancy[static_cast<std::size_t>(capturePiece)].set(enpassantIndex);
+	m_board[enpassantIndex] = capturePiece;
+}
+
+void State::unmoveQuietPromote(bool white, Piece sourcePiece, Piece promotePiece, int sourceIndex, int destinationIndex) noexcept
+{
+	moveOccupancy(white, destinationIndex, sourceIndex);
+
+	m_pieceOccupancy[static_cast<std::size_t>(promotePiece)].reset(destinationIndex);
+	m_pieceOccupancy[static_cast<std::size_t>(sourcePiece)].set(sourceIndex);
+	m_board[destinationIndex] = Piece::NoPiece;
+	m_board[sourceIndex] = sourcePiece;
+}
+
+void State::unmoveCapturePromote(bool white, Piece sourcePiece, Piece attackPiece, Piece promotePiece, int sourceIndex, int destinationIndex) noexcept
+{
+	unmoveQuietPromote(white, sourcePiece, promotePiece, sourceIndex, destinationIndex);
+
+	m_occupancy.set(destinationIndex);
+	(white ? m_blackOccupancy : m_whiteOccupancy).set(destinationIndex);
+	m_pieceOccupancy[static_cast<std::size_t>(attackPiece)].set(destinationIndex);
+	m_board[destinationIndex] = attackPiece;
+}
+
+
+
 //promote
 void State::moveQuietPromote(bool white, Piece sourcePiece, Piece promotePiece, int sourceIndex, int destinationIndex) noexcept
 {
@@ -312,6 +437,12 @@ void State::moveQuietPromote(bool white, Piece sourcePiece, Piece promotePiece,
 
 	m_pieceOccupancy[static_cast<std::size_t>(sourcePiece)].reset(sourceIndex);
 	m_pieceOccupancy[static_cast<std::size_t>(promotePiece)].set(destinationIndex);
+	m_board[sourceIndex] = Piece::NoPiece;
+	m_board[destinationIndex] = promotePiece;
+	m_hash ^= Zobrist::pieceKey(sourcePiece, sourceIndex) ^ Zobrist::pieceKey(promotePiece, destinationIndex);
+	m_pawnHash ^= Zobrist::pieceKey(sourcePiece, sourceIndex);
+	removeMaterial(sourcePiece, sourceIndex);
+	addMaterial(promotePiece, destinationIndex);
 }
 
 void State::moveCapturePromote(bool white, Piece sourcePiece, Piece attackPiece, Piece promotePiece, int sourceIndex, int destinationIndex) noexcept
@@ -322,6 +453,74 @@ void State::moveCapturePromote(bool white, Piece sourcePiece, Piece attackPiece,
 	m_pieceOccupancy[static_cast<std::size_t>(sourcePiece)].reset(sourceIndex);
 	m_pieceOccupancy[static_cast<std::size_t>(attackPiece)].reset(destinationIndex);
 	m_pieceOccupancy[static_cast<std::size_t>(promotePiece)].set(destinationIndex);
+	m_board[sourceIndex] = Piece::NoPiece;
+	m_board[destinationIndex] = promotePiece;
+	m_hash ^= Zobrist::pieceKey(sourcePiece, sourceIndex) ^ Zobrist::pieceKey(attackPiece, destinationIndex) ^ Zobrist::pieceKey(promotePiece, destinationIndex);
+	m_pawnHash ^= Zobrist::pieceKey(sourcePiece, sourceIndex) ^ Zobrist::pawnKey(attackPiece, destinationIndex);
+	removeMaterial(sourcePiece, sourceIndex);
+	removeMaterial(attackPiece, destinationIndex);
+	addMaterial(promotePiece, destinationIndex);
+}
+
+
+
+//network
+// a king move changes every feature of its own view, that view is rebuilt after the pieces that moved with it are updated 
+// in both views, the other view only needs those
+void State::updateAccumulator(bool white, Move move, bool unmake) noexcept
+{
+	const int whiteKing{ pieceOccupancyT<Piece::WhiteKing>().leastSignificantBit() };
+	const int blackKing{ pieceOccupancyT<Piece::BlackKing>().leastSignificantBit() };
+
+	if (move.castleFlag())
+	{
+		const std::array<int, 2> rookSquares{ castleRookSquares(move.castleType()) };
+		const Piece rook{ white ? Piece::WhiteRook : Piece::BlackRook };
+
+		m_network->removePiece(m_accumulator, rook, rookSquares[unmake ? 1 : 0], whiteKing, blackKing);
+		m_network->addPiece(m_accumulator, rook, rookSquares[unmake ? 0 : 1], whiteKing, blackKing);
+		m_network->refreshView(m_accumulator, m_board, white, white ? whiteKing : blackKing);
+
+		return;
+	}
+
+	const Piece sourcePiece{ move.sourcePiece() };
+	const Piece capturePiece{ move.attackPiece() };
+
+	if (sourcePiece == Piece::WhiteKing || sourcePiece == Piece::BlackKing)
+	{
+		if (capturePiece != Piece::NoPiece)
+		{
+			if (unmake)
+			{
+				m_network->addPiece(m_accumulator, capturePiece, move.destinationIndex(), whiteKing, blackKing);
+			}
+			else
+			{
+				m_network->removePiece(m_accumulator, capturePiece, move.destinationIndex(), whiteKing, blackKing);
+			}
+		}
+
+		m_network->refreshView(m_accumulator, m_board, white, white ? whiteKing : blackKing);
+
+		return;
+	}
+
+	const Piece destinationPiece{ move.promotePiece() == Piece::NoPiece ? sourcePiece : move.promotePiece() };
+	const int captureIndex{ move.enpassantFlag() ? move.enpassantIndex() + (white ? 32 : 24) : move.destinationIndex() };
+
+	if (unmake)
+	{
+		m_network->removePiece(m_accumulator, destinationPiece, move.destinationIndex(), whiteKing, blackKing);
+		m_network->addPiece(m_accumulator, sourcePiece, move.sourceIndex(), whiteKing, blackKing);
+		if (capturePiece != Piece::NoPiece) m_network->addPiece(m_accumulator, capturePiece, captureIndex, whiteKing, blackKing);
+	}
+	else
+	{
+		m_network->removePiece(m_accumulator, sourcePiece, move.sourceIndex(), whiteKing, blackKing);
+		if (capturePiece != Piece::NoPiece) m_network->removePiece(m_accumulator, capturePiece, captureIndex, whiteKing, blackKing);
+		m_network->addPiece(m_accumulator, destinationPiece, move.destinationIndex(), whiteKing, blackKing);
+	}
 }
 
 
@@ -332,10 +531,11 @@ void State::moveCapturePromote(bool white, Piece sourcePiece, Piece attackPiece,
 State::State(std::string_view fen, Castle castle)
 	: m_castleRights(castle)
 { 
-	std::size_t coreEndIndex{ fen.find(' ') };
-	std::string_view coreFen{ fen.substr(0, coreEndIndex) };
+	//the fields are split like fromFen splits them, so a missing or empty side to move field is white to move
+	const std::array<std::string_view, fenFieldCount> fields{ fenFields(fen) };
+	std::string_view coreFen{ fields[0] };
 	
-	const bool whiteToMove{ fen[coreEndIndex + 1] == 'w' };
+	const bool whiteToMove{ fields[1] != "b" };
 
 
 	for (std::size_t i{}; i < rankSize; ++i)
@@ -359,6 +559,10 @@ State::State(std::string_view fen, Castle castle)
 
 				m_occupancy.set(static_cast<int>(boardIndex));
 				m_pieceOccupancy[static_cast<std::size_t>(piece)].set(static_cast<int>(boardIndex));
+				m_board[boardIndex] = piece;
+				m_hash ^= Zobrist::pieceKey(piece, static_cast<int>(boardIndex));
+				m_pawnHash ^= Zobrist::pawnKey(piece, static_cast<int>(boardIndex));
+				addMaterial(piece, static_cast<int>(boardIndex));
 
 				if (white)
 				{
@@ -375,11 +579,52 @@ State::State(std::string_view fen, Castle castle)
 
 		coreFen = coreFen.substr(slashIndex + 1);
 	}
+
+	m_hash ^= Zobrist::castleKey(m_castleRights);
+
+	if (!whiteToMove)
+	{
+		m_hash ^= Zobrist::sideKey();
+	}
 }
 
 State State::fromFen(std::string_view position)
 {
-	throw std::logic_error("Method 'State::fromFen' is not implimented!");
+	const std::array<std::string_view, fenFieldCount> fields{ fenFields(position) };
+
+	Castle castle{ Castle::None };
+
+	std::ranges::for_each(fields[2], [&castle](char c) {
+		switch (c)
+		{
+		case 'K': castle ^= Castle::WhiteKingSide; break;
+		case 'Q': castle ^= Castle::WhiteQueenSide; break;
+		case 'k': castle ^= Castle::BlackKingSide; break;
+		case 'q': castle ^= Castle::BlackQueenSide; break;
+		}
+		});
+
+	//the constructor reads the board and the side to move
+	State state{ position, castle };
+
+	const std::string_view enpassant{ fields[3] };
+
+	if (enpassant.size() == 2 && enpassant[0] >= 'a' && enpassant[0] <= 'h' && enpassant[1] >= '1' && enpassant[1] <= '8')
+	{
+		const int enpassantIndex{ (enpassant[1] - '1') * fileSize + (enpassant[0] - 'a') };
+
+		state.m_enpassantSquare = BitBoard(1ULL << enpassantIndex);
+		state.m_hash ^= Zobrist::enpassantKey(state.m_enpassantSquare);
+	}
+
+	std::from_chars(fields[4].data(), fields[4].data() + fields[4].size(), state.m_halfmoveClock);
+
+	return state;
+}
+
+bool State::fenWhiteToMove(std::string_view position) noexcept
+{
+	return fenFields(position)[1] != "b";
 }
 
 State State::fromChar(std::string_view position)
@@ -402,11 +647,7 @@ State::CharPosition State::charPosition() const noexcept
 
 	for (int i{}; i < boardSize; ++i)
 	{
-		const Piece whitePiece{ findPiece<true>(i) };
-		const Piece blackPiece{ findPiece<false>(i) };
-		const Piece piece{ whitePiece != Piece::NoPiece ? whitePiece : blackPiece };
-
-		position[i] = pieceToChar(piece);
+		position[i] = pieceToChar(m_board[i]);
 	}
 
 	return position;
@@ -459,46 +700,92 @@ bool State::castleBlackQueenSide() const noexcept
 
 bool State::whiteKingInCheck() const noexcept
 {
-	return m_blackSquares.board() & pieceOccupancyT<Piece::WhiteKing>().board();
+	return MoveGen::squareAttacked(false, pieceOccupancyT<Piece::WhiteKing>().leastSignificantBit(), *this);
 }
 
 bool State::blackKingInCheck() const noexcept
 {
-	return m_whiteSquares.board() & pieceOccupancyT<Piece::BlackKing>().board();
+	return MoveGen::squareAttacked(true, pieceOccupancyT<Piece::BlackKing>().leastSignificantBit(), *this);
 }
 
+//the full attack maps are only needed by the evaluation so they are computed on demand instead of after every move
 BitBoard State::whiteSquares() const noexcept
 {
-	return m_whiteSquares;
+	return MoveGen::attackedSquares(true, *this).board() & ~m_whiteOccupancy.board();
 }
 
 BitBoard State::blackSquares() const noexcept
 {
-	return m_blackSquares;
+	return MoveGen::attackedSquares(false, *this).board() & ~m_blackOccupancy.board();
+}
+
+std::uint64_t State::hash() const noexcept
+{
+	return m_hash;
+}
+
+std::uint64_t State::pawnHash() const noexcept
+{
+	return m_pawnHash;
+}
+
+int State::halfmoveClock() const noexcept
+{
+	return m_halfmoveClock;
+}
+
+int State::pliesSinceNullMove() const noexcept
+{
+	return m_pliesSinceNullMove;
+}
+
+TaperedScore State::score() const noexcept
+{
+	return m_score;
 }
 
+int State::phase() const noexcept
+{
+	return m_phase;
+}
 
+std::uint64_t State::materialKey() const noexcept
+{
+	return m_materialKey;
+}
 
-//setters
-void State::setWhiteSquares(BitBoard squares) noexcept
+int State::materialCount(std::uint64_t materialKey, Piece piece) noexcept
 {
-	m_whiteSquares = squares;
+	return static_cast<int>((materialKey >> (static_cast<int>(piece) * materialKeyBits)) & ((1ULL << materialKeyBits) - 1));
 }
 
-void State::setBlackSquares(BitBoard squares) noexcept
+const Nnue::Accumulator& State::accumulator() const noexcept
 {
-	m_blackSquares = squares;
+	return m_accumulator;
+}
+
+const Nnue* State::network() const noexcept
+{
+	return m_network;
 }
 
 
 
 //move 
-void State::makeMove(bool white, Move move) noexcept //TODO: could I make this a switch? GGGGRRRRAAATATATATATATA
+State::Undo State::makeMove(bool white, Move move) noexcept //TODO: could I make this a switch? GGGGRRRRAAATATATATATATA
 {
 	const int sourceIndex{ move.sourceIndex() };
 	const int destinationIndex{ move.destinationIndex() };
 	const Piece sourcePiece{ move.sourcePiece() };
+	const Undo undo{ m_enpassantSquare, m_hash, m_pawnHash, m_castleRights, m_halfmoveClock, m_pliesSinceNullMove, m_score, m_phase, m_materialKey };
+
+	const bool irreversible{ !move.castleFlag() 
+		&& (move.attackPiece() != Piece::NoPiece || sourcePiece == Piece::WhitePawn || sourcePiece == Piece::BlackPawn) };
+	m_halfmoveClock = irreversible ? 0 : m_halfmoveClock + 1;
+	++m_pliesSinceNullMove;
 
+	//castle rights and the enpassant square are hashed out here and back in once the move is done
+	m_hash ^= Zobrist::castleKey(m_castleRights) ^ Zobrist::enpassantKey(m_enpassantSquare) ^ Zobrist::sideKey();
 	m_enpassantSquare = BitBoard();
 
 	if (move.castleFlag()) [[unlikely]]
@@ -559,8 +846,101 @@ void State::makeMove(bool white, Move move) noexcept //TODO: could I make this a
 			}
 		}
 	}
+
+	m_hash ^= Zobrist::castleKey(m_castleRights) ^ Zobrist::enpassantKey(m_enpassantSquare);
+
+	if (m_network)
+	{
+		updateAccumulator(white, move, false);
+	}
+
+	return undo;
+}
+
+void State::unmakeMove(bool white, Move move, const Undo& undo) noexcept
+{
+	const int sourceIndex{ move.sourceIndex() };
+	const int destinationIndex{ move.destinationIndex() };
+	const Piece sourcePiece{ move.sourcePiece() };
+	const Piece capturePiece{ move.attackPiece() };
+	const Piece promotePiece{ move.promotePiece() };
+
+	if (move.castleFlag()) [[unlikely]]
+	{
+		unmoveCastle(move.castleType());
+	}
+	else if (move.enpassantFlag()) [[unlikely]]
+	{
+		const int enpassantIndex{ move.enpassantIndex() + (white ? 32 : 24) };
+		unmoveEnpassant(white, sourcePiece, capturePiece, sourceIndex, destinationIndex, enpassantIndex);
+	}
+	else if (promotePiece == Piece::NoPiece) [[likely]]
+	{
+		if (capturePiece == Piece::NoPiece)
+		{
+			moveQuiet(white, sourcePiece, destinationIndex, sourceIndex);
+		}
+		else
+		{
+			unmoveCapture(white, sourcePiece, capturePiece, sourceIndex, destinationIndex);
+		}
+	}
+	else
+	{
+		if (capturePiece == Piece::NoPiece)
+		{
+			unmoveQuietPromote(white, sourcePiece, promotePiece, sourceIndex, destinationIndex);
+		}
+		else
+		{
+			unmoveCapturePromote(white, sourcePiece, capturePiece, promotePiece, sourceIndex, destinationIndex);
+		}
+	}
+
+	//everything that can not be recomputed from the move comes back from the undo record, including the hash and the scores
+	m_enpassantSquare = undo.enpassantSquare;
+	m_hash = undo.hash;
+	m_pawnHash = undo.pawnHash;
+	m_castleRights = undo.castleRights;
+	m_halfmoveClock = undo.halfmoveClock;
+	m_pliesSinceNullMove = undo.pliesSinceNullMove;
+	m_score = undo.score;
+	m_phase = undo.phase;
+	m_materialKey = undo.materialKey;
+
+	if (m_network)
+	{
+		updateAccumulator(white, move, true);
+	}
+}
+
+
+State::Undo State::makeNullMove() noexcept
+{
+	const Undo undo{ m_enpassantSquare, m_hash, m_pawnHash, m_castleRights, m_halfmoveClock, m_pliesSinceNullMove, m_score, m_phase, m_materialKey };
+
+	m_hash ^= Zobrist::enpassantKey(m_enpassantSquare) ^ Zobrist::enpassantKey(BitBoard()) ^ Zobrist::sideKey();
+	m_enpassantSquare = BitBoard();
+	m_pliesSinceNullMove = 0;
+
+	return undo;
+}
+
+void State::unmakeNullMove(const Undo& undo) noexcept
+{
+	m_enpassantSquare = undo.enpassantSquare;
+	m_hash = undo.hash;
+	m_pliesSinceNullMove = undo.pliesSinceNullMove;
 }
 
+void State::setNetwork(const Nnue* network) noexcept
+{
+	m_network = network && network->loaded() ? network : nullptr;
+
+	if (!m_network) return;
+
+	m_network->refresh(m_accumulator, m_board, pieceOccupancyT<Piece::WhiteKing>().leastSignificantBit(), pieceOccupancyT<Piece::BlackKing>().leastSignificantBit());
+}
 
 
 //compare
@@ -570,10 +950,18 @@ bool State::operator==(const State& other) const noexcept
 		m_whiteOccupancy == other.m_whiteOccupancy &&
 		m_blackOccupancy == other.m_blackOccupancy &&
 		m_enpassantSquare == other.m_enpassantSquare &&
-		m_whiteSquares == other.m_whiteSquares &&
-		m_blackSquares == other.m_blackSquares &&
 		m_pieceOccupancy == other.m_pieceOccupancy &&
-		m_castleRights == other.m_castleRights;
+		m_board == other.m_board &&
+		m_castleRights == other.m_castleRights &&
+		m_hash == other.m_hash &&
+		m_pawnHash == other.m_pawnHash &&
+		m_halfmoveClock == other.m_halfmoveClock &&
+		m_pliesSinceNullMove == other.m_pliesSinceNullMove &&
+		m_score.middlegame == other.m_score.middlegame &&
+		m_score.endgame == other.m_score.endgame &&
+		m_phase == other.m_phase &&
+		m_materialKey == other.m_materialKey &&
+		m_accumulator.values == other.m_accumulator.values;
 }
 
 
@@ -583,18 +971,7 @@ void State::print() const noexcept
 {
 	constexpr std::array<char, pieceCount> pieceToChar{ '.', 'P', 'N', 'B', 'R', 'Q', 'K', 'X', 'n', 'b', 'r', 'q', 'k' };
 
-	std::array<Piece, boardSize> board{};
-
-	for (std::uint32_t i{ whitePieceOffset }; i < pieceCount; ++i)
-	{
-		BitBoard occupancy{ m_pieceOccupancy[i] };
-
-		while (occupancy.board())
-		{
-			const int index{ occupancy.popLeastSignificantBit() };
-			board[index] = static_cast<Piece>(i);
-		}
-	}
+	const std::array<Piece, boardSize>& board{ m_board };
 
 	const int enpassantIndex = m_enpassantSquare.board() ? m_enpassantSquare.leastSignificantBit() : 64;
 
@@ -637,10 +1014,10 @@ void State::dump() const noexcept
 	m_enpassantSquare.print();
 
 	std::cout << "\n\nwhite squares\n";
-	m_whiteSquares.print();
+	whiteSquares().print();
 
 	std::cout << "\n\nblack squares\n";
-	m_blackSquares.print();
+	blackSquares().print();
 
 	std::cout << "\n\ncastleRights\n";
 	std::cout << static_cast<int>(m_castleRights);
@@ -9,6 +9,8 @@
 #include "StackString.hpp"
 #include "Castle.hpp"
 #include "Move.h"
+#include "PieceSquare.h"
+#include "Nnue.h"
 
 
 
@@ -21,6 +23,23 @@ public:
 	using FenPosition = StackString<128>;
 	using CharPosition = StackString<boardSize + 1>;
 
+	//types
+	struct Undo
+	{
+		BitBoard enpassantSquare;
+		std::uint64_t hash;
+		std::uint64_t pawnHash;
+		Castle castleRights;
+		int halfmoveClock;
+		int pliesSinceNullMove;
+		TaperedScore score;
+		int phase;
+		std::uint64_t materialKey;
+	};
+
+	//constants
+	static constexpr int materialKeyBits{ 4 };
+
 
 
 private:
@@ -31,10 +50,18 @@ private:
 	BitBoard m_whiteOccupancy{};
 	BitBoard m_blackOccupancy{};
 	BitBoard m_enpassantSquare{};
-	BitBoard m_whiteSquares{};
-	BitBoard m_blackSquares{};
 	std::array<BitBoard, pieceCount> m_pieceOccupancy{};
+	std::array<Piece, boardSize> m_board{};
 	Castle m_castleRights{};
+	std::uint64_t m_hash{};
+	std::uint64_t m_pawnHash{};
+	int m_halfmoveClock{};
+	int m_pliesSinceNullMove{};
+	TaperedScore m_score{};
+	int m_phase{};
+	std::uint64_t m_materialKey{};
+	Nnue::Accumulator m_accumulator{};
+	const Nnue* m_network{ nullptr };
 
 
 
@@ -49,6 +76,11 @@ private:
 
 	void movePiece(Piece piece, int sourceIndex, int destinationIndex) noexcept;
 
+	// a piece entering or leaving the board, updates the scores, the phase and the material key
+	void addMaterial(Piece piece, int index) noexcept;
+
+	void removeMaterial(Piece piece, int index) noexcept;
+
 	void testCastleRights(bool white, Piece sourcePiece, int sourceIndex) noexcept;
 
 	void testCastleCaptureRights(bool white, Piece sourcePiece, Piece attackPiece, int sourceIndex, int destinationIndex) noexcept;
@@ -76,6 +108,17 @@ private:
 
 
 
+	//unmove
+	void unmoveCapture(bool white, Piece sourcePiece, Piece capturePiece, int sourceIndex, int destinationIndex) noexcept;
+
+	void unmoveEnpassant(bool white, Piece sourcePiece, Piece capturePiece, int sourceIndex, int destinationIndex, int enpassantIndex) noexcept;
+
+	void unmoveQuietPromote(bool white, Piece sourcePiece, Piece promotePiece, int sourceIndex, int destinationIndex) noexcept;
+
+	void unmoveCapturePromote(bool white, Piece sourcePiece, Piece attackPiece, Piece promotePiece, int sourceIndex, int destinationIndex) noexcept;
+
+
+
 	//promote
 	void moveQuietPromote(bool white, Piece sourcePiece, Piece promotePiece, int sourceIndex, int destinationIndex) noexcept;
 
@@ -83,6 +126,12 @@ private:
 
 
 
+	//network
+	// applies the features a move adds and removes, or takes them back after the board is restored, king moves refresh
+	void updateAccumulator(bool white, Move move, bool unmake) noexcept;
+
+
+
 public:
 
 	//	Public Methods
@@ -92,8 +141,11 @@ public:
 
 	State(std::string_view fen, Castle castle);
 
+	// all six fields of a FEN, the side to move is not part of State so read it with State::fenWhiteToMove()
 	static State fromFen(std::string_view position);
 
+	static bool fenWhiteToMove(std::string_view position) noexcept;
+
 	static State fromChar(std::string_view position);
 
 
@@ -129,41 +181,65 @@ public:
 
 	BitBoard blackSquares() const noexcept;
 
+	std::uint64_t hash() const noexcept;
+
+	// zobrist key of the pawns alone, positions with the same pawns share their pawn structure evaluation
+	std::uint64_t pawnHash() const noexcept;
+
+	// plies since the last capture or pawn move, no position before that can repeat
+	int halfmoveClock() const noexcept;
+
+	// plies since the last null move, a position before it was reached with the other side to move
+	int pliesSinceNullMove() const noexcept;
+
+	// material and piece-square score of both phases kept up to date by every move, white relative
+	TaperedScore score() const noexcept;
+
+	// grows with the pieces left on the board, PieceSquare::maxPhase at the start and can pass it after promotions
+	int phase() const noexcept;
+
+	// the number of every piece but the kings packed State::materialKeyBits to a piece in Piece order, so it is exact and 
+	// one key stands for one material balance
+	std::uint64_t materialKey() const noexcept;
+
+	static int materialCount(std::uint64_t materialKey, Piece piece) noexcept;
+
+	// only kept up to date while the State has a network
+	const Nnue::Accumulator& accumulator() const noexcept;
+
+	// the network the accumulator is kept up to date for, nullptr without one
+	const Nnue* network() const noexcept;
+
 	template<Piece piece>
 	BitBoard pieceOccupancyT() const noexcept
 	{
 		return m_pieceOccupancy[static_cast<std::size_t>(piece)];
 	}
 
+	// the board keeps the piece on every square next to the bitboards so a lookup is one load, the color is only a hint for 
+	// the callers and is not checked, test for occupancy before calling State::findPiece()
 	template<bool white>
 	Piece findPiece(int index) const noexcept
 	{
-		constexpr int begin{ white ? whitePieceOffset : blackPieceOffset };
-		constexpr int end{ white ? blackPieceOffset : pieceCount };
-
-		for (std::size_t i{ begin }; i < end; ++i)
-		{
-			if (m_pieceOccupancy[i].test(index))
-			{
-				return static_cast<Piece>(i);
-			}
-		}
-
-		//this should never execute, test for occupancy before calling State::findPiece()
-		return Piece::NoPiece;
+		return m_board[static_cast<std::size_t>(index)];
 	}
 
 
 
-	//setters
-	void setWhiteSquares(BitBoard squares) noexcept;
+	//move
+	Undo makeMove(bool white, Move move) noexcept;
 
-	void setBlackSquares(BitBoard squares) noexcept;
+	void unmakeMove(bool white, Move move, const Undo& undo) noexcept;
 
+	// passes the turn without moving, only the side to move and the enpassant square change, the halfmove clock is kept and 
+	// State::pliesSinceNullMove() restarts so repetition checks do not look past a null move
+	Undo makeNullMove() noexcept;
 
+	void unmakeNullMove(const Undo& undo) noexcept;
 
-	//move
-	void makeMove(bool white, Move move) noexcept;
+	// rebuilds the accumulator from the board for a network with weights or stops keeping it for nullptr, the network must 
+	// outlive the State and every copy of it
+	void setNetwork(const Nnue* network) noexcept;
 
 
 
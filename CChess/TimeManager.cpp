@@ -0,0 +1,88 @@
+#include "TimeManager.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+
+#include "ChessConstants.hpp"
+#include "Move.h"
+
+
+
+//	Public Methods
+
+//getters
+TimeManager::milliseconds TimeManager::elapsed() const noexcept
+{
+	return std::chrono::duration_cast<milliseconds>(clock::now() - m_start);
+}
+
+TimeManager::milliseconds TimeManager::remaining() const noexcept
+{
+	return m_timed ? std::max(m_hardLimit - elapsed(), milliseconds{ 0 }) : milliseconds{ 0 };
+}
+
+int TimeManager::depthLimit() const noexcept
+{
+	return m_limits.depth > 0 ? std::min(m_limits.depth, maxSearchDepth) : maxSearchDepth;
+}
+
+bool TimeManager::outOfTime(std::uint64_t nodes) const noexcept
+{
+	if (m_limits.nodes && nodes >= m_limits.nodes) return true;
+
+	return m_timed && clock::now() - m_start >= m_hardLimit;
+}
+
+
+
+//setters
+// a fixed move time is used as it is, a clock is split over the moves still to play with most of the increment on top, the 
+// hard limit lets a hard position take several times its share but never more than half of what is left on the clock, 
+// unless the share itself is more than that
+void TimeManager::start(const Limits& limits) noexcept
+{
+	m_start = clock::now();
+	m_limits = limits;
+	m_bestMove = Move{ 0 };
+	m_stableIterations = 0;
+
+	if (limits.moveTime.count() > 0)
+	{
+		m_timed = true;
+		m_softLimit = std::max(limits.moveTime - moveOverhead, milliseconds{ 1 });
+		m_hardLimit = m_softLimit;
+	}
+	else if (limits.remaining.count() > 0)
+	{
+		const int movesToGo{ limits.movesToGo > 0 ? limits.movesToGo : defaultMovesToGo };
+		const milliseconds available{ std::max(limits.remaining - moveOverhead, milliseconds{ 1 }) };
+
+		m_timed = true;
+		m_softLimit = std::min(available / movesToGo + limits.increment * 3 / 4, available);
+		m_hardLimit = std::min(m_softLimit * 4, available / 2);
+		m_hardLimit = std::max(m_hardLimit, m_softLimit);
+	}
+	else
+	{
+		m_timed = false;
+		m_softLimit = milliseconds{ 0 };
+		m_hardLimit = milliseconds{ 0 };
+	}
+}
+
+// the soft limit shrinks while the best move stays the same and grows right after it changed, a fixed move time is spent 
+// in full since it was asked for
+bool TimeManager::iterationDone(int depth, Move bestMove) noexcept
+{
+	m_stableIterations = bestMove.move() == m_bestMove.move() ? m_stableIterations + 1 : 0;
+	m_bestMove = bestMove;
+
+	if (depth >= depthLimit()) return true;
+	if (!m_timed || m_limits.moveTime.count() > 0) return false;
+
+	const milliseconds softLimit{ m_stableIterations >= stableIterations ? m_softLimit / 2 
+		: m_stableIterations == 0 ? m_softLimit * 3 / 2 : m_softLimit };
+
+	return elapsed() >= std::min(softLimit, m_hardLimit);
+}
\ No newline at end of file
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#include "Move.h"
+
+
+
+// decides how long a search may take, the hard deadline is polled while searching and the soft deadline is checked between 
+// iterations so an iteration that will not finish in time is not started and a stable best move ends the search early
+class TimeManager
+{
+public:
+
+	//	Public Definitions
+
+	//usings
+	using clock = std::chrono::steady_clock;
+	using milliseconds = std::chrono::milliseconds;
+
+	//types
+	// zero means no limit, a search without any limit runs until it is stopped
+	struct Limits
+	{
+		milliseconds remaining{ 0 };
+		milliseconds increment{ 0 };
+		int movesToGo{ 0 };
+		milliseconds moveTime{ 0 };
+		std::uint64_t nodes{ 0 };
+		int depth{ 0 };
+	};
+
+
+
+private:
+
+	//	Private Definitions
+
+	//constants
+	static constexpr int defaultMovesToGo{ 30 };
+	static constexpr int stableIterations{ 4 };
+	static constexpr milliseconds moveOverhead{ 20 };
+
+
+
+private:
+
+	//	Private Members
+
+	Limits m_limits{};
+	clock::time_point m_start{};
+	milliseconds m_softLimit{ 0 };
+	milliseconds m_hardLimit{ 0 };
+	bool m_timed{ false };
+	Move m_bestMove{ 0 };
+	int m_stableIterations{ 0 };
+
+
+
+public:
+
+	//	Public Methods
+
+	//getters
+	milliseconds elapsed() const noexcept;
+
+	milliseconds remaining() const noexcept;
+
+	int depthLimit() const noexcept;
+
+	// polled while searching, true once the hard deadline or the node limit is reached
+	bool outOfTime(std::uint64_t nodes) const noexcept;
+
+
+
+	//setters
+	void start(const Limits& limits) noexcept;
+
+	// called after every completed iteration, true if the next iteration should not be started
+	bool iterationDone(int depth, Move bestMove) noexcept;
+};
\ No newline at end of file
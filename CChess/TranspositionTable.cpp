@@ -0,0 +1,163 @@
+#include "TranspositionTable.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "Move.h"
+
+
+
+//	Static Helpers
+
+// the low bits of the key pick the bucket so they are free to hold the age of the entry
+static constexpr std::uint64_t ageMask{ 0xFF };
+
+static constexpr int scoreBits{ 22 };
+static constexpr int depthBits{ 8 };
+static constexpr int boundBits{ 2 };
+
+static std::uint64_t packData(Move move, int score, int depth, TranspositionTable::Bound bound) noexcept
+{
+	const std::uint64_t packedScore{ static_cast<std::uint64_t>(score) & ((1ULL << scoreBits) - 1) };
+
+	return static_cast<std::uint64_t>(move.move())
+		| (packedScore << 32)
+		| (static_cast<std::uint64_t>(depth & 0xFF) << (32 + scoreBits))
+		| (static_cast<std::uint64_t>(bound) << (32 + scoreBits + depthBits));
+}
+
+static TranspositionTable::Entry unpackData(std::uint64_t key, std::uint64_t data) noexcept
+{
+	//shift the score to the top of the word and back down to restore its sign
+	const int score{ static_cast<int>(static_cast<std::int64_t>(data << (64 - 32 - scoreBits)) >> (64 - scoreBits)) };
+	const std::uint8_t depth{ static_cast<std::uint8_t>(data >> (32 + scoreBits)) };
+	const auto bound{ static_cast<TranspositionTable::Bound>((data >> (32 + scoreBits + depthBits)) & ((1ULL << boundBits) - 1)) };
+
+	const std::uint8_t age{ static_cast<std::uint8_t>(key & ageMask) };
+
+	return TranspositionTable::Entry{ static_cast<std::uint32_t>(key >> 32), static_cast<std::uint32_t>(data), score, depth, bound, age };
+}
+
+
+
+//	Private Methods
+
+TranspositionTable::Bucket& TranspositionTable::bucket(std::uint64_t key) noexcept
+{
+	return m_buckets[key & m_indexMask];
+}
+
+const TranspositionTable::Bucket& TranspositionTable::bucket(std::uint64_t key) const noexcept
+{
+	return m_buckets[key & m_indexMask];
+}
+
+
+
+//	Public Methods
+
+//constructors
+TranspositionTable::TranspositionTable(std::size_t megabytes)
+{
+	resize(megabytes);
+}
+
+
+
+//getters
+bool TranspositionTable::probe(std::uint64_t key, Entry& entry) const noexcept
+{
+	const Bucket& entries{ bucket(key) };
+
+	const auto it{ std::ranges::find_if(entries.slots, [key](const Slot& slot) {
+		const std::uint64_t data{ slot.data.load(std::memory_order_relaxed) };
+		return data && ((slot.key.load(std::memory_order_relaxed) ^ data) & ~ageMask) == (key & ~ageMask);
+		}) };
+
+	if (it == entries.slots.end()) return false;
+
+	const std::uint64_t data{ it->data.load(std::memory_order_relaxed) };
+	const std::uint64_t storedKey{ it->key.load(std::memory_order_relaxed) ^ data };
+
+	//the slot may have been overwritten between the search and the loads above
+	if ((storedKey & ~ageMask) != (key & ~ageMask)) return false;
+
+	entry = unpackData(storedKey, data);
+	return true;
+}
+
+
+
+//setters
+void TranspositionTable::store(std::uint64_t key, Move move, int score, int depth, Bound bound) noexcept
+{
+	Bucket& entries{ bucket(key) };
+
+	//same position first, otherwise the entry that is oldest and shallowest
+	Slot* replace{ &entries.slots.front() };
+	std::uint64_t replaceData{ replace->data.load(std::memory_order_relaxed) };
+	bool samePosition{};
+	int replaceValue{ std::numeric_limits<int>::max() };
+
+	for (Slot& slot : entries.slots)
+	{
+		const std::uint64_t data{ slot.data.load(std::memory_order_relaxed) };
+		const std::uint64_t storedKey{ slot.key.load(std::memory_order_relaxed) ^ data };
+		samePosition = data && (storedKey & ~ageMask) == (key & ~ageMask);
+
+		if (!data || samePosition)
+		{
+			replace = &slot;
+			replaceData = data;
+			break;
+		}
+
+		const int age{ static_cast<std::uint8_t>(m_age - static_cast<std::uint8_t>(storedKey & ageMask)) };
+		const int value{ static_cast<std::uint8_t>(data >> (32 + scoreBits)) - age * 8 };
+
+		if (value < replaceValue)
+		{
+			replace = &slot;
+			replaceData = data;
+			replaceValue = value;
+		}
+	}
+
+	//keep the old best move if this search did not find one, it is still the best guess for ordering
+	const Move storedMove{ !move.move() && samePosition ? Move(static_cast<std::uint32_t>(replaceData)) : move };
+	const std::uint64_t data{ packData(storedMove, score, depth, bound) };
+
+	replace->key.store(((key & ~ageMask) | m_age) ^ data, std::memory_order_relaxed);
+	replace->data.store(data, std::memory_order_relaxed);
+}
+
+void TranspositionTable::resize(std::size_t megabytes)
+{
+	const std::size_t bytes{ std::max<std::size_t>(megabytes, 1) * 1024 * 1024 };
+	const std::size_t bucketCount{ std::bit_floor(bytes / sizeof(Bucket)) };
+
+	//atomics can not be copied so the buckets are value initialized in a new vector
+	m_buckets = std::vector<Bucket>(bucketCount);
+	m_indexMask = bucketCount - 1;
+	m_age = 0;
+}
+
+void TranspositionTable::clear() noexcept
+{
+	std::ranges::for_each(m_buckets, [](Bucket& entries) {
+		std::ranges::for_each(entries.slots, [](Slot& slot) {
+			slot.key.store(0, std::memory_order_relaxed);
+			slot.data.store(0, std::memory_order_relaxed);
+			});
+		});
+
+	m_age = 0;
+}
+
+void TranspositionTable::newSearch() noexcept
+{
+	++m_age;
+}
\ No newline at end of file
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "ChessConstants.hpp"
+#include "Move.h"
+
+
+
+class TranspositionTable
+{
+public:
+
+	//	Public Definitions
+
+	//types
+	enum class Bound : std::uint8_t
+	{
+		None,
+		Exact,
+		Lower,
+		Upper
+	};
+
+	struct Entry
+	{
+		std::uint32_t key;
+		Move move;
+		int score;
+		std::uint8_t depth;
+		Bound bound;
+		std::uint8_t age;
+	};
+
+	//constants
+	static constexpr std::size_t defaultMegabytes{ 64 };
+
+
+
+private:
+
+	//	Private Definitions
+
+	//constants
+	static constexpr std::size_t bucketSize{ 4 };
+
+	//types
+	// entries are packed into two words and the key word is xored with the data word, so a slot torn by two threads 
+	// writing at once fails verification instead of returning a mix of two positions
+	struct Slot
+	{
+		std::atomic<std::uint64_t> key;
+		std::atomic<std::uint64_t> data;
+	};
+
+	struct cachealign Bucket
+	{
+		std::array<Slot, bucketSize> slots;
+	};
+
+
+
+private:
+
+	//	Private Members
+
+	std::vector<Bucket> m_buckets;
+	std::uint64_t m_indexMask{};
+	std::uint8_t m_age{};
+
+
+
+private:
+
+	//	Private Methods
+
+	Bucket& bucket(std::uint64_t key) noexcept;
+
+	const Bucket& bucket(std::uint64_t key) const noexcept;
+
+
+
+public:
+
+	//	Public Methods
+
+	//constructors
+	TranspositionTable(std::size_t megabytes = defaultMegabytes);
+
+
+
+	//getters
+	bool probe(std::uint64_t key, Entry& entry) const noexcept;
+
+
+
+	//setters
+	void store(std::uint64_t key, Move move, int score, int depth, Bound bound) noexcept;
+
+	void resize(std::size_t megabytes);
+
+	void clear() noexcept;
+
+	void newSearch() noexcept;
+};
@@ -0,0 +1,277 @@
+#include "Uci.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "Engine.h"
+#include "Move.h"
+#include "Nnue.h"
+#include "TimeManager.h"
+#include "TranspositionTable.h"
+
+
+
+//	Static Helpers
+
+// the text after a keyword up to the next keyword or the end of the line, without the surrounding spaces
+static std::string_view argument(std::string_view arguments, std::string_view keyword, std::string_view nextKeyword = {}) noexcept
+{
+	const std::size_t keywordIndex{ arguments.find(keyword) };
+	if (keywordIndex == std::string_view::npos) return {};
+
+	std::string_view value{ arguments.substr(keywordIndex + keyword.size()) };
+
+	if (!nextKeyword.empty())
+	{
+		value = value.substr(0, value.find(nextKeyword));
+	}
+
+	const std::size_t first{ value.find_first_not_of(' ') };
+	const std::size_t last{ value.find_last_not_of(' ') };
+
+	return first == std::string_view::npos ? std::string_view{} : value.substr(first, last - first + 1);
+}
+
+
+
+//	Private Methods
+
+void Uci::send(std::string_view line)
+{
+	std::lock_guard lock(m_outputMutex);
+	m_output << line << std::endl;
+}
+
+// the engine reports from white's side and separates the principal variation with commas, the protocol wants the side to 
+// move and spaces
+void Uci::sendInfo(const Engine::SearchInfo& info, bool whiteToMove)
+{
+	const int sign{ whiteToMove ? 1 : -1 };
+
+	std::string principalVariation{ info.principalVariation };
+	std::ranges::replace(principalVariation, ',', ' ');
+
+	while (!principalVariation.empty() && principalVariation.back() == ' ') principalVariation.pop_back();
+
+	std::ostringstream line;
+	line << "info depth " << info.depth;
+
+	if (info.mate)
+	{
+		line << " score mate " << sign * info.mate;
+	}
+	else
+	{
+		line << " score cp " << sign * info.evaluation;
+	}
+
+	line << " nodes " << info.nodes << " nps " << static_cast<std::uint64_t>(info.nodesPerSecond);
+
+	if (!principalVariation.empty())
+	{
+		line << " pv " << principalVariation;
+	}
+
+	send(line.str());
+}
+
+// streams every completed iteration while the engine searches and answers with the best move once it is done, an infinite 
+// search holds the best move back until it is told to stop
+void Uci::report(std::stop_token token, bool whiteToMove)
+{
+	Engine::SearchInfo info{};
+
+	while (m_engine.searching() || (m_infinite.load(std::memory_order_relaxed) && !token.stop_requested()))
+	{
+		while (m_engine.nextIteration(info)) sendInfo(info, whiteToMove);
+
+		std::this_thread::sleep_for(reportInterval);
+	}
+
+	//the engine is idle so nothing is queued after the iterations that finished since the last poll
+	while (m_engine.nextIteration(info)) sendInfo(info, whiteToMove);
+
+	const Move bestMove{ m_engine.bestMove() };
+	send("bestmove " + (bestMove.move() ? bestMove.string() : std::string("0000")));
+}
+
+void Uci::uci()
+{
+	std::ostringstream lines;
+
+	lines << "id name " << engineName << '\n';
+	lines << "id author " << engineAuthor << '\n';
+	lines << "option name Hash type spin default " << TranspositionTable::defaultMegabytes << " min 1 max " << maxHashMegabytes << '\n';
+	lines << "option name Threads type spin default 1 min 1 max " << maxThreads << '\n';
+	lines << "option name EvalFile type string default " << Nnue::defaultNetworkFile << '\n';
+	lines << "uciok";
+
+	send(lines.str());
+}
+
+// position startpos [moves ...] or position fen <fen> [moves ...], a search still running is stopped first
+void Uci::position(std::string_view arguments)
+{
+	stop();
+
+	if (arguments.starts_with("startpos"))
+	{
+		m_engine.setStartState();
+	}
+	else if (arguments.starts_with("fen"))
+	{
+		m_engine.setPositionFen(argument(arguments, "fen", " moves"));
+	}
+	else
+	{
+		return;
+	}
+
+	std::istringstream moves{ std::string(argument(arguments, " moves")) };
+	std::string move;
+
+	while (moves >> move)
+	{
+		if (!m_engine.move(move))
+		{
+			send("info string illegal move " + move);
+			break;
+		}
+	}
+}
+
+// go [wtime <ms>] [btime <ms>] [winc <ms>] [binc <ms>] [movestogo <n>] [movetime <ms>] [depth <n>] [nodes <n>] [infinite], anything else
+// such as ponder or searchmoves and its moves is skipped
+void Uci::go(std::string_view arguments)
+{
+	stop();
+
+	const bool whiteToMove{ m_engine.whiteToMove() };
+
+	TimeManager::Limits limits{};
+	bool infinite{ false };
+
+	std::istringstream tokens{ std::string(arguments) };
+	std::string token;
+
+	while (tokens >> token)
+	{
+		std::int64_t value{};
+
+		if (token == "infinite")
+		{
+			infinite = true;
+		}
+		else if (std::ranges::find(goValueKeywords, token) == goValueKeywords.end())
+		{
+			//ponder, searchmoves with its moves and anything unknown are skipped one token at a time
+			continue;
+		}
+		else if (!(tokens >> value))
+		{
+			//a value that is not a number is read again as the next token
+			tokens.clear();
+		}
+		else
+		{
+			if (token == (whiteToMove ? "wtime" : "btime")) limits.remaining = TimeManager::milliseconds{ value };
+			if (token == (whiteToMove ? "winc" : "binc")) limits.increment = TimeManager::milliseconds{ value };
+			if (token == "movestogo") limits.movesToGo = static_cast<int>(value);
+			if (token == "movetime") limits.moveTime = TimeManager::milliseconds{ value };
+			if (token == "depth") limits.depth = static_cast<int>(value);
+			if (token == "nodes") limits.nodes = static_cast<std::uint64_t>(value);
+		}
+	}
+
+	//the engine is idle so the previous reporter is sending its best move, joining it keeps that before the new search
+	m_reporter = std::jthread();
+	m_infinite.store(infinite, std::memory_order_relaxed);
+
+	m_engine.startSearch(infinite ? TimeManager::Limits{} : limits);
+
+	m_reporter = std::jthread([this, whiteToMove](std::stop_token token) {
+		report(token, whiteToMove);
+		});
+}
+
+// setoption name <Hash|Threads|EvalFile> value <n|path>, the engine can only be changed while it is idle
+void Uci::setOption(std::string_view arguments)
+{
+	stop();
+
+	const std::string_view name{ argument(arguments, "name", " value") };
+	const std::string value{ argument(arguments, " value") };
+
+	if (name == "Hash")
+	{
+		m_engine.setHashSize(static_cast<std::size_t>(std::clamp(std::atoi(value.c_str()), 1, maxHashMegabytes)));
+	}
+	else if (name == "Threads")
+	{
+		m_engine.setThreads(std::clamp(std::atoi(value.c_str()), 1, maxThreads));
+	}
+	else if (name == "EvalFile")
+	{
+		send(m_engine.loadNetwork(value) ? "info string network loaded" : "info string network not loaded");
+	}
+}
+
+// returns once the engine is idle, the reporter sends the best move of the stopped search
+void Uci::stop() noexcept
+{
+	m_infinite.store(false, std::memory_order_relaxed);
+	m_engine.stopSearch();
+}
+
+
+
+//	Public Methods
+
+//constructors
+Uci::Uci(std::istream& input, std::ostream& output)
+	: m_engine(), m_input(input), m_output(output), m_outputMutex(), m_reporter()
+{
+}
+
+Uci::~Uci()
+{
+	stop();
+}
+
+
+
+//setters
+int Uci::loop()
+{
+	std::string line;
+
+	while (std::getline(m_input, line))
+	{
+		const std::string_view view{ line };
+		const std::string_view command{ view.substr(0, view.find(' ')) };
+		const std::string_view arguments{ argument(view, command) };
+
+		if (command == "uci") uci();
+		else if (command == "isready") send("readyok");
+		else if (command == "ucinewgame") m_engine.clearHash();
+		else if (command == "position") position(arguments);
+		else if (command == "go") go(arguments);
+		else if (command == "stop") stop();
+		else if (command == "setoption") setOption(arguments);
+		else if (command == "quit") break;
+	}
+
+	stop();
+	m_reporter = std::jthread();
+
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <iosfwd>
+#include <mutex>
+#include <stop_token>
+#include <string_view>
+#include <thread>
+
+#include "Engine.h"
+
+
+
+// console front end speaking the universal chess interface, commands are read on the calling thread while the engine 
+// searches on its worker and a reporter thread streams the search info and the best move
+class Uci
+{
+private:
+
+	//	Private Definitions
+
+	//constants
+	static constexpr std::string_view engineName{ "CChess" };
+	static constexpr std::string_view engineAuthor{ "Nicholas Maurer" };
+	static constexpr std::chrono::milliseconds reportInterval{ 10 };
+	static constexpr int maxHashMegabytes{ 65536 };
+	static constexpr int maxThreads{ 256 };
+	static constexpr std::array<std::string_view, 8> goValueKeywords{ "wtime", "btime", "winc", "binc", "movestogo", "movetime", "depth", "nodes" };
+
+
+
+private:
+
+	//	Private Members
+
+	Engine m_engine;
+	std::istream& m_input;
+	std::ostream& m_output;
+	std::mutex m_outputMutex;
+	std::atomic_bool m_infinite{ false };
+	std::jthread m_reporter;
+
+
+
+private:
+
+	//	Private Methods
+
+	void send(std::string_view line);
+
+	void sendInfo(const Engine::SearchInfo& info, bool whiteToMove);
+
+	void report(std::stop_token token, bool whiteToMove);
+
+	void uci();
+
+	void position(std::string_view arguments);
+
+	void go(std::string_view arguments);
+
+	void setOption(std::string_view arguments);
+
+	void stop() noexcept;
+
+
+
+public:
+
+	//	Public Methods
+
+	//constructors
+	Uci(std::istream& input, std::ostream& output);
+
+	~Uci();
+
+
+
+	//setters
+	// reads commands until quit or the end of the input
+	int loop();
+};
\ No newline at end of file
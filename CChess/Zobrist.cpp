@@ -0,0 +1,72 @@
+#include "Zobrist.h"
+
+#include <array>
+#include <cstdint>
+
+#include "ChessConstants.hpp"
+#include "BitBoard.h"
+#include "Castle.hpp"
+
+
+
+//	Static Helpers
+
+static constexpr std::size_t castleKeyCount{ 16 };
+static constexpr std::size_t pieceKeyOffset{ 0 };
+static constexpr std::size_t castleKeyOffset{ pieceKeyOffset + pieceCount * boardSize };
+static constexpr std::size_t enpassantKeyOffset{ castleKeyOffset + castleKeyCount };
+static constexpr std::size_t sideKeyOffset{ enpassantKeyOffset + boardSize };
+static constexpr std::size_t keyCount{ sideKeyOffset + 1 };
+
+// splitmix64 with a fixed seed, so hashes are identical on every run and every build
+static consteval std::array<std::uint64_t, keyCount> generateKeys()
+{
+	std::array<std::uint64_t, keyCount> keys{};
+	std::uint64_t seed{ 0x4343686573734B65ULL };
+
+	for (std::size_t i{}; i < keyCount; ++i)
+	{
+		seed += 0x9E3779B97F4A7C15ULL;
+
+		std::uint64_t z{ seed };
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+		keys[i] = z ^ (z >> 31);
+	}
+
+	return keys;
+}
+
+static constexpr std::array<std::uint64_t, keyCount> keys{ generateKeys() };
+
+
+
+namespace Zobrist
+{
+	std::uint64_t pieceKey(Piece piece, int square) noexcept
+	{
+		return keys[pieceKeyOffset + static_cast<std::size_t>(piece) * boardSize + static_cast<std::size_t>(square)];
+	}
+
+	std::uint64_t pawnKey(Piece piece, int square) noexcept
+	{
+		const bool pawn{ piece == Piece::WhitePawn || piece == Piece::BlackPawn };
+
+		return pawn ? pieceKey(piece, square) : 0;
+	}
+
+	std::uint64_t castleKey(Castle castle) noexcept
+	{
+		return keys[castleKeyOffset + static_cast<std::size_t>(castle)];
+	}
+
+	std::uint64_t enpassantKey(BitBoard enpassantSquare) noexcept
+	{
+		return enpassantSquare.board() ? keys[enpassantKeyOffset + enpassantSquare.leastSignificantBit()] : 0;
+	}
+
+	std::uint64_t sideKey() noexcept
+	{
+		return keys[sideKeyOffset];
+	}
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+
+#include "ChessConstants.hpp"
+#include "BitBoard.h"
+#include "Castle.hpp"
+
+
+
+namespace Zobrist
+{
+	std::uint64_t pieceKey(Piece piece, int square) noexcept;
+
+	// the piece key of a pawn and zero for every other piece, so the pawn key can be updated without a branch
+	std::uint64_t pawnKey(Piece piece, int square) noexcept;
+
+	std::uint64_t castleKey(Castle castle) noexcept;
+
+	std::uint64_t enpassantKey(BitBoard enpassantSquare) noexcept;
+
+	std::uint64_t sideKey() noexcept;
+};